@@ -22,11 +22,16 @@
 #define CXSTRUCTS_SRC_BENCHMARK_H_
 
 #include <list>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
+#include "cxallocator.h"
 #include "cxstructs.h"
+#include "cxstructs/ConcurrentQueue.h"
+#include "cxstructs/MultiQueue.h"
+#include "cxstructs/SweepAndPrune.h"
 inline static volatile int num1 = 2;
 //benchmarks are this /  run separately
 static void VEC() {
@@ -241,4 +246,444 @@ static void STD_DEQUEUE() {
   q.clear();
   printTime("std::de_queue");
 }
+// Ready queue of a job system - every thread pushes and pops in a loop
+// Compares a mutex protected PriorityQueue with the MultiQueue at 1-64 threads
+static void MULTI_QUEUE_THROUGHPUT() {
+  struct Job {
+    uint32_t priority;
+    uint32_t id;
+    bool operator>(const Job& o) const { return priority > o.priority; }
+  };
+  constexpr int OPS = 200000;  // Push + pop pairs per thread
+  constexpr int PREFILL = 10000;
+  char label[64];
+  for (int threadCount = 1; threadCount <= 64; threadCount *= 2) {
+    std::vector<std::thread> threads;
+    {
+      PriorityQueue<Job> heap;
+      std::mutex mutex;
+      for (uint32_t i = 0; i < PREFILL; i++) {
+        heap.push({i * 7919 % 100000, i});
+      }
+      now();
+      for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+          for (uint32_t i = 0; i < OPS; i++) {
+            std::lock_guard<std::mutex> lock(mutex);
+            heap.push({(i * 7919 + t) % 100000, i});
+            num1 = (int)heap.top().id;
+            heap.pop();
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      snprintf(label, sizeof(label), "mutex PriorityQueue %2d threads: ", threadCount);
+      printTime<std::chrono::milliseconds>(label);
+    }
+    threads.clear();
+    {
+      MultiQueue<uint32_t, uint32_t> queue(2 * threadCount);
+      for (uint32_t i = 0; i < PREFILL; i++) {
+        queue.push(i * 7919 % 100000, i);
+      }
+      now();
+      for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+          uint32_t key;
+          uint32_t id;
+          for (uint32_t i = 0; i < OPS; i++) {
+            queue.push((i * 7919 + t) % 100000, i);
+            if (queue.try_pop(key, id)) num1 = (int)id;
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      snprintf(label, sizeof(label), "MultiQueue          %2d threads: ", threadCount);
+      printTime<std::chrono::milliseconds>(label);
+    }
+  }
+}
+// Broad phase over 100k moving AABBs - pair finding per tick
+// Compares a rebuilt SingleResolutionHashGrid (query every box) with incremental sweep-and-prune
+// The grid works on integer cells and misses a few pairs that touch a cell border
+static void BROAD_PHASE() {
+  constexpr uint32_t COUNT = 100000;
+  constexpr int TICKS = 20;
+  constexpr float WORLD = 10000;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> pos(0, WORLD);
+  std::uniform_real_distribution<float> size(2, 20);
+  std::uniform_real_distribution<float> vel(-2, 2);
+  std::vector<Rect> boxes(COUNT);
+  std::vector<Point> velocity(COUNT);
+  for (uint32_t i = 0; i < COUNT; i++) {
+    boxes[i] = Rect(pos(gen), pos(gen), size(gen), size(gen));
+    velocity[i] = Point(vel(gen), vel(gen));
+  }
+  auto move = [&] {
+    for (uint32_t i = 0; i < COUNT; i++) {
+      boxes[i].x() += velocity[i].x();
+      boxes[i].y() += velocity[i].y();
+    }
+  };
+  struct Candidates {
+    std::vector<uint32_t> ids;
+    void insert(uint32_t id) { ids.push_back(id); }
+  };
+  size_t pairCount = 0;
+  char label[64];
+  {
+    const std::vector<Rect> start = boxes;
+    SingleResolutionHashGrid<uint32_t, std::unordered_map<CellID, int>> grid(64);
+    grid.reserve(40000, COUNT * 2);
+    Candidates candidates;
+    now();
+    for (int tick = 0; tick < TICKS; tick++) {
+      move();
+      grid.clear();
+      for (uint32_t i = 0; i < COUNT; i++) {
+        const Rect& r = boxes[i];
+        grid.insert(i, r.x(), r.y(), (int)r.width(), (int)r.height());
+      }
+      pairCount = 0;
+      for (uint32_t i = 0; i < COUNT; i++) {
+        const Rect& r = boxes[i];
+        candidates.ids.clear();
+        grid.query(candidates, r.x(), r.y(), (int)r.width(), (int)r.height());
+        std::sort(candidates.ids.begin(), candidates.ids.end());
+        const auto last = std::unique(candidates.ids.begin(), candidates.ids.end());
+        for (auto it = candidates.ids.begin(); it != last; ++it) {
+          pairCount += *it > i && r.intersects(boxes[*it]);
+        }
+      }
+    }
+    snprintf(label, sizeof(label), "HashGrid           %zu pairs: ", pairCount);
+    printTime<std::chrono::milliseconds>(label);
+    boxes = start;
+  }
+  {
+    const std::vector<Rect> start = boxes;
+    SweepAndPrune sap;
+    SweepAndPrune::PairList pairs;
+    for (uint32_t i = 0; i < COUNT; i++) {
+      sap.add(boxes[i]);
+    }
+    sap.find_pairs(pairs);  // Initial sort is not part of a tick
+    now();
+    for (int tick = 0; tick < TICKS; tick++) {
+      move();
+      for (uint32_t i = 0; i < COUNT; i++) {
+        sap.update(i, boxes[i]);
+      }
+      sap.find_pairs(pairs);
+    }
+    snprintf(label, sizeof(label), "SweepAndPrune      %zu pairs: ", pairs.size());
+    printTime<std::chrono::milliseconds>(label);
+    boxes = start;
+  }
+  {
+    SweepAndPrune sap;
+    SweepAndPrune::PairList pairs;
+    for (uint32_t i = 0; i < COUNT; i++) {
+      sap.add(boxes[i]);
+    }
+    sap.find_pairs_parallel(pairs);
+    now();
+    for (int tick = 0; tick < TICKS; tick++) {
+      move();
+      for (uint32_t i = 0; i < COUNT; i++) {
+        sap.update(i, boxes[i]);
+      }
+      sap.find_pairs_parallel(pairs);
+    }
+    snprintf(label, sizeof(label), "SweepAndPrune par. %zu pairs: ", pairs.size());
+    printTime<std::chrono::milliseconds>(label);
+  }
+}
+// Pipeline stage handoff - one producer and one consumer thread pass 20M messages
+// Compares a mutex protected Queue with the SPSC ring (single and batched) and the MPMC ring
+// Waiting sides yield so the benchmark also runs on a single core
+static void CONCURRENT_QUEUE_THROUGHPUT() {
+  constexpr uint32_t COUNT = 20000000;
+  constexpr uint32_t BATCH = 64;
+  char label[64];
+  auto report = [&](const char* name) {
+    const long long ms = std::max(getTime<std::chrono::milliseconds>(), 1LL);
+    snprintf(label, sizeof(label), "%s %5.1f M msg/s: ", name, COUNT / 1000.0 / (double)ms);
+    printTime<std::chrono::milliseconds>(label);
+  };
+  {
+    Queue<uint32_t> queue(1024);
+    std::mutex mutex;
+    now();
+    std::thread producer([&] {
+      for (uint32_t i = 0; i < COUNT; i++) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push(i);
+      }
+    });
+    for (uint32_t received = 0; received < COUNT;) {
+      std::lock_guard<std::mutex> lock(mutex);
+      while (queue.size() > 0) {
+        num1 = (int)queue.front();
+        queue.pop();
+        received++;
+      }
+    }
+    producer.join();
+    report("mutex Queue   ");
+  }
+  {
+    SPSCQueue<uint32_t> ring(4096);
+    now();
+    std::thread producer([&] {
+      for (uint32_t i = 0; i < COUNT; i++) {
+        ring.push(i);
+      }
+    });
+    uint32_t val;
+    for (uint32_t received = 0; received < COUNT;) {
+      if (ring.try_pop(val)) {
+        num1 = (int)val;
+        received++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+    report("SPSCQueue     ");
+  }
+  {
+    SPSCQueue<uint32_t> ring(4096);
+    now();
+    std::thread producer([&] {
+      uint32_t batch[BATCH];
+      for (uint32_t i = 0; i < COUNT;) {
+        const uint32_t n = std::min(BATCH, COUNT - i);
+        for (uint32_t k = 0; k < n; k++) batch[k] = i + k;
+        const auto pushed = (uint32_t)ring.push_n(batch, n);
+        if (pushed == 0) std::this_thread::yield();
+        i += pushed;
+      }
+    });
+    uint32_t batch[BATCH];
+    for (uint32_t received = 0; received < COUNT;) {
+      const auto n = (uint32_t)ring.pop_n(batch, BATCH);
+      if (n == 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      num1 = (int)batch[n - 1];
+      received += n;
+    }
+    producer.join();
+    report("SPSCQueue x64 ");
+  }
+  {
+    MPMCQueue<uint32_t> ring(4096);
+    now();
+    std::thread producer([&] {
+      for (uint32_t i = 0; i < COUNT; i++) {
+        ring.push(i);
+      }
+    });
+    uint32_t val;
+    for (uint32_t received = 0; received < COUNT;) {
+      if (ring.try_pop(val)) {
+        num1 = (int)val;
+        received++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+    report("MPMCQueue     ");
+  }
+}
+// Bulk push_back of small trivially copyable structs - exercises the growth / relocation path
+static void VEC_GROWTH() {
+  struct Particle {
+    float x, y;
+    uint32_t id;
+  };
+  constexpr uint32_t COUNT = 100'000'000;
+  {
+    now();
+    std::vector<Particle> particles;
+    for (uint32_t i = 0; i < COUNT; i++) {
+      particles.push_back({(float)i, 1.0F, i});
+    }
+    num1 = (int)particles.back().id;
+    printTime<std::chrono::milliseconds>("std::vector");
+  }
+  {
+    now();
+    vec<Particle> particles;
+    for (uint32_t i = 0; i < COUNT; i++) {
+      particles.push_back({(float)i, 1.0F, i});
+    }
+    num1 = (int)particles.back().id;
+    printTime<std::chrono::milliseconds>("cxstructs::vec");
+  }
+}
+// Node allocation churn - 30M list nodes allocated and freed
+static void POOL_ALLOCATOR() {
+  constexpr uint32_t COUNT = 10'000'000;
+  const auto run = [&](auto list, const char* label) {
+    now();
+    for (uint32_t round = 0; round < 3; round++) {
+      for (uint32_t i = 0; i < COUNT; i++) {
+        list.push_back((int)i);
+      }
+      num1 = (int)list.size();
+      list.clear();
+    }
+    printTime<std::chrono::milliseconds>(label);
+  };
+  run(LinkedList<int, std::allocator<cxhelper::ListNode<int>>>(), "std::allocator");
+  run(LinkedList<int, CXPoolAllocator<cxhelper::ListNode<int>>>(), "CXPoolAllocator");
+}
+// Random reads over 1GB - with 4KB pages nearly every lookup misses the TLB
+static void HUGE_PAGE_RANDOM_ACCESS() {
+  constexpr uint32_t COUNT = 1U << 28;  // 1GB of floats
+  constexpr uint32_t LOOKUPS = 50'000'000;
+  const auto run = [&](auto& table, const char* label) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    float sum = 0;
+    now();
+    for (uint32_t i = 0; i < LOOKUPS; i++) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      sum += table[(uint32_t)(state >> 36)];
+    }
+    num1 = (int)sum;
+    printTime<std::chrono::milliseconds>(label);
+  };
+  {
+    vec<float> table(COUNT, 1.0F);
+    run(table, "4KB pages");
+  }
+  {
+    vec<float, HugePageAllocator<float>> table(COUNT, 1.0F);
+    run(table, "huge pages");
+  }
+}
+// Per-request temporaries - heap allocations vs. bumping out of an arena that is rewound after each request
+static void ARENA_REQUESTS() {
+  constexpr uint32_t REQUESTS = 200'000;
+  const auto request = [](auto& numbers, auto& list) {
+    for (int i = 0; i < 512; i++) {
+      numbers.push_back(i);
+    }
+    for (int i = 0; i < 64; i++) {
+      list.push_back(i);
+    }
+    num1 = (int)(numbers.size() + list.size());
+  };
+  now();
+  for (uint32_t r = 0; r < REQUESTS; r++) {
+    vec<int> numbers(16);
+    LinkedList<int, std::allocator<cxhelper::ListNode<int>>> list;
+    request(numbers, list);
+  }
+  printTime<std::chrono::milliseconds>("std::allocator");
+
+  char buffer[16 * 1024];
+  MonotonicArena arena(buffer, sizeof(buffer));
+  now();
+  for (uint32_t r = 0; r < REQUESTS; r++) {
+    MonotonicArena::Scope scope(arena);
+    vec<int, ArenaAllocator<int>> numbers(16);
+    LinkedList<int, ArenaAllocator<cxhelper::ListNode<int>>> list;
+    request(numbers, list);
+  }
+  printTime<std::chrono::milliseconds>("MonotonicArena");
+}
+// Append and traversal - contiguous vs. per-node vs. chunked lists
+static void UNROLLED_LIST() {
+  constexpr uint32_t COUNT = 10'000'000;
+  const auto run = [&](auto& list, const char* label) {
+    now();
+    for (uint32_t i = 0; i < COUNT; i++) {
+      list.push_back((int)i);
+    }
+    printTime<std::chrono::milliseconds>(label);
+    now();
+    int64_t sum = 0;
+    for (uint32_t round = 0; round < 10; round++) {
+      for (const int val : list) {
+        sum += val;
+      }
+    }
+    num1 = (int)sum;
+    printTime<std::chrono::milliseconds>("  10x iteration");
+  };
+  {
+    vec<int> list;
+    run(list, "cxstructs::vec append");
+  }
+  {
+    std::list<int> list;
+    run(list, "std::list append");
+  }
+  {
+    LinkedList<int> list;
+    run(list, "cxstructs::LinkedList append");
+  }
+  {
+    UnrolledLinkedList<int> list;
+    run(list, "cxstructs::UnrolledLinkedList append");
+  }
+}
+
+static void LRU_CACHE() {
+  constexpr uint32_t CAPACITY = 100'000;
+  constexpr uint32_t OPERATIONS = 10'000'000;
+  std::mt19937 rng(42);
+  std::vector<int> keys(OPERATIONS);
+  for (auto& key : keys) {
+    key = (int)(rng() % (CAPACITY * 2));
+  }
+
+  {
+    using Order = std::list<std::pair<int, int64_t>>;
+    Order order;
+    std::unordered_map<int, Order::iterator> map;
+    now();
+    int64_t sum = 0;
+    for (const int key : keys) {
+      auto it = map.find(key);
+      if (it != map.end()) {
+        order.splice(order.begin(), order, it->second);
+        sum += it->second->second;
+        continue;
+      }
+      if (map.size() == CAPACITY) {
+        map.erase(order.back().first);
+        order.pop_back();
+      }
+      order.emplace_front(key, key);
+      map.emplace(key, order.begin());
+    }
+    num1 = (int)sum;
+    printTime<std::chrono::milliseconds>("std::list + std::unordered_map");
+  }
+  {
+    LRUCache<int, int64_t> cache(CAPACITY);
+    now();
+    int64_t sum = 0;
+    for (const int key : keys) {
+      if (int64_t* value = cache.get(key)) {
+        sum += *value;
+      } else {
+        cache.put(key, key);
+      }
+    }
+    num1 = (int)sum;
+    printTime<std::chrono::milliseconds>("cxstructs::LRUCache");
+  }
+}
 #endif  //CXSTRUCTS_SRC_BENCHMARK_H_
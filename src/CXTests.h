@@ -40,6 +40,24 @@ static void test_cxstructs() {
   BinaryTree<int>::TEST();
   QuadTree<Point>::TEST();
   PriorityQueue<int>::TEST();
+  IndexedPriorityQueue<int>::TEST();
+  RadixHeap<uint32_t, int>::TEST();
+  BucketQueue<int>::TEST();
+  MultiQueue<uint32_t, int>::TEST();
+  SweepAndPrune::TEST();
+  AABBTree<int>::TEST();
+  SPSCQueue<int>::TEST();
+  MPMCQueue<int>::TEST();
+  WorkStealingDeque<int>::TEST();
+  WorkStealingPool::TEST();
+  UnrolledLinkedList<int>::TEST();
+  TEST_INTRUSIVE_LIST();
+  LRUCache<int, int>::TEST();
+  ShardedLRUCache<int, int>::TEST();
+  CXPoolAllocator<int>::TEST();
+  HugePageAllocator<float>::TEST();
+  MonotonicArena::TEST();
+  TrackingAllocator<int>::TEST();
 }
 
 static void test_cxalgos() {
@@ -50,6 +68,10 @@ static void test_cxalgos() {
   TEST_PATH_FINDING();
 }
 
+static void test_cxutil() {
+  TEST_EXEC();
+}
+
 static void test_cxml() {
   FNN::TEST();
   kNN_2D<DataPoint_<float>>::TEST();
@@ -59,6 +81,7 @@ static void test_cxml() {
 static void test_all() {
   test_cxstructs();
   test_cxalgos();
+  test_cxutil();
   test_cxml();
   std::cout << "\nAll tests passed!" << std::endl;
 }
@@ -21,14 +21,20 @@
 #ifndef CXSTRUCTS_ASTAR_PATHFINDING_H
 #  define CXSTRUCTS_ASTAR_PATHFINDING_H
 
+#  include <algorithm>
+#  include <atomic>
+#  include <bit>
 #  include <cstdint>
 #  include <queue>
 #  include <type_traits>
+#  include <vector>
 #  include "../cxconfig.h"
 #  include "../cxstructs/Geometry.h"
 #  include "../cxstructs/HashSet.h"
 #  include "../cxstructs/Pair.h"
 #  include "../cxstructs/PriorityQueue.h"
+#  include "../cxstructs/RadixHeap.h"
+#  include "../cxutil/cxexec.h"
 
 namespace cxhelper {
 using namespace cxstructs;
@@ -85,10 +91,11 @@ using namespace cxhelper;
 template <typename S, typename B>
 std::vector<Point> astar_pathfinding(const std::vector<std::vector<S>>& field, const B& blocked_val,
                                      const Point& start, const Point& target) {
-  PriorityQueue<Node> frontier;
+  MonotoneQueue<decltype(Node::f_cost), Node> frontier;  // Integral costs - picks a RadixHeap
   HashSet<Point> closedSet;
   vec<row<2, int>> directions = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-  frontier.emplace(start, 0, start.dist(target), nullptr);
+  const Node startNode(start, 0, start.dist(target), nullptr);
+  frontier.push(startNode.f_cost, startNode);
   while (!frontier.empty()) {
     Node* current = new Node(frontier.top());
     frontier.pop();
@@ -110,13 +117,1175 @@ std::vector<Point> astar_pathfinding(const std::vector<std::vector<S>>& field, c
         uint16_t h_cost =
             abs(newX - static_cast<int>(target.x())) + abs(newY - static_cast<int>(target.y()));
 
-        frontier.emplace(new_pos, tentative_g_cost, h_cost, current);
+        const Node next(new_pos, tentative_g_cost, h_cost, current);
+        frontier.push(next.f_cost, next);
       }
     }
   }
   return {};
 }
 
+/**
+ * Non-owning view of a contiguous, row major grid of width * height cells<p>
+ * Cells equal to blocked are obstacles - everything else is walkable with uniform cost
+ */
+template <typename S>
+struct GridView {
+  const S* cells;
+  int width;
+  int height;
+  S blocked;
+
+  [[nodiscard]] inline bool in_bounds(const int x, const int y) const noexcept {
+    return x >= 0 && y >= 0 && x < width && y < height;
+  }
+  [[nodiscard]] inline bool walkable(const int x, const int y) const noexcept {
+    return in_bounds(x, y) && cells[y * width + x] != blocked;
+  }
+  [[nodiscard]] inline uint32_t index(const int x, const int y) const noexcept { return y * width + x; }
+  [[nodiscard]] inline uint32_t size() const noexcept { return width * height; }
+};
+
+/**
+ * Movement model of the grid pathfinders
+ */
+enum class GridMove : uint8_t {
+  CARDINAL,  // 4 directions with unit cost - manhattan heuristic
+  OCTILE,    // 8 directions, straight costs 10 and diagonal 14 - octile heuristic - never cuts past a blocked corner
+};
+inline constexpr uint32_t GRID_STRAIGHT_COST = 10;
+inline constexpr uint32_t GRID_DIAGONAL_COST = 14;
+/**
+ * Octile distance - exact cost between two cells on an open 8-connected grid
+ */
+inline uint32_t octile_distance(int dx, int dy) noexcept {
+  dx = std::abs(dx);
+  dy = std::abs(dy);
+  return dx > dy ? GRID_STRAIGHT_COST * dx + (GRID_DIAGONAL_COST - GRID_STRAIGHT_COST) * dy
+                 : GRID_STRAIGHT_COST * dy + (GRID_DIAGONAL_COST - GRID_STRAIGHT_COST) * dx;
+}
+
+/**
+ * Entry of the open list - costs are stored per cell in the PathContext
+ */
+struct GridNode {
+  uint32_t f_cost;
+  uint32_t g_cost;
+  uint32_t cell;
+  // Ties prefer the node closer to the target (larger g)
+  inline bool operator>(const GridNode& o) const {
+    return f_cost > o.f_cost || (f_cost == o.f_cost && g_cost < o.g_cost);
+  }
+};
+
+/**
+ * <h2>PathContext</h2>
+ * Reusable search state for the grid pathfinders.<p>
+ * All per cell data lives in flat arrays indexed by cell. Instead of clearing them every search a generation counter
+ * is advanced - a cell only counts as visited if its stamp matches the current generation. Clearing is O(1) and once
+ * the arrays and the open list reached their peak size a search does zero allocations.<p>
+ * Not thread safe - use one context per thread
+ */
+struct PathContext {
+  std::vector<PointI> scratch;   // Jump points before they are expanded into a full path
+  std::vector<uint32_t> costs;  // Costs of the temporary start and target edges of hierarchical searches
+  std::vector<uint32_t> g_cost;
+  std::vector<uint32_t> parent;
+  std::vector<uint32_t> stamp;  // == generation: open, == generation + 1: closed
+  MonotoneQueue<decltype(GridNode::f_cost), GridNode> open;  // Integral costs - picks a RadixHeap
+  uint32_t generation = 0;
+  uint32_t expanded = 0;  // Nodes expanded by the last search
+
+  /**
+   * Prepares the context for a new search on a grid with the given amount of cells - the arrays only ever grow
+   */
+  inline void begin(const uint32_t cellCount) {
+    if (stamp.size() < cellCount) {
+      g_cost.resize(cellCount);
+      parent.resize(cellCount);
+      stamp.assign(cellCount, 0);
+      generation = 0;
+    }
+    generation += 2;
+    if (generation >= UINT32_MAX - 2) [[unlikely]] {
+      std::fill(stamp.begin(), stamp.end(), 0);
+      generation = 2;
+    }
+    open.reset();
+    expanded = 0;
+  }
+  inline void push(const GridNode& node) { open.push(node.f_cost, node); }
+  [[nodiscard]] inline bool visited(const uint32_t cell) const noexcept { return stamp[cell] >= generation; }
+  [[nodiscard]] inline bool closed(const uint32_t cell) const noexcept { return stamp[cell] == generation + 1; }
+  inline void close(const uint32_t cell) noexcept { stamp[cell] = generation + 1; }
+  /**
+   * Records a new best cost for the cell - returns false if the cell already has a better or equal one
+   */
+  inline bool relax(const uint32_t cell, const uint32_t g, const uint32_t from) noexcept {
+    if (visited(cell) && g >= g_cost[cell]) return false;
+    stamp[cell] = generation;
+    g_cost[cell] = g;
+    parent[cell] = from;
+    return true;
+  }
+  /**
+   * Writes the path from the search start to target into path (start first)
+   */
+  inline void reconstruct(const uint32_t target, const int width, std::vector<PointI>& path) const {
+    path.clear();
+    uint32_t cell = target;
+    while (true) {
+      path.emplace_back((int)(cell % width), (int)(cell / width));
+      if (parent[cell] == cell) break;
+      cell = parent[cell];
+    }
+    std::reverse(path.begin(), path.end());
+  }
+  /**
+   * Like reconstruct() but for searches that link jump points - every cell in between is filled in
+   */
+  inline void reconstruct_jumps(const uint32_t target, const int width, std::vector<PointI>& path) {
+    reconstruct(target, width, scratch);
+    path.clear();
+    path.push_back(scratch[0]);
+    for (size_t i = 1; i < scratch.size(); i++) {
+      PointI p = scratch[i - 1];
+      const PointI& next = scratch[i];
+      const int dx = (next.x > p.x) - (next.x < p.x);
+      const int dy = (next.y > p.y) - (next.y < p.y);
+      while (p != next) {
+        p.x += dx;
+        p.y += dy;
+        path.push_back(p);
+      }
+    }
+  }
+};
+
+/**
+ * <h2>A star on a flat grid</h2>
+ * Same search as astar_pathfinding() but on a contiguous grid and with all state in a reusable PathContext - no
+ * allocations once the context is warmed up.<p>
+ * Duplicates in the open list are skipped on pop instead of using decrease-key.
+ *
+ * @param grid the search space
+ * @param start the starting cell
+ * @param target the target cell
+ * @param ctx search state - can be reused across searches and grids
+ * @param path receives the path from start to target (both included) - cleared if no path exists
+ * @param move 4 directions (default, same as astar_pathfinding()) or 8 directions
+ * @return true if a path was found
+ */
+template <typename S>
+bool astar_grid(const GridView<S>& grid, const PointI& start, const PointI& target, PathContext& ctx,
+                std::vector<PointI>& path, const GridMove move = GridMove::CARDINAL) {
+  path.clear();
+  if (!grid.walkable(start.x, start.y) || !grid.walkable(target.x, target.y)) return false;
+
+  constexpr int dirs[8][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+  const bool octile = move == GridMove::OCTILE;
+  const int dirCount = octile ? 8 : 4;
+  ctx.begin(grid.size());
+  const uint32_t startCell = grid.index(start.x, start.y);
+  const uint32_t targetCell = grid.index(target.x, target.y);
+  const auto heuristic = [&](const int x, const int y) {
+    return octile ? octile_distance(x - target.x, y - target.y)
+                  : (uint32_t)(std::abs(x - target.x) + std::abs(y - target.y));
+  };
+
+  ctx.relax(startCell, 0, startCell);
+  ctx.push({heuristic(start.x, start.y), 0, startCell});
+  while (!ctx.open.empty()) {
+    const GridNode current = ctx.open.top();
+    ctx.open.pop();
+    if (ctx.closed(current.cell) || current.g_cost != ctx.g_cost[current.cell]) continue;  // Stale duplicate
+    if (current.cell == targetCell) {
+      ctx.reconstruct(targetCell, grid.width, path);
+      return true;
+    }
+    ctx.close(current.cell);
+    ctx.expanded++;
+
+    const int x = (int)(current.cell % grid.width);
+    const int y = (int)(current.cell / grid.width);
+    for (int i = 0; i < dirCount; i++) {
+      const int nx = x + dirs[i][0];
+      const int ny = y + dirs[i][1];
+      if (!grid.walkable(nx, ny)) continue;
+      const bool diagonal = i >= 4;
+      if (diagonal && (!grid.walkable(nx, y) || !grid.walkable(x, ny))) continue;  // No corner cutting
+      const uint32_t next = grid.index(nx, ny);
+      if (ctx.closed(next)) continue;
+      const uint32_t g =
+          current.g_cost + (octile ? (diagonal ? GRID_DIAGONAL_COST : GRID_STRAIGHT_COST) : 1);
+      if (ctx.relax(next, g, current.cell)) {
+        ctx.push({g + heuristic(nx, ny), g, next});
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * <h2>BitGrid</h2>
+ * Obstacle grid packed into 1 bit per cell (set = blocked) for Jump Point Search.<p>
+ * Rows are padded to whole 64 bit words and a transposed copy is kept, so horizontal and vertical jumps both test
+ * 64 cells per word operation. Everything outside the grid counts as blocked.
+ */
+class BitGrid {
+  std::vector<uint64_t> rows_;     // height * rowWords_
+  std::vector<uint64_t> columns_;  // width * colWords_
+  int width_;
+  int height_;
+  int rowWords_;
+  int colWords_;
+
+  static inline void set_bit(uint64_t* line, const int pos, const bool value) noexcept {
+    if (value) {
+      line[pos >> 6] |= 1ULL << (pos & 63);
+    } else {
+      line[pos >> 6] &= ~(1ULL << (pos & 63));
+    }
+  }
+  // Word of line at index - lines outside the grid are fully blocked
+  static inline uint64_t word(const uint64_t* lines, const int lineWords, const int lineCount, const int line,
+                              const int index) noexcept {
+    if (line < 0 || line >= lineCount || index < 0 || index >= lineWords) return ~0ULL;
+    return lines[line * lineWords + index];
+  }
+  /**
+   * Straight jump along a line (row or transposed column) starting after pos in direction dir.<p>
+   * A cell is a jump point if it is free and one of its side cells is free while the side cell one step behind is
+   * blocked. Returns the position of the first jump point (or target) - or -1 if a blocked cell comes first
+   */
+  static int scan(const uint64_t* lines, const int lineWords, const int lineCount, const int line, const int pos,
+                  const int dir, const int target) noexcept {
+    if (dir > 0) {
+      const int first = pos + 1;
+      for (int w = first >> 6; w < lineWords; w++) {
+        const uint64_t cur = word(lines, lineWords, lineCount, line, w);
+        const uint64_t up = word(lines, lineWords, lineCount, line - 1, w);
+        const uint64_t down = word(lines, lineWords, lineCount, line + 1, w);
+        // Bit p of the shifted words is the cell at p - 1 (behind)
+        const uint64_t upBehind = (up << 1) | (word(lines, lineWords, lineCount, line - 1, w - 1) >> 63);
+        const uint64_t downBehind = (down << 1) | (word(lines, lineWords, lineCount, line + 1, w - 1) >> 63);
+        uint64_t stops = cur | (~up & upBehind) | (~down & downBehind);
+        if (target >= 0 && (target >> 6) == w) stops |= 1ULL << (target & 63);
+        if (w == first >> 6) stops &= ~0ULL << (first & 63);
+        if (stops != 0) {
+          const int p = (w << 6) + std::countr_zero(stops);
+          return p == target || !(cur >> (p & 63) & 1) ? p : -1;
+        }
+      }
+    } else {
+      const int first = pos - 1;
+      if (first < 0) return -1;
+      for (int w = first >> 6; w >= 0; w--) {
+        const uint64_t cur = word(lines, lineWords, lineCount, line, w);
+        const uint64_t up = word(lines, lineWords, lineCount, line - 1, w);
+        const uint64_t down = word(lines, lineWords, lineCount, line + 1, w);
+        // Bit p of the shifted words is the cell at p + 1 (behind)
+        const uint64_t upBehind = (up >> 1) | (word(lines, lineWords, lineCount, line - 1, w + 1) << 63);
+        const uint64_t downBehind = (down >> 1) | (word(lines, lineWords, lineCount, line + 1, w + 1) << 63);
+        uint64_t stops = cur | (~up & upBehind) | (~down & downBehind);
+        if (target >= 0 && (target >> 6) == w) stops |= 1ULL << (target & 63);
+        if (w == first >> 6 && (first & 63) != 63) stops &= (1ULL << ((first & 63) + 1)) - 1;
+        if (stops != 0) {
+          const int p = (w << 6) + 63 - std::countl_zero(stops);
+          return p == target || !(cur >> (p & 63) & 1) ? p : -1;
+        }
+      }
+    }
+    return -1;
+  }
+
+ public:
+  /**
+   * Creates a grid without obstacles
+   */
+  BitGrid(const int width, const int height)
+      : width_(width), height_(height), rowWords_((width + 63) / 64), colWords_((height + 63) / 64) {
+    rows_.assign((size_t)height * rowWords_, 0);
+    columns_.assign((size_t)width * colWords_, 0);
+    // Padding bits are blocked so scans stop at the border
+    for (int y = 0; y < height; y++) {
+      for (int x = width; x < rowWords_ * 64; x++) {
+        set_bit(&rows_[(size_t)y * rowWords_], x, true);
+      }
+    }
+    for (int x = 0; x < width; x++) {
+      for (int y = height; y < colWords_ * 64; y++) {
+        set_bit(&columns_[(size_t)x * colWords_], y, true);
+      }
+    }
+  }
+  template <typename S>
+  explicit BitGrid(const GridView<S>& grid) : BitGrid(grid.width, grid.height) {
+    for (int y = 0; y < height_; y++) {
+      for (int x = 0; x < width_; x++) {
+        if (!grid.walkable(x, y)) set_blocked(x, y, true);
+      }
+    }
+  }
+  inline void set_blocked(const int x, const int y, const bool blocked) noexcept {
+    set_bit(&rows_[(size_t)y * rowWords_], x, blocked);
+    set_bit(&columns_[(size_t)x * colWords_], y, blocked);
+  }
+  [[nodiscard]] inline bool walkable(const int x, const int y) const noexcept {
+    return x >= 0 && y >= 0 && x < width_ && y < height_ && !(rows_[(size_t)y * rowWords_ + (x >> 6)] >> (x & 63) & 1);
+  }
+  [[nodiscard]] inline int width() const noexcept { return width_; }
+  [[nodiscard]] inline int height() const noexcept { return height_; }
+  [[nodiscard]] inline uint32_t index(const int x, const int y) const noexcept { return y * width_ + x; }
+  [[nodiscard]] inline uint32_t size() const noexcept { return width_ * height_; }
+  /**
+   * Jumps from (x,y) along the row in direction dx - returns the x of the next jump point or -1
+   * @param targetX x of the target if it lies in this row, -1 otherwise
+   */
+  [[nodiscard]] inline int jump_horizontal(const int x, const int y, const int dx, const int targetX) const noexcept {
+    return scan(rows_.data(), rowWords_, height_, y, x, dx, targetX);
+  }
+  /**
+   * Jumps from (x,y) along the column in direction dy - returns the y of the next jump point or -1
+   * @param targetY y of the target if it lies in this column, -1 otherwise
+   */
+  [[nodiscard]] inline int jump_vertical(const int x, const int y, const int dy, const int targetY) const noexcept {
+    return scan(columns_.data(), colWords_, width_, x, y, dy, targetY);
+  }
+};
+
+}  // namespace cxstructs
+
+namespace cxhelper {
+// The 8 directions - straight first
+inline constexpr int JPS_DX[8] = {1, -1, 0, 0, 1, -1, 1, -1};
+inline constexpr int JPS_DY[8] = {0, 0, 1, -1, 1, 1, -1, -1};
+inline int jps_dir_index(const int dx, const int dy) noexcept {
+  for (int i = 0; i < 8; i++) {
+    if (JPS_DX[i] == dx && JPS_DY[i] == dy) return i;
+  }
+  return -1;
+}
+// Directions worth exploring when arriving with (dx,dy) - all 8 at the start
+// Without corner cutting the forced neighbors of straight moves are the perpendicular cells
+inline int jps_successor_dirs(const int dx, const int dy, int* out) noexcept {
+  int count = 0;
+  if (dx == 0 && dy == 0) {
+    for (int i = 0; i < 8; i++) {
+      out[count++] = i;
+    }
+  } else if (dx != 0 && dy != 0) {
+    out[count++] = jps_dir_index(dx, 0);
+    out[count++] = jps_dir_index(0, dy);
+    out[count++] = jps_dir_index(dx, dy);
+  } else if (dx != 0) {
+    out[count++] = jps_dir_index(dx, 0);
+    out[count++] = jps_dir_index(dx, 1);
+    out[count++] = jps_dir_index(dx, -1);
+    out[count++] = jps_dir_index(0, 1);
+    out[count++] = jps_dir_index(0, -1);
+  } else {
+    out[count++] = jps_dir_index(0, dy);
+    out[count++] = jps_dir_index(1, dy);
+    out[count++] = jps_dir_index(-1, dy);
+    out[count++] = jps_dir_index(1, 0);
+    out[count++] = jps_dir_index(-1, 0);
+  }
+  return count;
+}
+// Diagonal step without cutting past a blocked corner
+inline bool jps_can_step_diagonal(const cxstructs::BitGrid& grid, const int x, const int y, const int dx,
+                                  const int dy) noexcept {
+  return grid.walkable(x + dx, y + dy) && grid.walkable(x + dx, y) && grid.walkable(x, y + dy);
+}
+// Jumps from (x,y) in direction (dx,dy) - returns false if no jump point is found
+inline bool jps_jump(const cxstructs::BitGrid& grid, int x, int y, const int dx, const int dy,
+                     const cxstructs::PointI& target, cxstructs::PointI& out) noexcept {
+  if (dy == 0) {
+    const int jx = grid.jump_horizontal(x, y, dx, target.y == y ? target.x : -1);
+    out = {jx, y};
+    return jx != -1;
+  }
+  if (dx == 0) {
+    const int jy = grid.jump_vertical(x, y, dy, target.x == x ? target.y : -1);
+    out = {x, jy};
+    return jy != -1;
+  }
+  while (jps_can_step_diagonal(grid, x, y, dx, dy)) {
+    x += dx;
+    y += dy;
+    if ((x == target.x && y == target.y)
+        || grid.jump_horizontal(x, y, dx, target.y == y ? target.x : -1) != -1
+        || grid.jump_vertical(x, y, dy, target.x == x ? target.y : -1) != -1) {
+      out = {x, y};
+      return true;
+    }
+  }
+  return false;
+}
+// Shared A* loop of JPS and JPS+ - successors(x, y, dx, dy, emit(point)) generates the jump points
+template <typename Successors>
+bool jps_search(const int width, const uint32_t size, const cxstructs::PointI& start, const cxstructs::PointI& target,
+                cxstructs::PathContext& ctx, std::vector<cxstructs::PointI>& path, Successors successors) {
+  ctx.begin(size);
+  const uint32_t startCell = start.y * width + start.x;
+  const uint32_t targetCell = target.y * width + target.x;
+
+  ctx.relax(startCell, 0, startCell);
+  ctx.push({cxstructs::octile_distance(start.x - target.x, start.y - target.y), 0, startCell});
+  while (!ctx.open.empty()) {
+    const cxstructs::GridNode current = ctx.open.top();
+    ctx.open.pop();
+    if (ctx.closed(current.cell) || current.g_cost != ctx.g_cost[current.cell]) continue;  // Stale duplicate
+    if (current.cell == targetCell) {
+      ctx.reconstruct_jumps(targetCell, width, path);
+      return true;
+    }
+    ctx.close(current.cell);
+    ctx.expanded++;
+
+    const int x = (int)(current.cell % width);
+    const int y = (int)(current.cell / width);
+    const uint32_t parent = ctx.parent[current.cell];
+    const int px = (int)(parent % width);
+    const int py = (int)(parent / width);
+    successors(x, y, (x > px) - (x < px), (y > py) - (y < py), [&](const cxstructs::PointI& jump) {
+      const uint32_t next = jump.y * width + jump.x;
+      if (ctx.closed(next)) return;
+      const uint32_t g = current.g_cost + cxstructs::octile_distance(jump.x - x, jump.y - y);
+      if (ctx.relax(next, g, current.cell)) {
+        ctx.push({g + cxstructs::octile_distance(jump.x - target.x, jump.y - target.y), g, next});
+      }
+    });
+  }
+  return false;
+}
+}  // namespace cxhelper
+
+namespace cxstructs {
+
+/**
+ * <h2>Jump Point Search</h2>
+ * Optimal 8-directional search (same paths costs as astar_grid() with GridMove::OCTILE) that only expands jump
+ * points - cells where the optimal path can change direction. Straight runs are skipped 64 cells at a time using the
+ * BitGrid. On open maps this expands orders of magnitude fewer nodes than A*.<p>
+ * The returned path contains every cell, not just the jump points.
+ *
+ * @param grid the obstacle grid
+ * @param start the starting cell
+ * @param target the target cell
+ * @param ctx search state - can be reused across searches and grids
+ * @param path receives the path from start to target (both included) - cleared if no path exists
+ * @return true if a path was found
+ */
+inline bool jps_grid(const BitGrid& grid, const PointI& start, const PointI& target, PathContext& ctx,
+                     std::vector<PointI>& path) {
+  using namespace cxhelper;
+  path.clear();
+  if (!grid.walkable(start.x, start.y) || !grid.walkable(target.x, target.y)) return false;
+  return jps_search(grid.width(), grid.size(), start, target, ctx, path,
+                    [&](const int x, const int y, const int dx, const int dy, const auto& emit) {
+                      int dirs[8];
+                      const int count = jps_successor_dirs(dx, dy, dirs);
+                      PointI jump;
+                      for (int i = 0; i < count; i++) {
+                        if (jps_jump(grid, x, y, JPS_DX[dirs[i]], JPS_DY[dirs[i]], target, jump)) emit(jump);
+                      }
+                    });
+}
+
+/**
+ * <h2>JPS+ jump table</h2>
+ * Precomputed jump distances for every cell and direction of a static BitGrid.<p>
+ * Positive values are the distance to the next jump point, zero or negative values the (negated) number of free
+ * cells before a wall. Uses 16 bytes per cell and must be rebuilt when the grid changes. Grids are limited to
+ * 32767 cells per side.
+ */
+class JPSPlusTable {
+  std::vector<int16_t> dist_;  // cell * 8 + direction
+  int width_ = 0;
+  int height_ = 0;
+
+  [[nodiscard]] static bool straight_jump_point(const BitGrid& grid, const int x, const int y, const int dx,
+                                                const int dy) noexcept {
+    if (dy == 0) {
+      return (grid.walkable(x, y - 1) && !grid.walkable(x - dx, y - 1))
+          || (grid.walkable(x, y + 1) && !grid.walkable(x - dx, y + 1));
+    }
+    return (grid.walkable(x - 1, y) && !grid.walkable(x - 1, y - dy))
+        || (grid.walkable(x + 1, y) && !grid.walkable(x + 1, y - dy));
+  }
+  [[nodiscard]] static int16_t step(const int16_t next) noexcept {
+    return next > 0 ? (int16_t)(next + 1) : (int16_t)(next - 1);
+  }
+
+ public:
+  JPSPlusTable() = default;
+  explicit JPSPlusTable(const BitGrid& grid) { build(grid); }
+  void build(const BitGrid& grid) {
+    using namespace cxhelper;
+    CX_ASSERT(grid.width() <= INT16_MAX && grid.height() <= INT16_MAX, "Grid too large for 16 bit jump distances");
+    width_ = grid.width();
+    height_ = grid.height();
+    dist_.assign((size_t)grid.size() * 8, 0);
+    // Every direction is swept so the next cell is always computed first
+    for (int dir = 0; dir < 8; dir++) {
+      const int dx = JPS_DX[dir];
+      const int dy = JPS_DY[dir];
+      const bool diagonal = dx != 0 && dy != 0;
+      if (diagonal) continue;  // Diagonals need the straight values
+      for (int yi = 0; yi < height_; yi++) {
+        const int y = dy > 0 ? height_ - 1 - yi : yi;
+        for (int xi = 0; xi < width_; xi++) {
+          const int x = dx > 0 ? width_ - 1 - xi : xi;
+          if (!grid.walkable(x, y)) continue;
+          const int nx = x + dx;
+          const int ny = y + dy;
+          int16_t& d = dist_[(size_t)grid.index(x, y) * 8 + dir];
+          if (!grid.walkable(nx, ny)) {
+            d = 0;
+          } else if (straight_jump_point(grid, nx, ny, dx, dy)) {
+            d = 1;
+          } else {
+            d = step(dist_[(size_t)grid.index(nx, ny) * 8 + dir]);
+          }
+        }
+      }
+    }
+    for (int dir = 4; dir < 8; dir++) {
+      const int dx = JPS_DX[dir];
+      const int dy = JPS_DY[dir];
+      const int horizontal = jps_dir_index(dx, 0);
+      const int vertical = jps_dir_index(0, dy);
+      for (int yi = 0; yi < height_; yi++) {
+        const int y = dy > 0 ? height_ - 1 - yi : yi;
+        for (int xi = 0; xi < width_; xi++) {
+          const int x = dx > 0 ? width_ - 1 - xi : xi;
+          if (!grid.walkable(x, y)) continue;
+          int16_t& d = dist_[(size_t)grid.index(x, y) * 8 + dir];
+          if (!jps_can_step_diagonal(grid, x, y, dx, dy)) {
+            d = 0;
+            continue;
+          }
+          const size_t next = (size_t)grid.index(x + dx, y + dy) * 8;
+          d = dist_[next + horizontal] > 0 || dist_[next + vertical] > 0 ? 1 : step(dist_[next + dir]);
+        }
+      }
+    }
+  }
+  /**
+   * @return the jump distance of the cell in direction dir (index into cxhelper::JPS_DX / JPS_DY)
+   */
+  [[nodiscard]] inline int distance(const uint32_t cell, const int dir) const noexcept {
+    return dist_[(size_t)cell * 8 + dir];
+  }
+  [[nodiscard]] inline bool matches(const BitGrid& grid) const noexcept {
+    return grid.width() == width_ && grid.height() == height_;
+  }
+};
+
+/**
+ * <h2>JPS+</h2>
+ * Jump Point Search with precomputed jump distances - each jump is a single table lookup instead of a scan.<p>
+ * For static maps - the table has to be built from the same grid
+ *
+ * @param grid the obstacle grid the table was built from
+ * @param table precomputed jump distances
+ * @param start the starting cell
+ * @param target the target cell
+ * @param ctx search state - can be reused across searches and grids
+ * @param path receives the path from start to target (both included) - cleared if no path exists
+ * @return true if a path was found
+ */
+inline bool jps_plus_grid(const BitGrid& grid, const JPSPlusTable& table, const PointI& start, const PointI& target,
+                          PathContext& ctx, std::vector<PointI>& path) {
+  using namespace cxhelper;
+  CX_ASSERT(table.matches(grid), "Table was built for a different grid");
+  path.clear();
+  if (!grid.walkable(start.x, start.y) || !grid.walkable(target.x, target.y)) return false;
+  return jps_search(
+      grid.width(), grid.size(), start, target, ctx, path,
+      [&](const int x, const int y, const int dx, const int dy, const auto& emit) {
+        int dirs[8];
+        const int count = jps_successor_dirs(dx, dy, dirs);
+        const uint32_t cell = grid.index(x, y);
+        const int tx = target.x - x;
+        const int ty = target.y - y;
+        for (int i = 0; i < count; i++) {
+          const int ddx = JPS_DX[dirs[i]];
+          const int ddy = JPS_DY[dirs[i]];
+          const int d = table.distance(cell, dirs[i]);
+          const int reach = d < 0 ? -d : d;
+          if (ddx == 0 || ddy == 0) {
+            // Target on this line and before the wall or jump point
+            const int along = ddx != 0 ? tx * ddx : ty * ddy;
+            const bool onLine = ddx != 0 ? ty == 0 : tx == 0;
+            if (onLine && along > 0 && along <= reach) {
+              emit(target);
+            } else if (d > 0) {
+              emit({x + ddx * d, y + ddy * d});
+            }
+          } else {
+            // Target in this quadrant - stop where its row or column is reached
+            const int steps = std::min(tx * ddx, ty * ddy);
+            if (tx * ddx > 0 && ty * ddy > 0 && steps <= reach) {
+              emit({x + ddx * steps, y + ddy * steps});
+            } else if (d > 0) {
+              emit({x + ddx * d, y + ddy * d});
+            }
+          }
+        }
+      });
+}
+
+/**
+ * <h2>HierarchicalGrid</h2>
+ * Hierarchical pathfinding (HPA*) for long distance queries.<p>
+ * The grid is split into square clusters. Where walkable cells line up across a cluster border, entrance nodes are
+ * placed (one in the middle of short openings, one at each end of long ones). The cost between every pair of entrance
+ * nodes inside a cluster is precomputed. A query connects start and target to the entrances of their clusters,
+ * searches this small abstract graph and then refines each abstract edge with a search bounded to one cluster.<p>
+ * Paths are near optimal - they always pass through entrance nodes.<p>
+ * Changing a cell only marks its cluster (and the neighbor across the border if the cell lies on one) dirty. Dirty
+ * clusters are rebuilt on the next query or by calling update().
+ */
+class HierarchicalGrid {
+  static constexpr uint32_t NO_CELL = UINT32_MAX;
+  static constexpr uint16_t NO_NODE = UINT16_MAX;
+  static constexpr int SPLIT_ENTRANCE = 6;  // Openings at least this wide get an entrance at both ends
+
+  struct Link {
+    uint16_t node;  // Entrance node of this cluster
+    uint32_t cell;  // Cell on the other side of the border
+    uint32_t id;    // Abstract node of that cell
+  };
+  struct Cluster {
+    std::vector<uint32_t> nodes;      // Cells of the entrance nodes
+    std::vector<uint32_t> distances;  // nodes * nodes costs inside the cluster - NO_CELL if not connected
+    std::vector<Link> links;
+    bool dirty = true;
+  };
+
+  BitGrid bits_;
+  std::vector<Cluster> clusters_;
+  std::vector<uint16_t> localIndex_;  // Per cell - index into the nodes of its cluster or NO_NODE
+  PathContext buildCtx_;
+  int clusterSize_;
+  int clustersX_;
+  int clustersY_;
+  uint32_t capacity_;  // Max entrances per cluster - abstract node ids are cluster * capacity_ + index
+  int dirtyCount_ = 0;
+  GridMove move_;
+
+  [[nodiscard]] inline int cluster_of(const int x, const int y) const noexcept {
+    return (y / clusterSize_) * clustersX_ + x / clusterSize_;
+  }
+  [[nodiscard]] inline int cluster_of(const uint32_t cell) const noexcept {
+    return cluster_of((int)(cell % bits_.width()), (int)(cell / bits_.width()));
+  }
+  [[nodiscard]] inline uint32_t straight_cost() const noexcept {
+    return move_ == GridMove::OCTILE ? GRID_STRAIGHT_COST : 1;
+  }
+  [[nodiscard]] inline uint32_t heuristic(const uint32_t from, const uint32_t to) const noexcept {
+    const int dx = (int)(from % bits_.width()) - (int)(to % bits_.width());
+    const int dy = (int)(from / bits_.width()) - (int)(to / bits_.width());
+    return move_ == GridMove::OCTILE ? octile_distance(dx, dy) : (uint32_t)(std::abs(dx) + std::abs(dy));
+  }
+  inline void mark_dirty(const int cluster) noexcept {
+    if (!clusters_[cluster].dirty) {
+      clusters_[cluster].dirty = true;
+      dirtyCount_++;
+    }
+  }
+  /**
+   * Search bounded to the cells of one cluster - towards target or, with NO_CELL, a full dijkstra from source
+   */
+  bool search_cluster(const int cluster, const uint32_t source, const uint32_t target, PathContext& ctx) const {
+    constexpr int dirs[8][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+    const bool octile = move_ == GridMove::OCTILE;
+    const int x0 = (cluster % clustersX_) * clusterSize_;
+    const int y0 = (cluster / clustersX_) * clusterSize_;
+    const int x1 = std::min(x0 + clusterSize_, bits_.width());
+    const int y1 = std::min(y0 + clusterSize_, bits_.height());
+
+    ctx.begin(bits_.size());
+    ctx.relax(source, 0, source);
+    ctx.push({target == NO_CELL ? 0 : heuristic(source, target), 0, source});
+    while (!ctx.open.empty()) {
+      const GridNode current = ctx.open.top();
+      ctx.open.pop();
+      if (ctx.closed(current.cell) || current.g_cost != ctx.g_cost[current.cell]) continue;  // Stale duplicate
+      if (current.cell == target) return true;
+      ctx.close(current.cell);
+      ctx.expanded++;
+
+      const int x = (int)(current.cell % bits_.width());
+      const int y = (int)(current.cell / bits_.width());
+      for (int i = 0; i < (octile ? 8 : 4); i++) {
+        const int nx = x + dirs[i][0];
+        const int ny = y + dirs[i][1];
+        if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1 || !bits_.walkable(nx, ny)) continue;
+        const bool diagonal = i >= 4;
+        if (diagonal && (!bits_.walkable(nx, y) || !bits_.walkable(x, ny))) continue;  // No corner cutting
+        const uint32_t next = bits_.index(nx, ny);
+        if (ctx.closed(next)) continue;
+        const uint32_t g = current.g_cost + (diagonal ? GRID_DIAGONAL_COST : straight_cost());
+        if (ctx.relax(next, g, current.cell)) {
+          ctx.push({g + (target == NO_CELL ? 0 : heuristic(next, target)), g, next});
+        }
+      }
+    }
+    return target == NO_CELL;
+  }
+  inline uint16_t add_node(Cluster& cluster, const uint32_t cell) {
+    for (size_t i = 0; i < cluster.nodes.size(); i++) {
+      if (cluster.nodes[i] == cell) return (uint16_t)i;  // Corner cells can be entrances of two borders
+    }
+    cluster.nodes.push_back(cell);
+    return (uint16_t)(cluster.nodes.size() - 1);
+  }
+  /**
+   * Places the entrances of one border - (x,y) walks along the inside, (ox,oy) points across the border.
+   * Both clusters of a border run this with mirrored arguments and arrive at the same entrances
+   */
+  void add_border(Cluster& cluster, int x, int y, const int stepX, const int stepY, const int length, const int ox,
+                  const int oy) {
+    const auto open = [&](const int i) {
+      return bits_.walkable(x + stepX * i, y + stepY * i) && bits_.walkable(x + stepX * i + ox, y + stepY * i + oy);
+    };
+    const auto place = [&](const int i) {
+      const int cx = x + stepX * i;
+      const int cy = y + stepY * i;
+      const uint16_t node = add_node(cluster, bits_.index(cx, cy));
+      cluster.links.push_back({node, bits_.index(cx + ox, cy + oy), 0});
+    };
+    int i = 0;
+    while (i < length) {
+      if (!open(i)) {
+        i++;
+        continue;
+      }
+      const int begin = i;
+      while (i < length && open(i)) i++;
+      if (i - begin >= SPLIT_ENTRANCE) {
+        place(begin);
+        place(i - 1);
+      } else {
+        place(begin + (i - begin) / 2);
+      }
+    }
+  }
+  // Finds the entrances of a cluster
+  void place_entrances(const int index) {
+    Cluster& cluster = clusters_[index];
+    for (const uint32_t cell : cluster.nodes) {
+      localIndex_[cell] = NO_NODE;
+    }
+    cluster.nodes.clear();
+    cluster.links.clear();
+
+    const int cx = index % clustersX_;
+    const int cy = index / clustersX_;
+    const int x0 = cx * clusterSize_;
+    const int y0 = cy * clusterSize_;
+    const int w = std::min(clusterSize_, bits_.width() - x0);
+    const int h = std::min(clusterSize_, bits_.height() - y0);
+    if (cx > 0) add_border(cluster, x0, y0, 0, 1, h, -1, 0);
+    if (cx + 1 < clustersX_) add_border(cluster, x0 + w - 1, y0, 0, 1, h, 1, 0);
+    if (cy > 0) add_border(cluster, x0, y0, 1, 0, w, 0, -1);
+    if (cy + 1 < clustersY_) add_border(cluster, x0, y0 + h - 1, 1, 0, w, 0, 1);
+
+    CX_ASSERT(cluster.nodes.size() <= capacity_, "Entrance capacity exceeded");
+    for (size_t i = 0; i < cluster.nodes.size(); i++) {
+      localIndex_[cluster.nodes[i]] = (uint16_t)i;
+    }
+  }
+  // Resolves the links into abstract node ids - needs the entrances of the neighbors
+  void resolve_links(const int index) {
+    for (Link& link : clusters_[index].links) {
+      link.id = (uint32_t)cluster_of(link.cell) * capacity_ + localIndex_[link.cell];
+    }
+  }
+  // Costs between all entrances of a cluster
+  void connect_entrances(const int index) {
+    Cluster& cluster = clusters_[index];
+    const size_t n = cluster.nodes.size();
+    cluster.distances.assign(n * n, NO_CELL);
+    for (size_t i = 0; i < n; i++) {
+      search_cluster(index, cluster.nodes[i], NO_CELL, buildCtx_);
+      for (size_t j = 0; j < n; j++) {
+        if (buildCtx_.visited(cluster.nodes[j])) cluster.distances[i * n + j] = buildCtx_.g_cost[cluster.nodes[j]];
+      }
+    }
+  }
+  // Appends the cells after from up to target of the last search - walks the parents backwards
+  static void append_segment(const PathContext& ctx, const uint32_t from, const uint32_t target, const int width,
+                             std::vector<PointI>& path) {
+    const size_t begin = path.size();
+    for (uint32_t cell = target; cell != from; cell = ctx.parent[cell]) {
+      path.emplace_back((int)(cell % width), (int)(cell / width));
+    }
+    std::reverse(path.begin() + (std::ptrdiff_t)begin, path.end());
+  }
+
+ public:
+  /**
+   * Builds the abstract graph of the grid
+   * @param grid the initial obstacles - the grid keeps its own copy
+   * @param clusterSize side length of the clusters - larger clusters mean fewer nodes but slower refinement
+   * @param move movement model of the paths
+   */
+  template <typename S>
+  explicit HierarchicalGrid(const GridView<S>& grid, const int clusterSize = 16,
+                            const GridMove move = GridMove::CARDINAL)
+      : bits_(grid), localIndex_(grid.size(), NO_NODE), clusterSize_(clusterSize),
+        clustersX_((grid.width + clusterSize - 1) / clusterSize),
+        clustersY_((grid.height + clusterSize - 1) / clusterSize), capacity_(4 * ((clusterSize + 1) / 2)),
+        move_(move) {
+    CX_ASSERT(capacity_ < NO_NODE, "Cluster size too large");
+    clusters_.resize(clustersX_ * clustersY_);
+    dirtyCount_ = (int)clusters_.size();
+    update();
+  }
+  /**
+   * Changes a cell - only the clusters touching it are rebuilt (lazily)
+   */
+  void set_blocked(const int x, const int y, const bool blocked) {
+    if (bits_.walkable(x, y) != blocked) return;
+    bits_.set_blocked(x, y, blocked);
+    const int cx = x / clusterSize_;
+    const int cy = y / clusterSize_;
+    mark_dirty(cluster_of(x, y));
+    // Cells on a border change the entrances of the cluster on the other side
+    if (x % clusterSize_ == 0 && cx > 0) mark_dirty(cluster_of(x - 1, y));
+    if (x % clusterSize_ == clusterSize_ - 1 && cx + 1 < clustersX_) mark_dirty(cluster_of(x + 1, y));
+    if (y % clusterSize_ == 0 && cy > 0) mark_dirty(cluster_of(x, y - 1));
+    if (y % clusterSize_ == clusterSize_ - 1 && cy + 1 < clustersY_) mark_dirty(cluster_of(x, y + 1));
+  }
+  /**
+   * Rebuilds all dirty clusters - called automatically by find_path()
+   */
+  void update() {
+    if (dirtyCount_ == 0) return;
+    const int count = (int)clusters_.size();
+    for (int i = 0; i < count; i++) {
+      if (clusters_[i].dirty) place_entrances(i);
+    }
+    // Node ids of a dirty cluster changed - the links of its neighbors point into it
+    for (int i = 0; i < count; i++) {
+      const bool dirty = clusters_[i].dirty || (i % clustersX_ > 0 && clusters_[i - 1].dirty)
+                      || (i % clustersX_ + 1 < clustersX_ && clusters_[i + 1].dirty)
+                      || (i >= clustersX_ && clusters_[i - clustersX_].dirty)
+                      || (i + clustersX_ < count && clusters_[i + clustersX_].dirty);
+      if (dirty) resolve_links(i);
+    }
+    for (int i = 0; i < count; i++) {
+      if (clusters_[i].dirty) {
+        connect_entrances(i);
+        clusters_[i].dirty = false;
+      }
+    }
+    dirtyCount_ = 0;
+  }
+  [[nodiscard]] inline bool walkable(const int x, const int y) const noexcept { return bits_.walkable(x, y); }
+  [[nodiscard]] inline int dirty_count() const noexcept { return dirtyCount_; }
+  [[nodiscard]] inline int cluster_count() const noexcept { return (int)clusters_.size(); }
+  [[nodiscard]] inline size_t node_count() const noexcept {
+    size_t count = 0;
+    for (const auto& cluster : clusters_) {
+      count += cluster.nodes.size();
+    }
+    return count;
+  }
+  /**
+   * Finds a path from start to target
+   * @param ctx search state - can be reused across searches and grids
+   * @param path receives the path from start to target (both included) - cleared if no path exists
+   * @param weight scales the heuristic of the abstract search - values like 1.25 cut the expanded nodes by an order of
+   * magnitude on large maps for a few percent longer paths
+   * @return true if a path was found
+   */
+  bool find_path(const PointI& start, const PointI& target, PathContext& ctx, std::vector<PointI>& path,
+                 const float weight = 1.0F) {
+    path.clear();
+    if (!bits_.walkable(start.x, start.y) || !bits_.walkable(target.x, target.y)) return false;
+    update();
+
+    const int width = bits_.width();
+    const uint32_t startCell = bits_.index(start.x, start.y);
+    const uint32_t targetCell = bits_.index(target.x, target.y);
+    const int startCluster = cluster_of(start.x, start.y);
+    const int targetCluster = cluster_of(target.x, target.y);
+    const Cluster& startNodes = clusters_[startCluster];
+    const Cluster& targetNodes = clusters_[targetCluster];
+
+    // Temporary edges - target to its entrances, start to its entrances and (same cluster) start to target
+    ctx.costs.clear();
+    search_cluster(targetCluster, targetCell, NO_CELL, ctx);
+    for (const uint32_t cell : targetNodes.nodes) {
+      ctx.costs.push_back(ctx.visited(cell) ? ctx.g_cost[cell] : NO_CELL);
+    }
+    const uint32_t direct = startCluster == targetCluster && ctx.visited(startCell) ? ctx.g_cost[startCell] : NO_CELL;
+    search_cluster(startCluster, startCell, NO_CELL, ctx);
+    for (const uint32_t cell : startNodes.nodes) {
+      ctx.costs.push_back(ctx.visited(cell) ? ctx.g_cost[cell] : NO_CELL);
+    }
+    const uint32_t* targetCosts = ctx.costs.data();
+    const uint32_t* startCosts = ctx.costs.data() + targetNodes.nodes.size();
+
+    // Abstract search - the states are node ids plus two extra ones for start and target
+    const uint32_t startState = (uint32_t)clusters_.size() * capacity_;
+    const uint32_t targetState = startState + 1;
+    ctx.begin(startState + 2);
+    const auto push = [&](const uint32_t state, const uint32_t cell, const uint32_t g, const uint32_t from) {
+      if (!ctx.closed(state) && ctx.relax(state, g, from)) {
+        ctx.push({g + (uint32_t)((float)heuristic(cell, targetCell) * weight), g, state});
+      }
+    };
+    ctx.relax(startState, 0, startState);
+    ctx.push({heuristic(startCell, targetCell), 0, startState});
+    bool found = false;
+    while (!ctx.open.empty()) {
+      const GridNode current = ctx.open.top();
+      ctx.open.pop();
+      if (ctx.closed(current.cell) || current.g_cost != ctx.g_cost[current.cell]) continue;  // Stale duplicate
+      if (current.cell == targetState) {
+        found = true;
+        break;
+      }
+      ctx.close(current.cell);
+      ctx.expanded++;
+
+      if (current.cell == startState) {
+        const uint32_t base = startCluster * capacity_;
+        for (size_t i = 0; i < startNodes.nodes.size(); i++) {
+          if (startCosts[i] != NO_CELL) push(base + i, startNodes.nodes[i], startCosts[i], startState);
+        }
+        if (direct != NO_CELL) push(targetState, targetCell, direct, startState);
+        continue;
+      }
+      const uint32_t clusterIndex = current.cell / capacity_;
+      const uint32_t local = current.cell % capacity_;
+      const uint32_t base = clusterIndex * capacity_;
+      const Cluster& cluster = clusters_[clusterIndex];
+      const size_t n = cluster.nodes.size();
+      const uint32_t* row = cluster.distances.data() + local * n;
+      for (size_t i = 0; i < n; i++) {
+        if (row[i] != NO_CELL && i != local) push(base + i, cluster.nodes[i], current.g_cost + row[i], current.cell);
+      }
+      for (const Link& link : cluster.links) {
+        if (link.node == local) push(link.id, link.cell, current.g_cost + straight_cost(), current.cell);
+      }
+      if ((int)clusterIndex == targetCluster && targetCosts[local] != NO_CELL) {
+        push(targetState, targetCell, current.g_cost + targetCosts[local], current.cell);
+      }
+    }
+    if (!found) return false;
+
+    // Abstract path as cells
+    ctx.scratch.clear();
+    for (uint32_t state = targetState; state != startState; state = ctx.parent[state]) {
+      const uint32_t cell = state == targetState ? targetCell : clusters_[state / capacity_].nodes[state % capacity_];
+      ctx.scratch.emplace_back((int)(cell % width), (int)(cell / width));
+    }
+    ctx.scratch.push_back(start);
+    std::reverse(ctx.scratch.begin(), ctx.scratch.end());
+
+    // Refinement - every abstract edge stays inside one cluster or crosses a border in a single step
+    path.push_back(start);
+    for (size_t i = 1; i < ctx.scratch.size(); i++) {
+      const PointI& from = ctx.scratch[i - 1];
+      const PointI& to = ctx.scratch[i];
+      const int dx = std::abs(to.x - from.x);
+      const int dy = std::abs(to.y - from.y);
+      if (dx + dy == 0) continue;  // Start is an entrance itself
+      if (dx <= 1 && dy <= 1 && (move_ == GridMove::OCTILE || dx + dy == 1)) {
+        path.push_back(to);
+        continue;
+      }
+      const uint32_t fromCell = bits_.index(from.x, from.y);
+      const uint32_t toCell = bits_.index(to.x, to.y);
+      search_cluster(cluster_of(from.x, from.y), fromCell, toCell, ctx);
+      append_segment(ctx, fromCell, toCell, width, path);
+    }
+    return true;
+  }
+};
+
+/**
+ * <h2>FlowField</h2>
+ * Dijkstra map towards one or more targets - a single search serves any number of agents heading to the same place.<p>
+ * Every cell stores its cost to the nearest target and the direction of the next step, so agents just follow the
+ * field without searching. Uses the same costs as astar_grid().
+ */
+class FlowField {
+  static constexpr int DIRS[8][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+
+  std::vector<uint32_t> cost_;
+  std::vector<uint8_t> flow_;  // Index into DIRS of the next step - NO_FLOW on targets and unreachable cells
+  MonotoneQueue<uint32_t, GridNode> open_;
+  int width_ = 0;
+  int height_ = 0;
+
+ public:
+  static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+  static constexpr uint8_t NO_FLOW = UINT8_MAX;
+
+  FlowField() = default;
+  template <typename S>
+  FlowField(const GridView<S>& grid, const PointI& target, const GridMove move = GridMove::CARDINAL) {
+    build(grid, &target, 1, move);
+  }
+  /**
+   * Computes the field towards the nearest of the given targets - reuses the memory of the previous build
+   */
+  template <typename S>
+  void build(const GridView<S>& grid, const PointI* targets, const size_t count,
+             const GridMove move = GridMove::CARDINAL) {
+    const bool octile = move == GridMove::OCTILE;
+    width_ = grid.width;
+    height_ = grid.height;
+    cost_.assign(grid.size(), UNREACHABLE);
+    flow_.assign(grid.size(), NO_FLOW);
+    open_.reset();
+    for (size_t i = 0; i < count; i++) {
+      if (!grid.walkable(targets[i].x, targets[i].y)) continue;
+      const uint32_t cell = grid.index(targets[i].x, targets[i].y);
+      cost_[cell] = 0;
+      open_.push(0, {0, 0, cell});
+    }
+    while (!open_.empty()) {
+      const GridNode current = open_.top();
+      open_.pop();
+      if (current.g_cost != cost_[current.cell]) continue;  // Stale duplicate
+
+      const int x = (int)(current.cell % width_);
+      const int y = (int)(current.cell / width_);
+      for (int i = 0; i < (octile ? 8 : 4); i++) {
+        const int nx = x + DIRS[i][0];
+        const int ny = y + DIRS[i][1];
+        if (!grid.walkable(nx, ny)) continue;
+        const bool diagonal = i >= 4;
+        if (diagonal && (!grid.walkable(nx, y) || !grid.walkable(x, ny))) continue;  // No corner cutting
+        const uint32_t next = grid.index(nx, ny);
+        const uint32_t g = current.g_cost + (octile ? (diagonal ? GRID_DIAGONAL_COST : GRID_STRAIGHT_COST) : 1);
+        if (g < cost_[next]) {
+          cost_[next] = g;
+          flow_[next] = (uint8_t)(i ^ (diagonal ? 3 : 1));  // Opposite direction - back towards current
+          open_.push(g, {g, g, next});
+        }
+      }
+    }
+  }
+  template <typename S>
+  void build(const GridView<S>& grid, const PointI& target, const GridMove move = GridMove::CARDINAL) {
+    build(grid, &target, 1, move);
+  }
+  /**
+   * @return the cost from the cell to the nearest target or UNREACHABLE
+   */
+  [[nodiscard]] inline uint32_t cost(const int x, const int y) const noexcept {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) return UNREACHABLE;
+    return cost_[y * width_ + x];
+  }
+  [[nodiscard]] inline bool reachable(const int x, const int y) const noexcept { return cost(x, y) != UNREACHABLE; }
+  /**
+   * @return the next cell towards the nearest target - from itself if it is a target or unreachable
+   */
+  [[nodiscard]] inline PointI next_step(const PointI& from) const noexcept {
+    if (!reachable(from.x, from.y)) return from;
+    const uint8_t dir = flow_[from.y * width_ + from.x];
+    if (dir == NO_FLOW) return from;
+    return {from.x + DIRS[dir][0], from.y + DIRS[dir][1]};
+  }
+  /**
+   * Follows the field from a cell to the nearest target
+   * @param path receives the cells from start to the target (both included) - cleared if unreachable
+   * @return true if a target is reachable
+   */
+  bool follow(const PointI& start, std::vector<PointI>& path) const {
+    path.clear();
+    if (!reachable(start.x, start.y)) return false;
+    PointI current = start;
+    path.push_back(current);
+    while (flow_[current.y * width_ + current.x] != NO_FLOW) {
+      current = next_step(current);
+      path.push_back(current);
+    }
+    return true;
+  }
+  [[nodiscard]] inline int width() const noexcept { return width_; }
+  [[nodiscard]] inline int height() const noexcept { return height_; }
+};
+
+/**
+ * <h2>PathWorkers</h2>
+ * Batches of independent path queries on the shared {@link exec::pool}.<p>
+ * Every task owns a PathContext so searches stop allocating after the first batches. The calling thread works on
+ * the batch as well and for_each() returns once all items are done.
+ */
+class PathWorkers {
+  std::vector<PathContext> contexts_;  // One per task - index 0 belongs to the calling thread
+
+ public:
+  /**
+   * @param threads tasks working on a batch - including the calling thread
+   */
+  explicit PathWorkers(int threads = (int)exec::concurrency()) { contexts_.resize(std::max(threads, 1)); }
+  PathWorkers(const PathWorkers&) = delete;
+  PathWorkers& operator=(const PathWorkers&) = delete;
+  /**
+   * Calls func(PathContext&, index) for every index in [0, count) spread over all tasks - blocks until done
+   */
+  template <typename Func>
+  void for_each(const size_t count, Func&& func) {
+    std::atomic<size_t> next{0};
+    auto drain = [&](PathContext& ctx) {
+      for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+        func(ctx, i);
+      }
+    };
+    const size_t tasks = std::min(contexts_.size(), count);
+    exec::TaskGroup group;
+    for (size_t t = 1; t < tasks; t++) {
+      group.run([&drain, this, t] { drain(contexts_[t]); });
+    }
+    drain(contexts_[0]);
+    group.wait();
+  }
+  [[nodiscard]] inline int size() const noexcept { return (int)contexts_.size(); }
+};
+
+/**
+ * A single query of a batch - the result is written into path and found
+ */
+struct PathRequest {
+  PointI start;
+  PointI target;
+  std::vector<PointI> path;
+  bool found = false;
+};
+
+/**
+ * <h2>Batch A star</h2>
+ * Runs independent astar_grid() queries on all tasks of the workers - each task uses its own PathContext.<p>
+ * Prefer a FlowField if many agents share the same target.
+ *
+ * @param grid the search space - only read
+ * @param requests the queries - results are written into them
+ * @param count amount of requests
+ * @param workers the per task contexts
+ * @param move 4 or 8 directions
+ */
+template <typename S>
+void astar_batch(const GridView<S>& grid, PathRequest* requests, const size_t count, PathWorkers& workers,
+                 const GridMove move = GridMove::CARDINAL) {
+  workers.for_each(count, [&](PathContext& ctx, const size_t i) {
+    PathRequest& request = requests[i];
+    request.found = astar_grid(grid, request.start, request.target, ctx, request.path, move);
+  });
+}
+
 }  // namespace cxstructs
 #  ifdef CX_INCLUDE_TESTS
 namespace cxtests {  // namespace cxtests
@@ -141,6 +1310,202 @@ static void TEST_PATH_FINDING() {
   auto path = astar_pathfinding(maze, 1, start, target);
 
   CX_ASSERT(path[path.size() - 3] == Point(11, 6), "");
+
+  std::cout << "  Testing flat grid A*..." << std::endl;
+  std::vector<int> flat;
+  for (const auto& line : maze) {
+    flat.insert(flat.end(), line.begin(), line.end());
+  }
+  [[maybe_unused]] const GridView<int> grid{flat.data(), (int)maze[0].size(), (int)maze.size(), 1};
+  PathContext ctx;
+  std::vector<PointI> gridPath;
+  for (int i = 0; i < 3; i++) {  // Context reuse
+    CX_ASSERT(astar_grid(grid, {1, 1}, {11, 8}, ctx, gridPath), "");
+    CX_ASSERT(gridPath.size() == path.size(), "");
+    CX_ASSERT(gridPath.front() == PointI(1, 1) && gridPath.back() == PointI(11, 8), "");
+    CX_ASSERT(gridPath[gridPath.size() - 3] == PointI(11, 6), "");
+  }
+  CX_ASSERT(!astar_grid(grid, {1, 1}, {0, 0}, ctx, gridPath), "");
+  CX_ASSERT(gridPath.empty(), "");
+  CX_ASSERT(astar_grid(grid, {1, 1}, {1, 1}, ctx, gridPath) && gridPath.size() == 1, "");
+
+  std::cout << "  Testing octile A*, JPS and JPS+..." << std::endl;
+  const auto pathCost = [](const std::vector<PointI>& p, [[maybe_unused]] const BitGrid& bits) {
+    uint32_t cost = 0;
+    for (size_t i = 1; i < p.size(); i++) {
+      const int dx = p[i].x - p[i - 1].x;
+      const int dy = p[i].y - p[i - 1].y;
+      CX_ASSERT(std::abs(dx) <= 1 && std::abs(dy) <= 1 && (dx != 0 || dy != 0), "Path is not connected");
+      CX_ASSERT(bits.walkable(p[i].x, p[i].y), "Path goes through an obstacle");
+      CX_ASSERT(dx == 0 || dy == 0
+                    || (bits.walkable(p[i - 1].x + dx, p[i - 1].y) && bits.walkable(p[i - 1].x, p[i - 1].y + dy)),
+                "Path cuts a corner");
+      cost += dx != 0 && dy != 0 ? GRID_DIAGONAL_COST : GRID_STRAIGHT_COST;
+    }
+    return cost;
+  };
+  srand(42);
+  for (const int size : {13, 70, 130}) {
+    std::vector<int> cells(size * size);
+    for (auto& c : cells) {
+      c = rand() % 100 < 25 ? 1 : 0;
+    }
+    const GridView<int> randomGrid{cells.data(), size, size, 1};
+    const BitGrid bits{randomGrid};
+    const JPSPlusTable table{bits};
+    std::vector<PointI> jpsPath;
+    std::vector<PointI> plusPath;
+    for (int i = 0; i < 200; i++) {
+      const PointI s(rand() % size, rand() % size);
+      const PointI t(rand() % size, rand() % size);
+      const bool found = astar_grid(randomGrid, s, t, ctx, gridPath, GridMove::OCTILE);
+      CX_ASSERT(jps_grid(bits, s, t, ctx, jpsPath) == found, "JPS disagrees with A*");
+      CX_ASSERT(jps_plus_grid(bits, table, s, t, ctx, plusPath) == found, "JPS+ disagrees with A*");
+      if (!found) continue;
+      [[maybe_unused]] const uint32_t cost = pathCost(gridPath, bits);
+      CX_ASSERT(pathCost(jpsPath, bits) == cost, "JPS path not optimal");
+      CX_ASSERT(pathCost(plusPath, bits) == cost, "JPS+ path not optimal");
+      CX_ASSERT(jpsPath.front() == s && jpsPath.back() == t && plusPath.front() == s && plusPath.back() == t, "");
+    }
+  }
+
+  // Open map - JPS skips the straight runs
+  std::vector<int> open(256 * 256, 0);
+  const GridView<int> openGrid{open.data(), 256, 256, 1};
+  const BitGrid openBits{openGrid};
+  CX_ASSERT(astar_grid(openGrid, {0, 0}, {255, 200}, ctx, gridPath, GridMove::OCTILE), "");
+  [[maybe_unused]] const uint32_t astarExpanded = ctx.expanded;
+  CX_ASSERT(jps_grid(openBits, {0, 0}, {255, 200}, ctx, gridPath), "");
+  CX_ASSERT(ctx.expanded * 10 < astarExpanded, "JPS should expand far fewer nodes");
+
+  std::cout << "  Testing hierarchical pathfinding..." << std::endl;
+  for (const GridMove move : {GridMove::CARDINAL, GridMove::OCTILE}) {
+    const int size = 100;
+    std::vector<int> cells(size * size);
+    for (auto& c : cells) {
+      c = rand() % 100 < 20 ? 1 : 0;
+    }
+    const GridView<int> randomGrid{cells.data(), size, size, 1};
+    HierarchicalGrid hierarchy{randomGrid, 10, move};
+    CX_ASSERT(hierarchy.cluster_count() == 100 && hierarchy.dirty_count() == 0, "");
+    CX_ASSERT(hierarchy.node_count() > 0, "");
+
+    std::vector<PointI> hpaPath;
+    const auto check = [&](const PointI& s, const PointI& t) {
+      const bool found = astar_grid(randomGrid, s, t, ctx, gridPath, move);
+      CX_ASSERT(hierarchy.find_path(s, t, ctx, hpaPath) == found, "HPA* disagrees with A*");
+      if (!found) return;
+      CX_ASSERT(hpaPath.front() == s && hpaPath.back() == t && hpaPath.size() >= gridPath.size(), "");
+      for (size_t j = 1; j < hpaPath.size(); j++) {
+        [[maybe_unused]] const int dx = std::abs(hpaPath[j].x - hpaPath[j - 1].x);
+        [[maybe_unused]] const int dy = std::abs(hpaPath[j].y - hpaPath[j - 1].y);
+        CX_ASSERT(dx <= 1 && dy <= 1 && dx + dy > 0 && (move == GridMove::OCTILE || dx + dy == 1), "Invalid step");
+        CX_ASSERT(randomGrid.walkable(hpaPath[j].x, hpaPath[j].y), "Path goes through an obstacle");
+      }
+    };
+    for (int i = 0; i < 100; i++) {
+      check({rand() % size, rand() % size}, {rand() % size, rand() % size});
+    }
+    if (astar_grid(randomGrid, {0, 0}, {99, 99}, ctx, gridPath, move)) {
+      CX_ASSERT(hierarchy.find_path({0, 0}, {99, 99}, ctx, hpaPath, 1.5F) && hpaPath.back() == PointI(99, 99), "");
+    }
+
+    // Editing a cell only touches its own cluster - or both clusters of a border
+    cells[55 * size + 55] = 1;
+    hierarchy.set_blocked(55, 55, true);
+    CX_ASSERT(hierarchy.dirty_count() == 1, "");
+    cells[55 * size + 59] = 1;
+    hierarchy.set_blocked(59, 55, true);
+    CX_ASSERT(hierarchy.dirty_count() == 2, "");
+    hierarchy.update();
+    CX_ASSERT(hierarchy.dirty_count() == 0, "");
+
+    // Wall off the left half and reopen it
+    for (int y = 0; y < size; y++) {
+      cells[y * size + 50] = 1;
+      hierarchy.set_blocked(50, y, true);
+    }
+    for (int i = 0; i < 50; i++) {
+      check({rand() % 50, rand() % size}, {51 + rand() % 49, rand() % size});
+    }
+    for (int y = 0; y < size; y += 3) {
+      cells[y * size + 50] = 0;
+      hierarchy.set_blocked(50, y, false);
+    }
+    for (int i = 0; i < 50; i++) {
+      check({rand() % size, rand() % size}, {rand() % size, rand() % size});
+    }
+  }
+
+  std::cout << "  Testing flow fields..." << std::endl;
+  for (const GridMove move : {GridMove::CARDINAL, GridMove::OCTILE}) {
+    const int size = 60;
+    std::vector<int> cells(size * size);
+    for (auto& c : cells) {
+      c = rand() % 100 < 25 ? 1 : 0;
+    }
+    const GridView<int> randomGrid{cells.data(), size, size, 1};
+    const PointI target(30, 30);
+    cells[target.y * size + target.x] = 0;
+    const FlowField field{randomGrid, target, move};
+    std::vector<PointI> flowPath;
+    const auto stepCost = [&](const PointI& a, const PointI& b) {
+      if (move == GridMove::CARDINAL) return 1U;
+      return a.x != b.x && a.y != b.y ? GRID_DIAGONAL_COST : GRID_STRAIGHT_COST;
+    };
+    for (int i = 0; i < 100; i++) {
+      const PointI s(rand() % size, rand() % size);
+      const bool found = astar_grid(randomGrid, s, target, ctx, gridPath, move);
+      CX_ASSERT(field.follow(s, flowPath) == found, "Flow field disagrees with A*");
+      if (!found) continue;
+      uint32_t astarCost = 0;
+      uint32_t flowCost = 0;
+      for (size_t j = 1; j < gridPath.size(); j++) {
+        astarCost += stepCost(gridPath[j - 1], gridPath[j]);
+      }
+      for (size_t j = 1; j < flowPath.size(); j++) {
+        flowCost += stepCost(flowPath[j - 1], flowPath[j]);
+        CX_ASSERT(randomGrid.walkable(flowPath[j].x, flowPath[j].y), "");
+      }
+      CX_ASSERT(flowCost == astarCost && field.cost(s.x, s.y) == astarCost, "Flow field not optimal");
+      CX_ASSERT(flowPath.back() == target, "");
+    }
+  }
+  // Several targets - every cell flows to the nearest one
+  std::vector<int> empty(20 * 20, 0);
+  const GridView<int> emptyGrid{empty.data(), 20, 20, 1};
+  const PointI targets[2] = {{0, 0}, {19, 19}};
+  FlowField multi;
+  multi.build(emptyGrid, targets, 2);
+  CX_ASSERT(multi.cost(0, 0) == 0 && multi.cost(19, 19) == 0 && multi.cost(2, 3) == 5 && multi.cost(18, 15) == 5, "");
+  CX_ASSERT(multi.next_step({0, 0}) == PointI(0, 0), "");
+
+  std::cout << "  Testing batch pathfinding..." << std::endl;
+  {
+    const int size = 80;
+    std::vector<int> cells(size * size);
+    for (auto& c : cells) {
+      c = rand() % 100 < 20 ? 1 : 0;
+    }
+    const GridView<int> randomGrid{cells.data(), size, size, 1};
+    std::vector<PathRequest> requests(200);
+    for (auto& r : requests) {
+      r.start = {rand() % size, rand() % size};
+      r.target = {rand() % size, rand() % size};
+    }
+    PathWorkers workers{4};
+    CX_ASSERT(workers.size() == 4, "");
+    for (int round = 0; round < 3; round++) {
+      astar_batch(randomGrid, requests.data(), requests.size(), workers);
+      for (auto& r : requests) {
+        [[maybe_unused]] const bool found = astar_grid(randomGrid, r.start, r.target, ctx, gridPath);
+        CX_ASSERT(r.found == found && r.path.size() == gridPath.size(), "Batch result differs");
+      }
+    }
+    PathWorkers single{1};
+    astar_batch(randomGrid, requests.data(), requests.size(), single);
+    CX_ASSERT(requests[0].found == astar_grid(randomGrid, requests[0].start, requests[0].target, ctx, gridPath), "");
+  }
 }
 }  // namespace cxtests
 #  endif
@@ -28,78 +28,1203 @@ In turn, generally do not use it if it's a temporary or fixed size structure
 In case of slower performance just switch to the other.
  */
 
-#  include <deque>
+#  include <algorithm>
+#  include <atomic>
+#  include <cstddef>
+#  include <cstdlib>
+#  include <cstring>
+#  include <iostream>
+#  include <mutex>
+#  include <new>
+#  include <string>
+#  include <typeinfo>
 #  include <vector>
 #  include "cxconfig.h"
+#  ifdef _WIN32
+#    ifndef WIN32_LEAN_AND_MEAN
+#      define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#      define NOMINMAX
+#    endif
+#    include <windows.h>
+#  else
+#    include <sys/mman.h>
+#  endif
+#  if defined(__GLIBC__) || defined(__APPLE__)
+#    include <execinfo.h>
+#    define CX_HAS_BACKTRACE
+#  endif
+#  ifdef __GNUG__
+#    include <cxxabi.h>
+#  endif
+#  ifdef CX_INCLUDE_TESTS
+#    include <list>
+#    include <thread>
+#  endif
 
-namespace cxstructs {
-template <uint_32_cx BlockSize, uint_16_cx ReservedBlocks>
-class Pool {
-  uint_32_cx size_;
-  std::deque<void*> addrs_;
-  std::vector<uint8_t*> blocks_;
+// Allocations of at least this many bytes are backed by huge pages - smaller ones go to malloc
+#  ifndef CX_HUGE_PAGE_THRESHOLD
+#    define CX_HUGE_PAGE_THRESHOLD (2U * 1024U * 1024U)
+#  endif
+
+namespace cxhelper {
+// Slab heap behind CXPoolAllocator
+// Every size class has its own free lists. Free slots are linked through their first word (intrusive)
+// Each thread serves allocations from its own cache and exchanges whole batches with a global depot
+namespace slab {
+constexpr size_t MAX_SIZE = 4096;  // larger requests go to operator new
+constexpr size_t ALIGN = 16;
+constexpr size_t CLASS_COUNT = 28;
+constexpr uint32_t BATCH = 64;            // slots moved between a thread cache and the depot at once
+constexpr size_t SPAN_SIZE = 64 * 1024;   // fresh memory a thread cache takes per refill
+constexpr size_t CHUNK_SIZE = 1024 * 1024;  // memory the depot requests from the system at once
+
+// 16 byte steps up to 128, then 4 classes per power of two up to 4096
+constexpr size_t size_class(size_t bytes) {
+  if (bytes <= 128) return bytes == 0 ? 0 : (bytes - 1) / 16;
+  size_t power = 7;
+  while (((size_t)1 << (power + 1)) < bytes) power++;
+  return 8 + (power - 7) * 4 + ((bytes - 1 - ((size_t)1 << power)) >> (power - 2));
+}
+constexpr size_t class_size(size_t sizeClass) {
+  if (sizeClass < 8) return (sizeClass + 1) * 16;
+  const size_t power = 7 + (sizeClass - 8) / 4;
+  return ((size_t)1 << power) + ((sizeClass - 8) % 4 + 1) * ((size_t)1 << (power - 2));
+}
+static_assert(size_class(MAX_SIZE) == CLASS_COUNT - 1 && class_size(CLASS_COUNT - 1) == MAX_SIZE);
+static_assert(size_class(129) == 8 && class_size(8) == 160 && size_class(160) == 8 && size_class(161) == 9);
+
+struct FreeSlot {
+  FreeSlot* next;
+};
+struct Batch {
+  FreeSlot* head;
+  uint32_t count;
+};
+
+// Process wide - owns all memory and is never destroyed, so containers with static storage stay valid until exit
+class Depot {
+  struct SizeClass {
+    std::mutex lock;
+    std::vector<Batch> batches;
+  };
+  SizeClass classes_[CLASS_COUNT];
+  std::mutex chunkLock_;
+  std::vector<void*> chunks_;  // keeps the memory reachable
+  char* chunkPos_ = nullptr;
+  char* chunkEnd_ = nullptr;
 
-  void allocateBlock() {
-    auto* block = new uint8_t[BlockSize];
-    for (uint_32_cx i = 0; i < BlockSize; i += size_) {
-      addrs_.push_back(&block[i]);
+ public:
+  bool pop_batch(size_t sizeClass, Batch& batch) {
+    auto& sc = classes_[sizeClass];
+    std::lock_guard<std::mutex> guard(sc.lock);
+    if (sc.batches.empty()) return false;
+    batch = sc.batches.back();
+    sc.batches.pop_back();
+    return true;
+  }
+  void push_batch(size_t sizeClass, Batch batch) {
+    auto& sc = classes_[sizeClass];
+    std::lock_guard<std::mutex> guard(sc.lock);
+    sc.batches.push_back(batch);
+  }
+  // Hands out raw memory - slots are carved from it lazily by the thread caches
+  char* take_span(size_t bytes) {
+    std::lock_guard<std::mutex> guard(chunkLock_);
+    if (static_cast<size_t>(chunkEnd_ - chunkPos_) < bytes) {
+      auto* chunk = static_cast<char*>(::operator new(CHUNK_SIZE, std::align_val_t(ALIGN)));
+      chunks_.push_back(chunk);
+      chunkPos_ = chunk;
+      chunkEnd_ = chunk + CHUNK_SIZE;
     }
-    blocks_.push_back(block);
+    char* span = chunkPos_;
+    chunkPos_ += bytes;
+    return span;
   }
+};
+inline Depot& depot() {
+  static Depot& instance = *new Depot();
+  return instance;
+}
 
- public:
-  explicit Pool(uint_32_cx size) : size_(size) {
-    blocks_.reserve(ReservedBlocks * 2);
-    for (uint_16_cx i = 0; i < ReservedBlocks; i++) {
-      allocateBlock();
+class ThreadCache {
+  struct SizeClass {
+    FreeSlot* head = nullptr;
+    uint32_t count = 0;
+    char* carvePos = nullptr;  // untouched memory of the current span
+    char* carveEnd = nullptr;
+  };
+  SizeClass classes_[CLASS_COUNT];
+
+  void* refill(size_t sizeClass) {
+    auto& sc = classes_[sizeClass];
+    const size_t slotSize = class_size(sizeClass);
+    Batch batch{};
+    if (depot().pop_batch(sizeClass, batch)) {
+      sc.head = batch.head->next;
+      sc.count = batch.count - 1;
+      return batch.head;
     }
+    const size_t spanSize = std::max(SPAN_SIZE / slotSize, (size_t)BATCH) * slotSize;
+    char* span = depot().take_span(spanSize);
+    sc.carvePos = span + slotSize;
+    sc.carveEnd = span + spanSize;
+    return span;
   }
-  ~Pool() {
-    for (auto block : blocks_) {
-      delete[] block;
+  void flush(size_t sizeClass, uint32_t keep) {
+    auto& sc = classes_[sizeClass];
+    while (sc.count > keep) {
+      const uint32_t count = std::min(BATCH, sc.count - keep);
+      FreeSlot* head = sc.head;
+      FreeSlot* tail = head;
+      for (uint32_t i = 1; i < count; i++) tail = tail->next;
+      sc.head = tail->next;
+      tail->next = nullptr;
+      sc.count -= count;
+      depot().push_batch(sizeClass, {head, count});
     }
   }
 
-  auto allocate() -> void* {
-    if (addrs_.empty()) {
-      allocateBlock();
+ public:
+  ThreadCache() = default;
+  ThreadCache(const ThreadCache&) = delete;
+  ThreadCache& operator=(const ThreadCache&) = delete;
+  ~ThreadCache() {
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+      auto& sc = classes_[i];
+      const size_t slotSize = class_size(i);
+      for (; sc.carvePos < sc.carveEnd; sc.carvePos += slotSize) {
+        auto* slot = reinterpret_cast<FreeSlot*>(sc.carvePos);
+        slot->next = sc.head;
+        sc.head = slot;
+        sc.count++;
+      }
+      flush(i, 0);
+    }
+  }
+  inline void* allocate(size_t sizeClass) noexcept {
+    auto& sc = classes_[sizeClass];
+    if (sc.head != nullptr) [[likely]] {
+      FreeSlot* slot = sc.head;
+      sc.head = slot->next;
+      sc.count--;
+      return slot;
+    }
+    if (sc.carvePos != sc.carveEnd) {
+      void* slot = sc.carvePos;
+      sc.carvePos += class_size(sizeClass);
+      return slot;
+    }
+    return refill(sizeClass);
+  }
+  inline void deallocate(void* ptr, size_t sizeClass) noexcept {
+    auto& sc = classes_[sizeClass];
+    auto* slot = static_cast<FreeSlot*>(ptr);
+    slot->next = sc.head;
+    sc.head = slot;
+    if (++sc.count > 2 * BATCH) [[unlikely]] {
+      flush(sizeClass, BATCH);
     }
-    auto ptr = addrs_.back();
-    addrs_.pop_back();
-    return ptr;
   }
-  void deallocate(void* ptr) { addrs_.push_back(ptr); }
 };
+inline ThreadCache& thread_cache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+}  // namespace slab
+}  // namespace cxhelper
 
-template <typename T, size_t BlockSize, uint_16_cx ReservedBlocks>
+namespace cxstructs {
+/**
+ * <h2>CXPoolAllocator</h2>
+ * Slab allocator for node based containers (LinkedList, Trie, Stack, ...).<p>
+ * Requests up to 4KB are rounded to one of 28 size classes and served from an intrusive free list in a
+ * thread local cache - an allocation or free is a pointer pop/push. Caches carve fresh slots lazily from 64KB spans
+ * and exchange batches of 64 free slots with a global depot, so memory freed on another thread is reused.
+ * Larger requests go to operator new.<p>
+ * All instances share the process wide slab heap: copies, moves and swaps are always valid and memory allocated by
+ * one instance can be freed by any other. The memory is kept for reuse and only released at process exit.
+ * @tparam T value type
+ */
+template <typename T>
 class CXPoolAllocator {
-  using PoolType = Pool<BlockSize, ReservedBlocks>;
-  PoolType pool_;
+  static constexpr bool USE_SLAB = alignof(T) <= cxhelper::slab::ALIGN;
 
  public:
   using value_type = T;
-  using is_always_equal = std::false_type;
-  CXPoolAllocator() : pool_(PoolType(sizeof(T))) {}
-  CXPoolAllocator(const CXPoolAllocator& other) = default;
-  CXPoolAllocator(CXPoolAllocator&& other) noexcept = default;
-  CXPoolAllocator& operator=(const CXPoolAllocator& other) = default;
-  CXPoolAllocator& operator=(CXPoolAllocator&& other) noexcept = default;
-  ~CXPoolAllocator() = default;
-  T* allocate(size_t n) {
-    if (n > 1) {
-      return static_cast<T*>(malloc(sizeof(T) * n));
+  using is_always_equal = std::true_type;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  CXPoolAllocator() noexcept = default;
+  template <typename U>
+  CXPoolAllocator(const CXPoolAllocator<U>& /**/) noexcept {}  // NOLINT(*-explicit-constructor)
+
+  inline T* allocate(size_t n) {
+    const size_t bytes = n * sizeof(T);
+    if (USE_SLAB && bytes <= cxhelper::slab::MAX_SIZE) [[likely]] {
+      return static_cast<T*>(cxhelper::slab::thread_cache().allocate(cxhelper::slab::size_class(bytes)));
+    }
+    return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+  }
+  inline void deallocate(T* ptr, size_t n) noexcept {
+    const size_t bytes = n * sizeof(T);
+    if (USE_SLAB && bytes <= cxhelper::slab::MAX_SIZE) [[likely]] {
+      if (ptr == nullptr) return;  // like free() - moved-from containers may hand back their null array
+      cxhelper::slab::thread_cache().deallocate(ptr, cxhelper::slab::size_class(bytes));
     } else {
-      return (T*)pool_.allocate();
+      ::operator delete(ptr, std::align_val_t(alignof(T)));
+    }
+  }
+  template <typename U>
+  bool operator==(const CXPoolAllocator<U>& /**/) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const CXPoolAllocator<U>& /**/) const noexcept {
+    return false;
+  }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "TESTING CX POOL ALLOCATOR\n";
+
+    std::cout << "   Testing size classes...\n";
+    for (size_t bytes = 1; bytes <= cxhelper::slab::MAX_SIZE; bytes++) {
+      [[maybe_unused]] const size_t sizeClass = cxhelper::slab::size_class(bytes);
+      CX_ASSERT(cxhelper::slab::class_size(sizeClass) >= bytes, "");
+      CX_ASSERT(cxhelper::slab::class_size(sizeClass) % cxhelper::slab::ALIGN == 0, "");
+      CX_ASSERT(sizeClass == 0 || cxhelper::slab::class_size(sizeClass - 1) < bytes, "");
+    }
+
+    std::cout << "   Testing allocation and reuse...\n";
+    CXPoolAllocator<T> alloc;
+    std::vector<T*> ptrs;
+    for (int i = 0; i < 10000; i++) {
+      T* ptr = alloc.allocate(1);
+      CX_ASSERT(reinterpret_cast<uintptr_t>(ptr) % alignof(T) == 0, "");
+      ::new (ptr) T(i);
+      ptrs.push_back(ptr);
+    }
+    for (int i = 0; i < 10000; i++) {
+      CX_ASSERT(*ptrs[i] == T(i), "overlapping slots");
+    }
+    for (auto* ptr : ptrs) {
+      alloc.deallocate(ptr, 1);
+    }
+    T* reused = alloc.allocate(1);
+    CX_ASSERT(reused == ptrs.back(), "freed slot should be reused first");
+    alloc.deallocate(reused, 1);
+
+    std::cout << "   Testing arrays and large requests...\n";
+    T* small = alloc.allocate(3);
+    T* large = alloc.allocate(cxhelper::slab::MAX_SIZE / sizeof(T) + 1);
+    for (int i = 0; i < 3; i++) small[i] = T(i);
+    alloc.deallocate(small, 3);
+    alloc.deallocate(large, cxhelper::slab::MAX_SIZE / sizeof(T) + 1);
+
+    std::cout << "   Testing copies and rebinding...\n";
+    CXPoolAllocator<T> copy = alloc;
+    T* ptr = copy.allocate(1);
+    alloc.deallocate(ptr, 1);
+    CXPoolAllocator<double> rebound(alloc);
+    CX_ASSERT(rebound == alloc, "");
+    static_assert(std::allocator_traits<CXPoolAllocator<T>>::is_always_equal::value);
+
+    std::cout << "   Testing cross thread deallocation...\n";
+    ptrs.clear();
+    for (int i = 0; i < 1000; i++) {
+      ptrs.push_back(alloc.allocate(1));
+    }
+    std::thread other([&]() {
+      CXPoolAllocator<T> otherAlloc;
+      for (auto* p : ptrs) {
+        otherAlloc.deallocate(p, 1);
+      }
+      for (int i = 0; i < 1000; i++) {
+        otherAlloc.deallocate(otherAlloc.allocate(1), 1);
+      }
+    });
+    other.join();
+    for (int i = 0; i < 5000; i++) {
+      ptrs.push_back(alloc.allocate(1));
+    }
+    for (size_t i = 1000; i < ptrs.size(); i++) {
+      alloc.deallocate(ptrs[i], 1);
     }
   }
-  void deallocate(T* ptr, size_t n) {
-    if (n > 1) {
-      free(ptr);
+#  endif
+};
+
+/**
+ * Page source for {@link HugePageAllocator}
+ */
+enum class HugePages : uint8_t {
+  TRANSPARENT,   // 2MB aligned anonymous mapping + MADV_HUGEPAGE - kernel promotes it with transparent huge pages
+  EXPLICIT_2MB,  // reserved 2MB hugetlb pages (vm.nr_hugepages), falls back to TRANSPARENT
+  EXPLICIT_1GB,  // reserved 1GB hugetlb pages, falls back to TRANSPARENT
+};
+
+/**
+ * Process wide counters of all {@link HugePageAllocator} instances
+ */
+struct HugePageStats {
+  size_t hugeAllocations;      // allocations served by a mapping
+  size_t explicitAllocations;  // of those, backed by reserved hugetlb / large pages
+  size_t fallbackAllocations;  // explicit pages were requested but not available
+  size_t smallAllocations;     // below CX_HUGE_PAGE_THRESHOLD - served by malloc
+  size_t mappedBytes;          // currently mapped
+  size_t peakMappedBytes;
+};
+}  // namespace cxstructs
+
+namespace cxhelper {
+struct HugePageCounters {
+  std::atomic<size_t> hugeAllocations{0};
+  std::atomic<size_t> explicitAllocations{0};
+  std::atomic<size_t> fallbackAllocations{0};
+  std::atomic<size_t> smallAllocations{0};
+  std::atomic<size_t> mappedBytes{0};
+  std::atomic<size_t> peakMappedBytes{0};
+};
+inline HugePageCounters& huge_page_counters() {
+  static HugePageCounters counters;
+  return counters;
+}
+constexpr size_t huge_page_size(cxstructs::HugePages mode) {
+  return mode == cxstructs::HugePages::EXPLICIT_1GB ? (size_t)1 << 30 : (size_t)1 << 21;
+}
+// Length of the mapping for a request - identical for allocation and deallocation
+constexpr size_t huge_page_length(size_t bytes, cxstructs::HugePages mode) {
+  const size_t page = huge_page_size(mode);
+  return (bytes + page - 1) & ~(page - 1);
+}
+inline void* huge_page_map(size_t length, cxstructs::HugePages mode) {
+  auto& counters = huge_page_counters();
+  void* ptr = nullptr;
+#  ifdef _WIN32
+  if (mode != cxstructs::HugePages::TRANSPARENT) {
+    // Needs SeLockMemoryPrivilege - there are no transparent huge pages on Windows
+    const size_t minimum = GetLargePageMinimum();
+    if (minimum != 0 && length % minimum == 0) {
+      ptr = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+    if (ptr != nullptr) {
+      counters.explicitAllocations.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      counters.fallbackAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (ptr == nullptr) {
+    ptr = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  }
+#  else
+#    ifdef MAP_HUGETLB
+  if (mode != cxstructs::HugePages::TRANSPARENT) {
+    constexpr int HUGE_SHIFT = 26;  // MAP_HUGE_SHIFT - not defined by older headers
+    const int sizeFlag = (mode == cxstructs::HugePages::EXPLICIT_1GB ? 30 : 21) << HUGE_SHIFT;
+    ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sizeFlag, -1, 0);
+    if (ptr == MAP_FAILED) {
+      ptr = nullptr;
+      counters.fallbackAllocations.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      counters.explicitAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+#    endif
+  if (ptr == nullptr) {
+    // Over-map and trim so the range starts on a 2MB boundary - otherwise the kernel can't use huge pages for it
+    constexpr size_t ALIGN = (size_t)1 << 21;
+    void* raw = mmap(nullptr, length + ALIGN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+    const auto begin = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = (begin + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1);
+    if (aligned != begin) munmap(raw, aligned - begin);
+    if (aligned + length != begin + length + ALIGN) {
+      munmap(reinterpret_cast<void*>(aligned + length), begin + ALIGN - aligned);
+    }
+    ptr = reinterpret_cast<void*>(aligned);
+#    ifdef MADV_HUGEPAGE
+    madvise(ptr, length, MADV_HUGEPAGE);
+#    endif
+  }
+#  endif
+  if (ptr == nullptr) return nullptr;
+  counters.hugeAllocations.fetch_add(1, std::memory_order_relaxed);
+  const size_t mapped = counters.mappedBytes.fetch_add(length, std::memory_order_relaxed) + length;
+  size_t peak = counters.peakMappedBytes.load(std::memory_order_relaxed);
+  while (peak < mapped && !counters.peakMappedBytes.compare_exchange_weak(peak, mapped, std::memory_order_relaxed)) {}
+  return ptr;
+}
+inline void huge_page_unmap(void* ptr, size_t length) {
+  if (ptr == nullptr) {
+    return;
+  }
+#  ifdef _WIN32
+  VirtualFree(ptr, 0, MEM_RELEASE);
+#  else
+  munmap(ptr, length);
+#  endif
+  huge_page_counters().mappedBytes.fetch_sub(length, std::memory_order_relaxed);
+}
+}  // namespace cxhelper
+
+namespace cxstructs {
+/**
+ * <h2>HugePageAllocator</h2>
+ * Allocator for multi-GB buffers (embedding tables, training matrices) where TLB misses dominate random access.
+ * With 4KB pages a 4GB buffer needs a million TLB entries - with 2MB pages only 2048.<p>
+ * Allocations of at least {@code CX_HUGE_PAGE_THRESHOLD} bytes are mapped directly and backed by huge pages,
+ * smaller ones are passed to malloc. Explicit huge pages need to be reserved by the system
+ * ({@code vm.nr_hugepages} / SeLockMemoryPrivilege) - if they are not available the allocation silently falls back
+ * to transparent huge pages, which in turn fall back to normal pages if THP is disabled.<p>
+ * Stateless - all instances compare equal. Usable as the Allocator of vec, Queue, DeQueue, PriorityQueue etc.
+ * {@code vec<float, HugePageAllocator<float>> table(1U << 30, 0.0F);}
+ * @tparam T value type
+ * @tparam Mode page source for large allocations
+ */
+template <typename T, HugePages Mode = HugePages::TRANSPARENT>
+class HugePageAllocator {
+ public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+  template <typename U>
+  struct rebind {
+    using other = HugePageAllocator<U, Mode>;
+  };
+
+  HugePageAllocator() noexcept = default;
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U, Mode>& /**/) noexcept {}  // NOLINT(*-explicit-constructor)
+
+  T* allocate(size_t n) {
+    const size_t bytes = n * sizeof(T);
+    if (bytes < CX_HUGE_PAGE_THRESHOLD) {
+      cxhelper::huge_page_counters().smallAllocations.fetch_add(1, std::memory_order_relaxed);
+      void* ptr = std::malloc(bytes);
+      if (ptr == nullptr && bytes > 0) throw std::bad_alloc();
+      return static_cast<T*>(ptr);
+    }
+    void* ptr = cxhelper::huge_page_map(cxhelper::huge_page_length(bytes, Mode), Mode);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return static_cast<T*>(ptr);
+  }
+  void deallocate(T* ptr, size_t n) noexcept {
+    if (ptr == nullptr) {
       return;
+    }
+    const size_t bytes = n * sizeof(T);
+    if (bytes < CX_HUGE_PAGE_THRESHOLD) {
+      std::free(ptr);
+    } else {
+      cxhelper::huge_page_unmap(ptr, cxhelper::huge_page_length(bytes, Mode));
+    }
+  }
+  /**
+   * @return a snapshot of the process wide counters of all huge page allocators
+   */
+  [[nodiscard]] static HugePageStats stats() noexcept {
+    const auto& counters = cxhelper::huge_page_counters();
+    return {counters.hugeAllocations.load(std::memory_order_relaxed),
+            counters.explicitAllocations.load(std::memory_order_relaxed),
+            counters.fallbackAllocations.load(std::memory_order_relaxed),
+            counters.smallAllocations.load(std::memory_order_relaxed),
+            counters.mappedBytes.load(std::memory_order_relaxed),
+            counters.peakMappedBytes.load(std::memory_order_relaxed)};
+  }
+  template <typename U>
+  bool operator==(const HugePageAllocator<U, Mode>& /**/) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U, Mode>& /**/) const noexcept {
+    return false;
+  }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "TESTING HUGE PAGE ALLOCATOR\n";
+
+    std::cout << "   Testing small allocations...\n";
+    HugePageAllocator<T, Mode> alloc;
+    [[maybe_unused]] auto before = stats();
+    T* small = alloc.allocate(16);
+    CX_ASSERT(small != nullptr, "");
+    CX_ASSERT(stats().smallAllocations == before.smallAllocations + 1, "");
+    CX_ASSERT(stats().mappedBytes == before.mappedBytes, "");
+    alloc.deallocate(small, 16);
+
+    std::cout << "   Testing large allocations...\n";
+    const size_t count = (3 * CX_HUGE_PAGE_THRESHOLD) / sizeof(T) + 7;
+    T* large = alloc.allocate(count);
+    CX_ASSERT(large != nullptr, "");
+#    ifndef _WIN32
+    CX_ASSERT(reinterpret_cast<uintptr_t>(large) % cxhelper::huge_page_size(HugePages::TRANSPARENT) == 0, "");
+#    endif
+    [[maybe_unused]] auto during = stats();
+    CX_ASSERT(during.hugeAllocations == before.hugeAllocations + 1, "");
+    CX_ASSERT(during.explicitAllocations + during.fallbackAllocations
+                  == before.explicitAllocations + before.fallbackAllocations + (Mode != HugePages::TRANSPARENT),
+              "");
+    CX_ASSERT(during.mappedBytes >= before.mappedBytes + count * sizeof(T), "");
+    CX_ASSERT(during.peakMappedBytes >= during.mappedBytes, "");
+    for (size_t i = 0; i < count; i++) {
+      large[i] = T(i);
+    }
+    for (size_t i = 0; i < count; i += 4099) {
+      CX_ASSERT(large[i] == T(i), "");
+    }
+    alloc.deallocate(large, count);
+    CX_ASSERT(stats().mappedBytes == before.mappedBytes, "");
+
+    std::cout << "   Testing rebinding...\n";
+    using Rebound = typename std::allocator_traits<HugePageAllocator<T, Mode>>::template rebind_alloc<double>;
+    static_assert(std::is_same_v<Rebound, HugePageAllocator<double, Mode>>);
+    CX_ASSERT(Rebound(alloc) == alloc, "");
+  }
+#  endif
+};
+/**
+ * Where a {@link MonotonicArena} gets its chunks from - defaults to operator new / delete
+ */
+struct ArenaUpstream {
+  void* (*allocate)(size_t bytes) = [](size_t bytes) { return ::operator new(bytes); };
+  void (*deallocate)(void* ptr, size_t bytes) = [](void* ptr, size_t /**/) { ::operator delete(ptr); };
+};
+
+/**
+ * <h2>MonotonicArena</h2>
+ * Bump allocator for short-lived structures (per-request or per-frame temporaries).<p>
+ * Allocation is a pointer bump, freeing single objects does nothing. Everything is released at once in O(1) by
+ * {@link reset()} or by leaving a {@link Scope}. Memory comes from an optional initial buffer (e.g. on the stack)
+ * and then from upstream chunks that start at {@code chunkSize} and double in size. Chunks are kept and reused
+ * after a reset - call {@link release()} to return them upstream.<p>
+ * Not thread safe - use one arena per thread.
+ * <h2>Usage</h2>
+ * {@code
+ * char buffer[16 * 1024];
+ * MonotonicArena arena(buffer, sizeof(buffer));
+ * for (auto& request : requests) {
+ *   MonotonicArena::Scope scope(arena);  // everything allocated in here is dropped at the end of the iteration
+ *   vec<int, ArenaAllocator<int>> temp;
+ * }}
+ */
+class MonotonicArena {
+  struct Chunk {
+    Chunk* next;
+    size_t size;  // including this header
+  };
+  static constexpr size_t HEADER = (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  static constexpr size_t MAX_CHUNK_SIZE = (size_t)64 << 20;
+
+  char* pos_;
+  char* end_;
+  Chunk* current_ = nullptr;  // nullptr while in the initial buffer
+  Chunk* head_ = nullptr;
+  Chunk* tail_ = nullptr;
+  char* buffer_;
+  size_t bufferSize_;
+  size_t nextChunkSize_;
+  ArenaUpstream upstream_;
+
+  static inline thread_local MonotonicArena* active_ = nullptr;
+
+  static inline char* align_up(char* ptr, size_t alignment) noexcept {
+    return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+  }
+  static inline bool fits(const char* ptr, const char* end, size_t bytes) noexcept {
+    return ptr <= end && bytes <= static_cast<size_t>(end - ptr);
+  }
+  inline void enter(Chunk* chunk) noexcept {
+    current_ = chunk;
+    pos_ = reinterpret_cast<char*>(chunk) + HEADER;
+    end_ = reinterpret_cast<char*>(chunk) + chunk->size;
+  }
+  void* allocate_slow(size_t bytes, size_t alignment) {
+    // Reuse chunks kept from before a reset or rewind
+    for (Chunk* next = current_ == nullptr ? head_ : current_->next; next != nullptr; next = next->next) {
+      enter(next);
+      char* ptr = align_up(pos_, alignment);
+      if (fits(ptr, end_, bytes)) {
+        pos_ = ptr + bytes;
+        return ptr;
+      }
+    }
+    const size_t size = std::max(nextChunkSize_, HEADER + bytes + alignment);
+    nextChunkSize_ = std::min(nextChunkSize_ * 2, MAX_CHUNK_SIZE);
+    auto* chunk = static_cast<Chunk*>(upstream_.allocate(size));
+    chunk->next = nullptr;
+    chunk->size = size;
+    if (tail_ == nullptr) {
+      head_ = chunk;
     } else {
-      pool_.deallocate(ptr);
+      tail_->next = chunk;
     }
+    tail_ = chunk;
+    enter(chunk);
+    char* ptr = align_up(pos_, alignment);
+    pos_ = ptr + bytes;
+    return ptr;
   }
+
+ public:
+  /**
+   * Position in the arena - everything allocated after it can be dropped with {@link rewind()}
+   */
+  struct Marker {
+    Chunk* chunk;
+    char* pos;
+  };
+  /**
+   * Marks the arena on construction and rewinds to the mark on destruction.
+   * While alive the arena is the thread's active arena used by default constructed {@link ArenaAllocator}s.
+   */
+  class Scope {
+    MonotonicArena& arena_;
+    Marker marker_;
+    MonotonicArena* previous_;
+
+   public:
+    explicit Scope(MonotonicArena& arena) noexcept : arena_(arena), marker_(arena.mark()), previous_(active_) {
+      active_ = &arena_;
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope() {
+      active_ = previous_;
+      arena_.rewind(marker_);
+    }
+  };
+
+  /**
+   * @param buffer optional initial buffer used before any upstream chunk - not owned
+   * @param bufferSize size of the buffer in bytes
+   * @param chunkSize size of the first upstream chunk - following chunks double up to 64MB
+   * @param upstream source of the chunks
+   */
+  explicit MonotonicArena(void* buffer, size_t bufferSize, size_t chunkSize = 64 * 1024, ArenaUpstream upstream = {})
+      : pos_(static_cast<char*>(buffer)), end_(static_cast<char*>(buffer) + bufferSize),
+        buffer_(static_cast<char*>(buffer)), bufferSize_(bufferSize),
+        nextChunkSize_(std::max(chunkSize, HEADER * 2)), upstream_(upstream) {}
+  explicit MonotonicArena(size_t chunkSize = 64 * 1024, ArenaUpstream upstream = {})
+      : MonotonicArena(nullptr, 0, chunkSize, upstream) {}
+  MonotonicArena(const MonotonicArena&) = delete;
+  MonotonicArena& operator=(const MonotonicArena&) = delete;
+  ~MonotonicArena() { release(); }
+
+  /**
+   * @return memory for bytes with the given (power of two) alignment - valid until the next reset / rewind
+   */
+  inline void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    CX_ASSERT((alignment & (alignment - 1)) == 0, "alignment must be a power of two");
+    char* ptr = align_up(pos_, alignment);
+    if (fits(ptr, end_, bytes) && ptr != nullptr) [[likely]] {
+      pos_ = ptr + bytes;
+      return ptr;
+    }
+    return allocate_slow(bytes, alignment);
+  }
+  // Individual frees are ignored - memory is reclaimed by reset() or rewind()
+  inline void deallocate(void* /**/, size_t /**/) noexcept {}
+  [[nodiscard]] inline Marker mark() const noexcept { return {current_, pos_}; }
+  /**
+   * Drops everything allocated after the marker in O(1) - later chunks are kept for reuse
+   */
+  inline void rewind(Marker marker) noexcept {
+    current_ = marker.chunk;
+    pos_ = marker.pos;
+    end_ = current_ == nullptr ? buffer_ + bufferSize_ : reinterpret_cast<char*>(current_) + current_->size;
+  }
+  /**
+   * Drops everything in O(1) - upstream chunks are kept for reuse
+   */
+  inline void reset() noexcept { rewind({nullptr, buffer_}); }
+  /**
+   * Drops everything and returns all upstream chunks
+   */
+  void release() noexcept {
+    for (Chunk* chunk = head_; chunk != nullptr;) {
+      Chunk* next = chunk->next;
+      upstream_.deallocate(chunk, chunk->size);
+      chunk = next;
+    }
+    head_ = tail_ = nullptr;
+    reset();
+  }
+  /**
+   * @return the arena of the innermost {@link Scope} on this thread - nullptr if there is none
+   */
+  [[nodiscard]] static inline MonotonicArena* active() noexcept { return active_; }
+  // Bytes held from upstream
+  [[nodiscard]] size_t capacity() const noexcept {
+    size_t total = 0;
+    for (const Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next) {
+      total += chunk->size;
+    }
+    return total;
+  }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST();
+#  endif
 };
+
+/**
+ * <h2>ArenaAllocator</h2>
+ * Allocator that bumps out of a {@link MonotonicArena} - deallocate is a no-op.<p>
+ * Default constructed instances bind to the thread's active arena (innermost {@link MonotonicArena::Scope}),
+ * which is how cxstructs containers that construct their allocator themselves pick it up.
+ * Two allocators compare equal if they use the same arena.
+ * @tparam T value type
+ */
+template <typename T>
+class ArenaAllocator {
+  template <typename U>
+  friend class ArenaAllocator;
+  MonotonicArena* arena_;
+
+ public:
+  using value_type = T;
+  using is_always_equal = std::false_type;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator() noexcept : arena_(MonotonicArena::active()) {}
+  explicit ArenaAllocator(MonotonicArena& arena) noexcept : arena_(&arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& o) noexcept : arena_(o.arena_) {}  // NOLINT(*-explicit-constructor)
+
+  inline T* allocate(size_t n) {
+    CX_ASSERT(arena_ != nullptr, "no arena - construct with one or inside a MonotonicArena::Scope");
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+  inline void deallocate(T* /**/, size_t /**/) noexcept {}
+  [[nodiscard]] inline MonotonicArena* arena() const noexcept { return arena_; }
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& o) const noexcept {
+    return arena_ == o.arena_;
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& o) const noexcept {
+    return arena_ != o.arena_;
+  }
+};
+
+#  ifdef CX_INCLUDE_TESTS
+inline void MonotonicArena::TEST() {
+  std::cout << "TESTING MONOTONIC ARENA\n";
+
+  std::cout << "   Testing initial buffer...\n";
+  alignas(std::max_align_t) char buffer[1024];
+  MonotonicArena arena(buffer, sizeof(buffer), 4096);
+  [[maybe_unused]] auto* first = static_cast<char*>(arena.allocate(100, 1));
+  CX_ASSERT(first == buffer, "");
+  [[maybe_unused]] auto* aligned = static_cast<char*>(arena.allocate(8, 64));
+  CX_ASSERT(reinterpret_cast<uintptr_t>(aligned) % 64 == 0 && aligned >= first + 100, "");
+  CX_ASSERT(arena.capacity() == 0, "");
+
+  std::cout << "   Testing upstream chunks...\n";
+  [[maybe_unused]] auto* big = static_cast<char*>(arena.allocate(2000));
+  CX_ASSERT(big < buffer || big >= buffer + sizeof(buffer), "");
+  CX_ASSERT(arena.capacity() >= 2000, "");
+  for (int i = 0; i < 1000; i++) {
+    std::memset(arena.allocate(512), i, 512);
+  }
+  [[maybe_unused]] const size_t held = arena.capacity();
+
+  std::cout << "   Testing reset...\n";
+  arena.reset();
+  CX_ASSERT(arena.allocate(100, 1) == buffer, "");
+  for (int i = 0; i < 1000; i++) {
+    arena.allocate(512);
+  }
+  CX_ASSERT(arena.capacity() == held, "chunks should be reused after a reset");
+
+  std::cout << "   Testing scopes...\n";
+  arena.reset();
+  CX_ASSERT(MonotonicArena::active() == nullptr, "");
+  {
+    MonotonicArena::Scope outer(arena);
+    CX_ASSERT(MonotonicArena::active() == &arena, "");
+    std::vector<int, ArenaAllocator<int>> numbers;
+    for (int i = 0; i < 10000; i++) {
+      numbers.push_back(i);
+    }
+    [[maybe_unused]] const auto before = arena.mark();
+    {
+      MonotonicArena::Scope inner(arena);
+      std::list<int, ArenaAllocator<int>> list;
+      for (int i = 0; i < 1000; i++) {
+        list.push_back(i);
+      }
+      CX_ASSERT(list.size() == 1000, "");
+    }
+    CX_ASSERT(arena.mark().pos == before.pos, "inner scope should rewind");
+    for (int i = 0; i < 10000; i++) {
+      CX_ASSERT(numbers[i] == i, "");
+    }
+  }
+  CX_ASSERT(MonotonicArena::active() == nullptr, "");
+  CX_ASSERT(arena.allocate(1, 1) == buffer, "");
+
+  std::cout << "   Testing allocator equality...\n";
+  MonotonicArena other;
+  ArenaAllocator<int> a(arena);
+  ArenaAllocator<double> b(a);
+  CX_ASSERT(a == b && a != ArenaAllocator<int>(other), "");
+  arena.release();
+  CX_ASSERT(arena.capacity() == 0, "");
+}
+#  endif
+/**
+ * Snapshot of the counters of one {@link TrackingAllocator} site
+ */
+struct AllocationStats {
+  static constexpr int HISTOGRAM_BUCKETS = 40;
+  std::string name;
+  size_t liveBytes;
+  size_t peakBytes;
+  size_t totalBytes;
+  size_t allocations;
+  size_t deallocations;
+  size_t histogram[HISTOGRAM_BUCKETS];  // bucket i counts requests of (2^(i-1), 2^i] bytes, the last one all larger
+};
+}  // namespace cxstructs
+
+namespace cxhelper {
+struct AllocationSite {
+  std::string name;
+  std::atomic<size_t> liveBytes{0};
+  std::atomic<size_t> peakBytes{0};
+  std::atomic<size_t> totalBytes{0};
+  std::atomic<size_t> allocations{0};
+  std::atomic<size_t> deallocations{0};
+  std::atomic<size_t> histogram[cxstructs::AllocationStats::HISTOGRAM_BUCKETS]{};
+  AllocationSite* next = nullptr;
+
+  inline void on_allocate(size_t bytes) noexcept {
+    const size_t live = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (peak < live && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    totalBytes.fetch_add(bytes, std::memory_order_relaxed);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    int bucket = 0;
+    for (size_t b = bytes > 0 ? bytes - 1 : 0; b != 0; b >>= 1) bucket++;
+    histogram[std::min(bucket, cxstructs::AllocationStats::HISTOGRAM_BUCKETS - 1)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+  inline void on_deallocate(size_t bytes) noexcept {
+    liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+struct AllocationSample {
+  static constexpr int MAX_FRAMES = 24;
+  void* frames[MAX_FRAMES];
+  int depth;
+  size_t bytes;
+  const AllocationSite* site;
+};
+// Never destroyed - containers with static storage may still free memory after main()
+struct AllocationRegistry {
+  static constexpr size_t MAX_SAMPLES = 4096;
+  std::mutex lock;
+  std::atomic<AllocationSite*> sites{nullptr};
+  std::atomic<size_t> sampleInterval{0};  // 0 = sampling off
+  std::vector<AllocationSample> samples;
+  size_t droppedSamples = 0;
+};
+inline AllocationRegistry& allocation_registry() {
+  static AllocationRegistry& registry = *new AllocationRegistry();
+  return registry;
+}
+inline std::string demangle(const char* name) {
+#  ifdef __GNUG__
+  int status = 0;
+  char* readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status == 0 && readable != nullptr) {
+    std::string result(readable);
+    std::free(readable);
+    return result;
+  }
+#  endif
+  return name;
+}
+inline AllocationSite* register_allocation_site(const std::type_info& type) {
+  auto& registry = allocation_registry();
+  auto* site = new AllocationSite();
+  site->name = demangle(type.name());
+  std::lock_guard<std::mutex> guard(registry.lock);
+  site->next = registry.sites.load(std::memory_order_relaxed);
+  registry.sites.store(site, std::memory_order_release);
+  return site;
+}
+// One site per type - shared by all rebinds of an allocator with the same tag
+template <typename SiteType>
+inline AllocationSite& allocation_site() {
+  static AllocationSite* site = register_allocation_site(typeid(SiteType));
+  return *site;
+}
+// Captures the call stack every sampleInterval allocated bytes (per thread)
+inline void sample_allocation(const AllocationSite* site, size_t bytes) {
+  auto& registry = allocation_registry();
+  const size_t interval = registry.sampleInterval.load(std::memory_order_relaxed);
+  if (interval == 0) [[likely]] return;
+  thread_local size_t untilSample = 0;
+  thread_local size_t threadInterval = 0;
+  if (threadInterval != interval) [[unlikely]] {  // Interval changed since this thread last sampled
+    threadInterval = interval;
+    untilSample = interval;
+  }
+  if (untilSample > bytes) [[likely]] {
+    untilSample -= bytes;
+    return;
+  }
+  untilSample = interval;
+  AllocationSample sample{};
+  sample.bytes = bytes;
+  sample.site = site;
+#  if defined(CX_HAS_BACKTRACE)
+  sample.depth = backtrace(sample.frames, AllocationSample::MAX_FRAMES);
+#  elif defined(_WIN32)
+  sample.depth = CaptureStackBackTrace(0, AllocationSample::MAX_FRAMES, sample.frames, nullptr);
+#  endif
+  std::lock_guard<std::mutex> guard(registry.lock);
+  if (registry.samples.size() < AllocationRegistry::MAX_SAMPLES) {
+    registry.samples.push_back(sample);
+  } else {
+    registry.droppedSamples++;
+  }
+}
+}  // namespace cxhelper
+
+namespace cxstructs {
+/**
+ * <h2>TrackingAllocator</h2>
+ * Opt-in instrumented allocator that forwards to an upstream allocator and records live bytes, peak,
+ * allocation counts and a size histogram per site. A site is the Tag type, or T if no tag is given.
+ * Tag containers to tell them apart:
+ * {@code struct EmbeddingTable {}; vec<float, TrackingAllocator<float, EmbeddingTable>> table;}<p>
+ * Counters are relaxed atomics - a few nanoseconds per call. Call stack sampling is off by default,
+ * see {@link set_allocation_sampling()}. Use {@link allocation_report()} to dump everything.
+ * @tparam T value type
+ * @tparam Tag names the site - defaults to T
+ * @tparam Upstream allocator doing the actual work
+ */
+template <typename T, typename Tag = void, typename Upstream = std::allocator<T>>
+class TrackingAllocator {
+  template <typename U, typename G, typename P>
+  friend class TrackingAllocator;
+  using SiteType = std::conditional_t<std::is_void_v<Tag>, T, Tag>;
+  Upstream upstream_;
+
+  static cxhelper::AllocationSite& site() { return cxhelper::allocation_site<SiteType>(); }
+
+ public:
+  using value_type = T;
+  using is_always_equal = typename std::allocator_traits<Upstream>::is_always_equal;
+  using propagate_on_container_copy_assignment =
+      typename std::allocator_traits<Upstream>::propagate_on_container_copy_assignment;
+  using propagate_on_container_move_assignment =
+      typename std::allocator_traits<Upstream>::propagate_on_container_move_assignment;
+  using propagate_on_container_swap = typename std::allocator_traits<Upstream>::propagate_on_container_swap;
+  template <typename U>
+  struct rebind {
+    using other = TrackingAllocator<U, Tag, typename std::allocator_traits<Upstream>::template rebind_alloc<U>>;
+  };
+
+  TrackingAllocator() = default;
+  explicit TrackingAllocator(const Upstream& upstream) : upstream_(upstream) {}
+  template <typename U, typename P>
+  TrackingAllocator(const TrackingAllocator<U, Tag, P>& o)  // NOLINT(*-explicit-constructor)
+      : upstream_(o.upstream_) {}
+
+  inline T* allocate(size_t n) {
+    T* ptr = upstream_.allocate(n);
+    site().on_allocate(n * sizeof(T));
+    cxhelper::sample_allocation(&site(), n * sizeof(T));
+    return ptr;
+  }
+  inline void deallocate(T* ptr, size_t n) noexcept {
+    if (ptr == nullptr) return;
+    site().on_deallocate(n * sizeof(T));
+    upstream_.deallocate(ptr, n);
+  }
+  /**
+   * @return the counters of this allocator's site
+   */
+  [[nodiscard]] static AllocationStats stats() {
+    const auto& s = site();
+    AllocationStats result{s.name,
+                           s.liveBytes.load(std::memory_order_relaxed),
+                           s.peakBytes.load(std::memory_order_relaxed),
+                           s.totalBytes.load(std::memory_order_relaxed),
+                           s.allocations.load(std::memory_order_relaxed),
+                           s.deallocations.load(std::memory_order_relaxed),
+                           {}};
+    for (int i = 0; i < AllocationStats::HISTOGRAM_BUCKETS; i++) {
+      result.histogram[i] = s.histogram[i].load(std::memory_order_relaxed);
+    }
+    return result;
+  }
+  template <typename U, typename G, typename P>
+  bool operator==(const TrackingAllocator<U, G, P>& o) const noexcept {
+    return upstream_ == o.upstream_;
+  }
+  template <typename U, typename G, typename P>
+  bool operator!=(const TrackingAllocator<U, G, P>& o) const noexcept {
+    return !(*this == o);
+  }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST();
+#  endif
+};
+
+/**
+ * Enables call stack sampling for all TrackingAllocators - roughly one stack per bytesPerSample allocated bytes
+ * (per thread). Pass 0 to disable. Up to 4096 samples are kept.
+ */
+inline void set_allocation_sampling(size_t bytesPerSample) noexcept {
+  cxhelper::allocation_registry().sampleInterval.store(bytesPerSample, std::memory_order_relaxed);
+}
+/**
+ * Prints live/peak bytes, counts and the size histogram of every tracking site, followed by the sampled
+ * call stacks (symbolized where the platform allows, addresses otherwise)
+ */
+inline void allocation_report(std::ostream& out = std::cout) {
+  auto& registry = cxhelper::allocation_registry();
+  out << "---------------- allocation report ----------------\n";
+  for (auto* site = registry.sites.load(std::memory_order_acquire); site != nullptr; site = site->next) {
+    out << site->name << "\n  live: " << site->liveBytes.load(std::memory_order_relaxed)
+        << " B | peak: " << site->peakBytes.load(std::memory_order_relaxed)
+        << " B | total: " << site->totalBytes.load(std::memory_order_relaxed)
+        << " B | allocs: " << site->allocations.load(std::memory_order_relaxed)
+        << " | frees: " << site->deallocations.load(std::memory_order_relaxed) << "\n  sizes:";
+    for (int i = 0; i < AllocationStats::HISTOGRAM_BUCKETS; i++) {
+      const size_t count = site->histogram[i].load(std::memory_order_relaxed);
+      if (count == 0) continue;
+      if (i == AllocationStats::HISTOGRAM_BUCKETS - 1) {
+        out << " >" << ((size_t)1 << (i - 1)) << ":" << count;
+      } else {
+        out << " <=" << ((size_t)1 << i) << ":" << count;
+      }
+    }
+    out << "\n";
+  }
+  std::lock_guard<std::mutex> guard(registry.lock);
+  if (registry.samples.empty()) return;
+  // Merge identical stacks and print the heaviest first
+  struct Stack {
+    const cxhelper::AllocationSample* sample;
+    size_t count;
+    size_t bytes;
+  };
+  std::vector<Stack> stacks;
+  for (const auto& sample : registry.samples) {
+    auto it = std::find_if(stacks.begin(), stacks.end(), [&](const Stack& stack) {
+      return stack.sample->site == sample.site && stack.sample->depth == sample.depth
+             && std::equal(sample.frames, sample.frames + sample.depth, stack.sample->frames);
+    });
+    if (it == stacks.end()) {
+      stacks.push_back({&sample, 1, sample.bytes});
+    } else {
+      it->count++;
+      it->bytes += sample.bytes;
+    }
+  }
+  std::sort(stacks.begin(), stacks.end(), [](const Stack& a, const Stack& b) { return a.bytes > b.bytes; });
+  out << "---------------- sampled stacks (" << registry.samples.size() << " samples, " << registry.droppedSamples
+      << " dropped) ----------------\n";
+  for (const auto& stack : stacks) {
+    const auto& sample = *stack.sample;
+    out << sample.site->name << " | " << stack.count << " samples | " << stack.bytes << " B\n";
+    // Frame 0 is sample_allocation itself
+#  ifdef CX_HAS_BACKTRACE
+    char** symbols = backtrace_symbols(sample.frames, sample.depth);
+    for (int i = 1; i < sample.depth; i++) {
+      out << "    " << (symbols != nullptr ? symbols[i] : "?") << "\n";
+    }
+    std::free(static_cast<void*>(symbols));
+#  else
+    for (int i = 1; i < sample.depth; i++) {
+      out << "    " << sample.frames[i] << "\n";
+    }
+#  endif
+  }
+}
+
+#  ifdef CX_INCLUDE_TESTS
+template <typename T, typename Tag, typename Upstream>
+void TrackingAllocator<T, Tag, Upstream>::TEST() {
+  std::cout << "TESTING TRACKING ALLOCATOR\n";
+  struct TestSite {};
+  using Alloc = TrackingAllocator<T, TestSite>;
+
+  std::cout << "   Testing counters...\n";
+  Alloc alloc;
+  [[maybe_unused]] const auto before = Alloc::stats();
+  T* small = alloc.allocate(1);
+  T* large = alloc.allocate(1000);
+  auto during = Alloc::stats();
+  CX_ASSERT(during.name.find("TestSite") != std::string::npos, "");
+  CX_ASSERT(during.allocations == before.allocations + 2, "");
+  CX_ASSERT(during.liveBytes == before.liveBytes + 1001 * sizeof(T), "");
+  CX_ASSERT(during.peakBytes >= during.liveBytes, "");
+  alloc.deallocate(large, 1000);
+  alloc.deallocate(small, 1);
+  auto after = Alloc::stats();
+  CX_ASSERT(after.liveBytes == before.liveBytes && after.deallocations == before.deallocations + 2, "");
+  CX_ASSERT(after.peakBytes == during.peakBytes, "");
+  alloc.deallocate(nullptr, 1000);
+  CX_ASSERT(Alloc::stats().liveBytes == after.liveBytes, "Freeing null is a no-op");
+
+  std::cout << "   Testing histogram...\n";
+  size_t counted = 0;
+  for (auto count : after.histogram) counted += count;
+  CX_ASSERT(counted == after.allocations, "");
+  int bucket = 0;
+  for (size_t b = 1000 * sizeof(T) - 1; b != 0; b >>= 1) bucket++;
+  CX_ASSERT(after.histogram[bucket] >= 1, "");
+
+  std::cout << "   Testing rebinding and std containers...\n";
+  {
+    std::list<T, Alloc> list;
+    for (int i = 0; i < 100; i++) {
+      list.push_back(T(i));
+    }
+    CX_ASSERT(Alloc::stats().liveBytes > after.liveBytes, "nodes are tracked under the same tag");
+  }
+  CX_ASSERT(Alloc::stats().liveBytes == after.liveBytes, "");
+
+  std::cout << "   Testing sampling...\n";
+  set_allocation_sampling(64);
+  for (int i = 0; i < 100; i++) {
+    alloc.deallocate(alloc.allocate(16), 16);
+  }
+  set_allocation_sampling(0);
+  auto& registry = cxhelper::allocation_registry();
+  size_t sampleCount;
+  {
+    std::lock_guard<std::mutex> guard(registry.lock);
+    sampleCount = registry.samples.size();
+    CX_ASSERT(sampleCount != 0, "");
+  }
+  // A smaller interval takes effect right away - not only after the old one ran out
+  set_allocation_sampling(size_t(1) << 30);
+  alloc.deallocate(alloc.allocate(16), 16);
+  set_allocation_sampling(16 * sizeof(T));
+  alloc.deallocate(alloc.allocate(16), 16);
+  set_allocation_sampling(0);
+  {
+    std::lock_guard<std::mutex> guard(registry.lock);
+    [[maybe_unused]] const size_t expected = std::min(sampleCount + 1, cxhelper::AllocationRegistry::MAX_SAMPLES);
+    CX_ASSERT(registry.samples.size() == expected, "Sampling interval change was ignored");
+  }
+}
+#  endif
 }  // namespace cxstructs
 #endif  //CXSTRUCTS_SRC_CXALLOCATOR_H_
@@ -26,6 +26,7 @@
 //-----------UTIL-----------//
 #  include "cxutil/cxassert.h"
 #  include "cxutil/cxbits.h"
+#  include "cxutil/cxexec.h"
 #  include "cxutil/cxgraphics.h"
 #  include "cxutil/cxio.h"
 #  include "cxutil/cxmath.h"
@@ -53,6 +54,16 @@
 #  include "cxstructs/HashGrid.h"
 #  include "cxstructs/StackVector.h"
 #  include "cxstructs/StackHashMap.h"
+#  include "cxstructs/RadixHeap.h"
+#  include "cxstructs/BucketQueue.h"
+#  include "cxstructs/MultiQueue.h"
+#  include "cxstructs/SweepAndPrune.h"
+#  include "cxstructs/AABBTree.h"
+#  include "cxstructs/ConcurrentQueue.h"
+#  include "cxstructs/WorkStealingDeque.h"
+#  include "cxstructs/UnrolledLinkedList.h"
+#  include "cxstructs/IntrusiveList.h"
+#  include "cxstructs/LRUCache.h"
 
 //-----------MACHINE_LEARNING-----------//
 #  include "cxml/FNN.h"
@@ -0,0 +1,593 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_AABBTREE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_AABBTREE_H_
+
+#  include "../cxconfig.h"
+#  include <algorithm>
+#  include <cmath>
+#  include <limits>
+#  include <vector>
+#  include "Geometry.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <unordered_set>
+#  endif
+
+namespace cxstructs {
+
+/**
+ * @class AABBTree
+ * @brief Dynamic bounding volume hierarchy over axis aligned boxes - for many moving objects.
+ *
+ * Every leaf stores a "fat" box: the real bounds grown by a margin (and stretched along the last displacement).
+ * As long as an object stays inside its fat box move() is O(1) - otherwise the leaf is removed and reinserted in
+ * O(log n).<p>
+ * Insertion descends along the cheapest sibling by the surface area heuristic (perimeter in 2D) and every ancestor is
+ * re-balanced with AVL style tree rotations, so the height stays O(log n) even for sorted insertions.<p>
+ * All nodes live in a single pooled array with a free list - ids are leaf indices and stay valid until erase().
+ * Queries filter by the real (tight) bounds, the fat boxes only serve as the broad phase.
+ *
+ * <h2>Usage</h2>
+ * <pre>
+ * AABBTree&lt;Entity*&gt; tree(2.0F);
+ * uint32_t id = tree.insert({x, y, w, h}, entity);
+ * tree.move(id, {x + dx, y + dy, w, h}, {dx, dy});
+ * tree.query(area, [&](uint32_t hit) { return true; });  // return false to stop
+ * </pre>
+ */
+template <typename T = uint32_t>
+class AABBTree {
+ public:
+  static constexpr uint32_t NULL_NODE = UINT32_MAX;
+
+ private:
+  static constexpr int MAX_STACK = 64;  // Traversal stack - rotations keep the height around log2(n)
+  static constexpr float DISPLACEMENT_MULTIPLIER = 4.0F;
+
+  struct AABB {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    [[nodiscard]] inline float perimeter() const { return 2.0F * ((maxX - minX) + (maxY - minY)); }
+    [[nodiscard]] inline AABB merge(const AABB& o) const {
+      return {std::min(minX, o.minX), std::min(minY, o.minY), std::max(maxX, o.maxX), std::max(maxY, o.maxY)};
+    }
+    [[nodiscard]] inline bool contains(const AABB& o) const {
+      return minX <= o.minX && minY <= o.minY && o.maxX <= maxX && o.maxY <= maxY;
+    }
+    [[nodiscard]] inline bool overlaps(const AABB& o) const {
+      return !(minX > o.maxX || maxX < o.minX || minY > o.maxY || maxY < o.minY);
+    }
+    [[nodiscard]] inline float dist_sqr(float x, float y) const {
+      const float dx = std::max({minX - x, 0.0F, x - maxX});
+      const float dy = std::max({minY - y, 0.0F, y - maxY});
+      return dx * dx + dy * dy;
+    }
+    // Clips [tMin, tMax] to the slab [lo, hi] of one axis - false if the ray misses it
+    // An infinite inverse is a ray parallel to the slab: it hits only if the origin lies inside (avoids 0 * inf)
+    static inline bool clip_slab(float o, float inv, float lo, float hi, float& tMin, float& tMax) {
+      if (std::isinf(inv)) return lo <= o && o <= hi;
+      const float t1 = (lo - o) * inv;
+      const float t2 = (hi - o) * inv;
+      tMin = std::max(tMin, std::min(t1, t2));
+      tMax = std::min(tMax, std::max(t1, t2));
+      return tMin <= tMax;
+    }
+    // Slab test - entry parameter of the ray or infinity if it misses within [0, maxT]
+    [[nodiscard]] inline float ray_entry(float ox, float oy, float invX, float invY, float maxT) const {
+      float tMin = 0.0F;
+      float tMax = maxT;
+      if (!clip_slab(ox, invX, minX, maxX, tMin, tMax) || !clip_slab(oy, invY, minY, maxY, tMin, tMax)) {
+        return std::numeric_limits<float>::infinity();
+      }
+      return tMin;
+    }
+    static inline AABB from(const Rect& r) { return {r.x(), r.y(), r.x() + r.width(), r.y() + r.height()}; }
+    [[nodiscard]] inline Rect rect() const { return {minX, minY, maxX - minX, maxY - minY}; }
+  };
+
+  struct Node {
+    AABB box;    // Fat box for leaves
+    AABB tight;  // Real bounds - leaves only
+    uint32_t parent;
+    uint32_t left;
+    uint32_t right;
+    int32_t height;  // 0 for leaves, -1 if free
+    T data;
+
+    [[nodiscard]] inline bool is_leaf() const { return left == NULL_NODE; }
+  };
+
+  std::vector<Node> nodes_;
+  uint32_t root_ = NULL_NODE;
+  uint32_t freeList_ = NULL_NODE;  // Linked through parent
+  uint32_t size_ = 0;
+  float margin_;
+
+  inline uint32_t allocate() {
+    uint32_t id;
+    if (freeList_ != NULL_NODE) {
+      id = freeList_;
+      freeList_ = nodes_[id].parent;
+    } else {
+      id = (uint32_t)nodes_.size();
+      nodes_.emplace_back();
+    }
+    Node& n = nodes_[id];
+    n.parent = n.left = n.right = NULL_NODE;
+    n.height = 0;
+    return id;
+  }
+  inline void release(uint32_t id) {
+    nodes_[id].parent = freeList_;
+    nodes_[id].height = -1;
+    freeList_ = id;
+  }
+  inline void refit(uint32_t id) {
+    Node& n = nodes_[id];
+    const Node& l = nodes_[n.left];
+    const Node& r = nodes_[n.right];
+    n.box = l.box.merge(r.box);
+    n.height = 1 + std::max(l.height, r.height);
+  }
+  // Walks to the root re-balancing and refitting every ancestor
+  inline void fix_upwards(uint32_t id) {
+    while (id != NULL_NODE) {
+      id = balance(id);
+      refit(id);
+      id = nodes_[id].parent;
+    }
+  }
+  inline void replace_child(uint32_t parent, uint32_t oldChild, uint32_t newChild) {
+    if (parent == NULL_NODE) {
+      root_ = newChild;
+    } else if (nodes_[parent].left == oldChild) {
+      nodes_[parent].left = newChild;
+    } else {
+      nodes_[parent].right = newChild;
+    }
+  }
+  // Rotates the taller grandchild of a up if the children of a differ in height by more than one
+  inline uint32_t balance(uint32_t iA) {
+    Node& a = nodes_[iA];
+    if (a.is_leaf() || a.height < 2) return iA;
+    const uint32_t iB = a.left;
+    const uint32_t iC = a.right;
+    Node& b = nodes_[iB];
+    Node& c = nodes_[iC];
+    const int32_t diff = c.height - b.height;
+    if (diff > 1) {
+      const uint32_t iF = c.left;
+      const uint32_t iG = c.right;
+      Node& f = nodes_[iF];
+      Node& g = nodes_[iG];
+      c.left = iA;
+      c.parent = a.parent;
+      a.parent = iC;
+      replace_child(c.parent, iA, iC);
+      if (f.height > g.height) {
+        c.right = iF;
+        a.right = iG;
+        g.parent = iA;
+      } else {
+        c.right = iG;
+        a.right = iF;
+        f.parent = iA;
+      }
+      refit(iA);
+      refit(iC);
+      return iC;
+    }
+    if (diff < -1) {
+      const uint32_t iD = b.left;
+      const uint32_t iE = b.right;
+      Node& d = nodes_[iD];
+      Node& e = nodes_[iE];
+      b.left = iA;
+      b.parent = a.parent;
+      a.parent = iB;
+      replace_child(b.parent, iA, iB);
+      if (d.height > e.height) {
+        b.right = iD;
+        a.left = iE;
+        e.parent = iA;
+      } else {
+        b.right = iE;
+        a.left = iD;
+        d.parent = iA;
+      }
+      refit(iA);
+      refit(iB);
+      return iB;
+    }
+    return iA;
+  }
+  inline void insert_leaf(uint32_t leaf) {
+    if (root_ == NULL_NODE) {
+      root_ = leaf;
+      nodes_[leaf].parent = NULL_NODE;
+      return;
+    }
+    // Descend along the sibling with the smallest cost increase (surface area heuristic)
+    const AABB box = nodes_[leaf].box;
+    uint32_t index = root_;
+    while (!nodes_[index].is_leaf()) {
+      const Node& n = nodes_[index];
+      const float area = n.box.perimeter();
+      const float combined = n.box.merge(box).perimeter();
+      const float cost = 2.0F * combined;                 // New parent for this node and the leaf
+      const float inheritance = 2.0F * (combined - area);  // Growth pushed down to all ancestors
+      auto descend_cost = [&](uint32_t child) {
+        const Node& c = nodes_[child];
+        const float grown = c.box.merge(box).perimeter();
+        return (c.is_leaf() ? grown : grown - c.box.perimeter()) + inheritance;
+      };
+      const float leftCost = descend_cost(n.left);
+      const float rightCost = descend_cost(n.right);
+      if (cost < leftCost && cost < rightCost) break;
+      index = leftCost < rightCost ? n.left : n.right;
+    }
+
+    const uint32_t sibling = index;
+    const uint32_t parent = allocate();  // May reallocate - no references above
+    const uint32_t oldParent = nodes_[sibling].parent;
+    Node& p = nodes_[parent];
+    p.parent = oldParent;
+    p.left = sibling;
+    p.right = leaf;
+    replace_child(oldParent, sibling, parent);
+    nodes_[sibling].parent = parent;
+    nodes_[leaf].parent = parent;
+    fix_upwards(parent);
+  }
+  inline void remove_leaf(uint32_t leaf) {
+    if (leaf == root_) {
+      root_ = NULL_NODE;
+      return;
+    }
+    const uint32_t parent = nodes_[leaf].parent;
+    const uint32_t grandParent = nodes_[parent].parent;
+    const uint32_t sibling = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+    replace_child(grandParent, parent, sibling);
+    nodes_[sibling].parent = grandParent;
+    release(parent);
+    fix_upwards(grandParent);
+  }
+  [[nodiscard]] inline AABB fatten(const AABB& tight, const Point& displacement) const {
+    AABB fat{tight.minX - margin_, tight.minY - margin_, tight.maxX + margin_, tight.maxY + margin_};
+    const float dx = DISPLACEMENT_MULTIPLIER * displacement.x();
+    const float dy = DISPLACEMENT_MULTIPLIER * displacement.y();
+    (dx < 0 ? fat.minX : fat.maxX) += dx;
+    (dy < 0 ? fat.minY : fat.maxY) += dy;
+    return fat;
+  }
+
+ public:
+  /**
+   * @param margin how much the fat boxes are grown on each side - larger means fewer reinserts but looser queries
+   */
+  explicit AABBTree(float margin = 1.0F) : margin_(margin) {}
+  /**
+   * Inserts a box
+   * @param bounds the bounds of the object
+   * @param data user data stored with it
+   * @return the id of the object
+   */
+  inline uint32_t insert(const Rect& bounds, const T& data = T()) {
+    const uint32_t leaf = allocate();
+    Node& n = nodes_[leaf];
+    n.tight = AABB::from(bounds);
+    n.box = fatten(n.tight, {});
+    n.data = data;
+    insert_leaf(leaf);
+    size_++;
+    return leaf;
+  }
+  /**
+   * Removes an object - its id becomes invalid
+   * @param id id returned by insert()
+   */
+  inline void erase(uint32_t id) {
+    CX_ASSERT(id < nodes_.size() && nodes_[id].height == 0, "invalid id");
+    remove_leaf(id);
+    release(id);
+    size_--;
+  }
+  /**
+   * Updates the bounds of an object. Only if they left the fat box the leaf is reinserted (O(log n)) with a new fat
+   * box that is stretched along the displacement
+   * @param id id returned by insert()
+   * @param bounds the new bounds
+   * @param displacement the movement since the last update - predicts where the object is going
+   * @return true if the leaf was reinserted
+   */
+  inline bool move(uint32_t id, const Rect& bounds, const Point& displacement = {}) {
+    CX_ASSERT(id < nodes_.size() && nodes_[id].height == 0, "invalid id");
+    const AABB tight = AABB::from(bounds);
+    nodes_[id].tight = tight;
+    if (nodes_[id].box.contains(tight)) return false;
+    remove_leaf(id);
+    nodes_[id].box = fatten(tight, displacement);
+    insert_leaf(id);
+    return true;
+  }
+  /**
+   * Calls {@code callback(id)} for every object whose bounds overlap the area - touching counts.
+   * The callback returns false to stop the query
+   */
+  template <typename Callback>
+  inline void query(const Rect& area, Callback&& callback) const {
+    if (root_ == NULL_NODE) return;
+    const AABB box = AABB::from(area);
+    uint32_t stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+      const Node& n = nodes_[stack[--top]];
+      if (!n.box.overlaps(box)) continue;
+      if (n.is_leaf()) {
+        if (n.tight.overlaps(box) && !callback(stack[top])) return;
+      } else {
+        CX_ASSERT(top + 2 <= MAX_STACK, "tree too deep");
+        stack[top++] = n.left;
+        stack[top++] = n.right;
+      }
+    }
+  }
+  /**
+   * Casts the ray {@code origin + t * dir} for t in [0, maxT].<p>
+   * Calls {@code callback(id, t)} with the entry parameter t for every object whose bounds the ray hits. The callback
+   * returns the new maxT: return t to only look for closer hits, maxT to continue unchanged or 0 to stop
+   */
+  template <typename Callback>
+  inline void ray_cast(const Point& origin, const Point& dir, float maxT, Callback&& callback) const {
+    if (root_ == NULL_NODE) return;
+    constexpr float INF = std::numeric_limits<float>::infinity();
+    const float invX = dir.x() != 0 ? 1.0F / dir.x() : INF;
+    const float invY = dir.y() != 0 ? 1.0F / dir.y() : INF;
+    uint32_t stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0 && maxT > 0) {
+      const uint32_t id = stack[--top];
+      const Node& n = nodes_[id];
+      if (n.box.ray_entry(origin.x(), origin.y(), invX, invY, maxT) == INF) continue;
+      if (n.is_leaf()) {
+        const float t = n.tight.ray_entry(origin.x(), origin.y(), invX, invY, maxT);
+        if (t != INF) maxT = callback(id, t);
+      } else {
+        CX_ASSERT(top + 2 <= MAX_STACK, "tree too deep");
+        stack[top++] = n.left;
+        stack[top++] = n.right;
+      }
+    }
+  }
+  /**
+   * Finds the object with the smallest distance between its bounds and the point (0 if inside)
+   * @param p the point
+   * @param maxDist only objects at most this far away are considered
+   * @return the id of the nearest object or NULL_NODE if none is within maxDist
+   */
+  [[nodiscard]] inline uint32_t nearest(const Point& p, float maxDist = std::numeric_limits<float>::infinity()) const {
+    uint32_t best = NULL_NODE;
+    if (root_ == NULL_NODE) return best;
+    float bestDist = maxDist == std::numeric_limits<float>::infinity() ? maxDist : maxDist * maxDist;
+    uint32_t stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = root_;
+    while (top > 0) {
+      const uint32_t id = stack[--top];
+      const Node& n = nodes_[id];
+      if (n.box.dist_sqr(p.x(), p.y()) > bestDist) continue;
+      if (n.is_leaf()) {
+        const float dist = n.tight.dist_sqr(p.x(), p.y());
+        if (dist <= bestDist) {
+          bestDist = dist;
+          best = id;
+        }
+        continue;
+      }
+      // Visit the closer child first so the bound shrinks early
+      CX_ASSERT(top + 2 <= MAX_STACK, "tree too deep");
+      const bool leftFirst =
+          nodes_[n.left].box.dist_sqr(p.x(), p.y()) <= nodes_[n.right].box.dist_sqr(p.x(), p.y());
+      stack[top++] = leftFirst ? n.right : n.left;
+      stack[top++] = leftFirst ? n.left : n.right;
+    }
+    return best;
+  }
+  [[nodiscard]] inline T& data(uint32_t id) { return nodes_[id].data; }
+  [[nodiscard]] inline const T& data(uint32_t id) const { return nodes_[id].data; }
+  [[nodiscard]] inline Rect bounds(uint32_t id) const { return nodes_[id].tight.rect(); }
+  [[nodiscard]] inline Rect fat_bounds(uint32_t id) const { return nodes_[id].box.rect(); }
+  [[nodiscard]] inline uint32_t size() const { return size_; }
+  [[nodiscard]] inline bool empty() const { return size_ == 0; }
+  /**
+   * @return height of the tree - 0 for a single leaf, -1 if empty
+   */
+  [[nodiscard]] inline int height() const { return root_ == NULL_NODE ? -1 : nodes_[root_].height; }
+  inline void clear() {
+    nodes_.clear();
+    root_ = freeList_ = NULL_NODE;
+    size_ = 0;
+  }
+  inline void reserve(uint32_t objects) { nodes_.reserve(2 * objects); }
+#  ifdef CX_INCLUDE_TESTS
+ private:
+  // Checks parent links, heights and that every box encloses its children - returns the leaf count
+  uint32_t validate(uint32_t id) const {
+    const Node& n = nodes_[id];
+    if (n.is_leaf()) {
+      CX_ASSERT(n.height == 0 && n.box.contains(n.tight), "");
+      return 1;
+    }
+    const Node& l = nodes_[n.left];
+    const Node& r = nodes_[n.right];
+    CX_ASSERT(l.parent == id && r.parent == id, "");
+    CX_ASSERT(n.height == 1 + std::max(l.height, r.height), "");
+    CX_ASSERT(n.box.contains(l.box) && n.box.contains(r.box), "");
+    return validate(n.left) + validate(n.right);
+  }
+
+ public:
+  static void TEST() {
+    std::cout << "AABB TREE TESTS" << std::endl;
+    uint32_t seed = 777;
+    auto next = [&seed](uint32_t mod) {
+      seed = seed * 1103515245U + 12345U;
+      return static_cast<float>((seed >> 8) % mod);
+    };
+    std::cout << "  Testing insert and balance..." << std::endl;
+    AABBTree<int> tree(2.0F);
+    CX_ASSERT(tree.empty() && tree.height() == -1 && tree.nearest({0, 0}) == NULL_NODE, "");
+    std::vector<Rect> boxes;
+    std::vector<uint32_t> ids;
+    // Sorted insertion is the worst case without rotations
+    for (int i = 0; i < 1000; i++) {
+      boxes.emplace_back((float)i * 10, 0, 5, 5);
+      ids.push_back(tree.insert(boxes.back(), i));
+    }
+    CX_ASSERT(tree.size() == 1000 && tree.validate(tree.root_) == 1000, "");
+    CX_ASSERT(tree.height() <= 15, "Rotations should keep the tree balanced");
+    for (int i = 0; i < 1000; i++) {
+      CX_ASSERT(tree.data(ids[i]) == i, "");
+    }
+
+    [[maybe_unused]] auto brute_query = [&](const Rect& area) {
+      std::unordered_set<uint32_t> hits;
+      for (uint32_t i = 0; i < ids.size(); i++) {
+        if (ids[i] != NULL_NODE && area.intersects(boxes[i])) hits.insert(ids[i]);
+      }
+      return hits;
+    };
+    [[maybe_unused]] auto tree_query = [&](const Rect& area) {
+      std::unordered_set<uint32_t> hits;
+      tree.query(area, [&](uint32_t id) {
+        hits.insert(id);
+        return true;
+      });
+      return hits;
+    };
+
+    std::cout << "  Testing moves and queries..." << std::endl;
+    tree.clear();
+    boxes.clear();
+    ids.clear();
+    for (int i = 0; i < 2000; i++) {
+      boxes.emplace_back(next(2000), next(2000), 1 + next(20), 1 + next(20));
+      ids.push_back(tree.insert(boxes.back(), i));
+    }
+    int reinserts = 0;
+    for (int tick = 0; tick < 10; tick++) {
+      for (uint32_t i = 0; i < ids.size(); i++) {
+        const Point d(next(5) - 2, next(5) - 2);
+        boxes[i].x() += d.x();
+        boxes[i].y() += d.y();
+        reinserts += tree.move(ids[i], boxes[i], d);
+      }
+      CX_ASSERT(tree.validate(tree.root_) == 2000 && tree.height() <= 24, "");
+      const Rect area(next(1800), next(1800), 200, 200);
+      CX_ASSERT(tree_query(area) == brute_query(area), "");
+    }
+    CX_ASSERT(reinserts < 10 * 2000, "Small moves should stay inside the fat box");
+
+    std::cout << "  Testing erase..." << std::endl;
+    for (uint32_t i = 0; i < ids.size(); i += 2) {
+      tree.erase(ids[i]);
+      ids[i] = NULL_NODE;
+    }
+    CX_ASSERT(tree.size() == 1000 && tree.validate(tree.root_) == 1000, "");
+    const Rect all(-100, -100, 2300, 2300);
+    CX_ASSERT(tree_query(all) == brute_query(all) && tree_query(all).size() == 1000, "");
+    int visited = 0;
+    tree.query(all, [&](uint32_t) { return ++visited < 10; });
+    CX_ASSERT(visited == 10, "Returning false stops the query");
+
+    std::cout << "  Testing nearest..." << std::endl;
+    for (int k = 0; k < 50; k++) {
+      const Point p(next(2000), next(2000));
+      float bestDist = std::numeric_limits<float>::infinity();
+      for (uint32_t i = 0; i < ids.size(); i++) {
+        if (ids[i] == NULL_NODE) continue;
+        bestDist = std::min(bestDist, AABB::from(boxes[i]).dist_sqr(p.x(), p.y()));
+      }
+      [[maybe_unused]] const uint32_t found = tree.nearest(p);
+      CX_ASSERT(found != NULL_NODE && tree.nodes_[found].tight.dist_sqr(p.x(), p.y()) == bestDist, "");
+    }
+    CX_ASSERT(tree.nearest({-5000, -5000}, 10) == NULL_NODE, "");
+    AABBTree<int> lone;
+    [[maybe_unused]] const uint32_t edge = lone.insert({10, 0, 2, 2}, 1);
+    CX_ASSERT(lone.nearest({7, 1}, 3) == edge && lone.nearest({7, 1}, 2.9F) == NULL_NODE, "maxDist is inclusive");
+
+    std::cout << "  Testing ray cast..." << std::endl;
+    AABBTree<int> rays;
+    [[maybe_unused]] const uint32_t a = rays.insert({10, -1, 2, 2}, 1);
+    const uint32_t b = rays.insert({20, -1, 2, 2}, 2);
+    rays.insert({15, 5, 2, 2}, 3);
+    uint32_t closest = NULL_NODE;
+    float closestT = 0;
+    rays.ray_cast({0, 0}, {1, 0}, 100, [&](uint32_t id, float t) {
+      closest = id;
+      closestT = t;
+      return t;
+    });
+    CX_ASSERT(closest == a && closestT == 10, "");
+    int hitCount = 0;
+    rays.ray_cast({0, 0}, {1, 0}, 100, [&](uint32_t, float) {
+      hitCount++;
+      return 100.0F;
+    });
+    CX_ASSERT(hitCount == 2, "");
+    hitCount = 0;
+    rays.ray_cast({0, 0}, {1, 0}, 15, [&](uint32_t id, float) {
+      hitCount += id == b;
+      return 15.0F;
+    });
+    CX_ASSERT(hitCount == 0, "maxT limits the ray");
+    hitCount = 0;
+    rays.ray_cast({16, 0}, {0, 1}, 100, [&]([[maybe_unused]] uint32_t id, [[maybe_unused]] float t) {
+      CX_ASSERT(rays.data(id) == 3 && t == 5, "");
+      hitCount++;
+      return 100.0F;
+    });
+    CX_ASSERT(hitCount == 1, "");
+    // Origin on a slab boundary with a zero direction component - no 0 * inf
+    closest = NULL_NODE;
+    rays.ray_cast({0, -1}, {1, 0}, 100, [&](uint32_t id, float t) {
+      closest = id;
+      closestT = t;
+      return t;
+    });
+    CX_ASSERT(closest == a && closestT == 10, "Ray along the bottom edge");
+    closest = NULL_NODE;
+    rays.ray_cast({12, -5}, {0, 1}, 100, [&](uint32_t id, float t) {
+      closest = id;
+      closestT = t;
+      return t;
+    });
+    CX_ASSERT(closest == a && closestT == 4, "Ray along the right edge");
+  }
+#  endif
+};
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_AABBTREE_H_
@@ -0,0 +1,158 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_BUCKETQUEUE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_BUCKETQUEUE_H_
+
+#  include "../cxconfig.h"
+#  include <vector>
+#  ifdef CX_INCLUDE_TESTS
+#    include <queue>
+#  endif
+
+namespace cxstructs {
+
+/**
+ * @class BucketQueue
+ * @brief Dial's bucket queue for small integer priorities with O(1) push and amortized O(1) pop.
+ *
+ * One bucket per key in a ring of maxSpread + 1 buckets. Keys have to be monotone and may be at most maxSpread larger
+ * than the current minimum - e.g. Dijkstra where maxSpread is the largest edge cost. Pop scans forward to the next
+ * non-empty bucket. Faster than a RadixHeap when the spread is small, use the RadixHeap for large or unknown ranges.<p>
+ * Keys smaller than the current minimum are treated as equal to it. Equal keys are popped last in first out.
+ */
+template <typename Value>
+class BucketQueue {
+  struct Entry {
+    uint64_t key;
+    Value value;
+  };
+  std::vector<std::vector<Entry>> buckets_;
+  uint64_t current_ = 0;  // Key of the bucket the scan is at
+  uint32_t size_ = 0;
+
+  [[nodiscard]] inline std::vector<Entry>& bucket(const uint64_t key) noexcept {
+    return buckets_[key % buckets_.size()];
+  }
+  inline void advance() noexcept {
+    while (bucket(current_).empty()) current_++;
+  }
+
+ public:
+  /**
+   * @param maxSpread largest possible difference between any key in the queue and the minimum
+   */
+  explicit BucketQueue(const uint32_t maxSpread = 255) : buckets_(maxSpread + 1) {}
+  /**
+   * Adds an element
+   * @param key priority - in [minimum, minimum + maxSpread]
+   * @param value the element
+   */
+  inline void push(uint64_t key, const Value& value) {
+    if (key < current_) key = current_;
+    CX_ASSERT(key - current_ < buckets_.size(), "key exceeds the max spread");
+    bucket(key).push_back({key, value});
+    size_++;
+  }
+  /**
+   * @return the element with the smallest key
+   */
+  [[nodiscard]] inline Value& top() noexcept {
+    CX_ASSERT(size_ > 0, "no such element");
+    advance();
+    return bucket(current_).back().value;
+  }
+  /**
+   * @return the smallest key
+   */
+  [[nodiscard]] inline uint64_t top_key() noexcept {
+    CX_ASSERT(size_ > 0, "no such element");
+    advance();
+    return current_;
+  }
+  /**
+   * Removes the element with the smallest key
+   */
+  inline void pop() noexcept {
+    CX_ASSERT(size_ > 0, "no such element");
+    advance();
+    bucket(current_).pop_back();
+    size_--;
+  }
+  [[nodiscard]] inline uint32_t size() const noexcept { return size_; }
+  [[nodiscard]] inline bool empty() const noexcept { return size_ == 0; }
+  /**
+   * Removes all elements and restarts at key 0 - keeps the allocated memory
+   */
+  inline void reset() noexcept {
+    for (auto& b : buckets_) {
+      b.clear();
+    }
+    size_ = 0;
+    current_ = 0;
+  }
+  inline void clear() noexcept { reset(); }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "BUCKET QUEUE TESTS" << std::endl;
+    std::cout << "  Testing push/pop..." << std::endl;
+    BucketQueue<int> queue(10);
+    CX_ASSERT(queue.empty(), "");
+    queue.push(4, 40);
+    queue.push(2, 20);
+    queue.push(9, 90);
+    queue.push(2, 21);
+    CX_ASSERT(queue.size() == 4 && queue.top_key() == 2 && queue.top() == 21, "");
+    queue.pop();
+    queue.pop();
+    CX_ASSERT(queue.top_key() == 4, "");
+    queue.pop();
+    queue.push(14, 140);  // Wraps around the ring
+    CX_ASSERT(queue.top() == 90, "");
+    queue.pop();
+    CX_ASSERT(queue.top_key() == 14 && queue.top() == 140, "");
+    queue.pop();
+    CX_ASSERT(queue.empty(), "");
+
+    std::cout << "  Testing against std::priority_queue..." << std::endl;
+    BucketQueue<uint64_t> dial(100);
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>> reference;
+    srand(8);
+    uint64_t last = 0;
+    for (int i = 0; i < 50000; i++) {
+      if (rand() % 3 != 0 || reference.empty()) {
+        const uint64_t key = last + rand() % 101;
+        dial.push(key, key);
+        reference.push(key);
+      } else {
+        last = reference.top();
+        reference.pop();
+        CX_ASSERT(dial.top_key() == last && dial.top() == last, "");
+        dial.pop();
+      }
+    }
+    dial.reset();
+    CX_ASSERT(dial.empty(), "");
+  }
+#  endif
+};
+
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_BUCKETQUEUE_H_
@@ -0,0 +1,480 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_CONCURRENTQUEUE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_CONCURRENTQUEUE_H_
+
+#  include "../cxconfig.h"
+#  include <algorithm>
+#  include <atomic>
+#  include <cstddef>
+#  include <memory>
+#  include <new>
+#  include <thread>
+#  ifdef CX_INCLUDE_TESTS
+#    include <iostream>
+#    include <string>
+#    include <vector>
+#  endif
+
+namespace cxstructs {
+
+/**
+ * @class SPSCQueue
+ * @brief Bounded wait-free ring buffer for exactly one producer and one consumer thread.
+ *
+ * Head and tail live on separate cache lines. Each side also caches the last seen index of the other side, so the
+ * shared cache line is only read when the ring looks full (producer) or empty (consumer).<p>
+ * Keeps the {@link Queue} API: push(), emplace(), front() and pop() - push() and emplace() spin while the ring is
+ * full, front() and pop() require a non-empty ring (check empty() first). The try_ variants never wait.
+ * push_n() and pop_n() move whole batches with a single index update.<p>
+ * The capacity is rounded up to a power of two.
+ * @tparam T the datatype
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class SPSCQueue {
+  static constexpr size_t CACHE_LINE = 64;
+
+  Allocator alloc_;
+  T* slots_;
+  size_t capacity_;
+  size_t mask_;
+  // Producer side
+  alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+  size_t headCache_ = 0;
+  // Consumer side
+  alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+  size_t tailCache_ = 0;
+  char pad_[CACHE_LINE - sizeof(size_t) - sizeof(std::atomic<size_t>)]{};
+
+  // Free slots seen by the producer - only reloads head_ if the cached value says there is not enough space
+  inline size_t free_slots(size_t tail, size_t wanted) {
+    size_t space = capacity_ - (tail - headCache_);
+    if (space < wanted) {
+      headCache_ = head_.load(std::memory_order_acquire);
+      space = capacity_ - (tail - headCache_);
+    }
+    return space;
+  }
+  // Filled slots seen by the consumer
+  inline size_t filled_slots(size_t head, size_t wanted) {
+    size_t filled = tailCache_ - head;
+    if (filled < wanted) {
+      tailCache_ = tail_.load(std::memory_order_acquire);
+      filled = tailCache_ - head;
+    }
+    return filled;
+  }
+
+ public:
+  /**
+   * @param capacity the maximum number of elements - rounded up to a power of two
+   */
+  explicit SPSCQueue(size_t capacity = 1024) {
+    capacity_ = 2;
+    while (capacity_ < capacity) capacity_ <<= 1;
+    mask_ = capacity_ - 1;
+    slots_ = alloc_.allocate(capacity_);
+  }
+  SPSCQueue(const SPSCQueue&) = delete;
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+  ~SPSCQueue() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      const size_t tail = tail_.load(std::memory_order_relaxed);
+      for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+        std::allocator_traits<Allocator>::destroy(alloc_, &slots_[i & mask_]);
+      }
+    }
+    alloc_.deallocate(slots_, capacity_);
+  }
+  /**
+   * Producer only. Constructs a new element at the back
+   * @return false if the ring is full
+   */
+  template <typename... Args>
+  inline bool try_emplace(Args&&... args) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (free_slots(tail, 1) == 0) return false;
+    std::allocator_traits<Allocator>::construct(alloc_, &slots_[tail & mask_], std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  inline bool try_push(const T& e) { return try_emplace(e); }
+  inline bool try_push(T&& e) { return try_emplace(std::move(e)); }
+  /**
+   * Producer only. Constructs a new element at the back - spins while the ring is full
+   */
+  template <typename... Args>
+  inline void emplace(Args&&... args) {
+    while (!try_emplace(std::forward<Args>(args)...)) {
+      std::this_thread::yield();
+    }
+  }
+  inline void push(const T& e) { emplace(e); }
+  inline void push(T&& e) { emplace(std::move(e)); }
+  /**
+   * Producer only. Copies as many elements as fit, with a single index update
+   * @param items the elements
+   * @param n number of elements
+   * @return the number of elements pushed
+   */
+  inline size_t push_n(const T* items, size_t n) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    n = std::min(n, free_slots(tail, n));
+    for (size_t i = 0; i < n; ++i) {
+      std::allocator_traits<Allocator>::construct(alloc_, &slots_[(tail + i) & mask_], items[i]);
+    }
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+  }
+  /**
+   * Consumer only. Returns a reference to the front element - the ring must not be empty
+   */
+  [[nodiscard]] inline T& front() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    CX_ASSERT(filled_slots(head, 1) > 0, "no such element");
+    return slots_[head & mask_];
+  }
+  /**
+   * Consumer only. Removes the front element - the ring must not be empty
+   */
+  inline void pop() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    CX_ASSERT(filled_slots(head, 1) > 0, "no such element");
+    std::allocator_traits<Allocator>::destroy(alloc_, &slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+  }
+  /**
+   * Consumer only. Moves the front element out
+   * @return false if the ring is empty
+   */
+  inline bool try_pop(T& out) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (filled_slots(head, 1) == 0) return false;
+    T& slot = slots_[head & mask_];
+    out = std::move(slot);
+    std::allocator_traits<Allocator>::destroy(alloc_, &slot);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+  /**
+   * Consumer only. Moves up to n elements out, with a single index update
+   * @param out destination with room for n elements
+   * @param n maximum number of elements
+   * @return the number of elements popped
+   */
+  inline size_t pop_n(T* out, size_t n) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    n = std::min(n, filled_slots(head, n));
+    for (size_t i = 0; i < n; ++i) {
+      T& slot = slots_[(head + i) & mask_];
+      out[i] = std::move(slot);
+      std::allocator_traits<Allocator>::destroy(alloc_, &slot);
+    }
+    head_.store(head + n, std::memory_order_release);
+    return n;
+  }
+  /**
+   * Consumer only
+   * @return true if there is no element to pop
+   */
+  [[nodiscard]] inline bool empty() { return filled_slots(head_.load(std::memory_order_relaxed), 1) == 0; }
+  /**
+   * @return the number of elements - only a snapshot if called while the other side is active
+   */
+  [[nodiscard]] inline size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] inline size_t capacity() const { return capacity_; }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "SPSC QUEUE TESTS" << std::endl;
+    std::cout << "  Testing single thread..." << std::endl;
+    SPSCQueue<int> q(5);
+    CX_ASSERT(q.capacity() == 8 && q.empty(), "");
+    for (int i = 0; i < 8; i++) {
+      [[maybe_unused]] const bool pushed = q.try_push(i);
+      CX_ASSERT(pushed, "");
+    }
+    [[maybe_unused]] const bool overfull = q.try_push(8);
+    CX_ASSERT(!overfull && q.size() == 8, "");
+    CX_ASSERT(q.front() == 0, "");
+    q.pop();
+    int val = -1;
+    [[maybe_unused]] bool popped = q.try_pop(val);
+    CX_ASSERT(popped && val == 1, "");
+    int batch[8] = {10, 11, 12, 13};
+    [[maybe_unused]] const size_t pushedN = q.push_n(batch, 4);
+    CX_ASSERT(pushedN == 2, "Only two slots are free");
+    int out[16];
+    [[maybe_unused]] const size_t poppedN = q.pop_n(out, 16);
+    CX_ASSERT(poppedN == 8 && out[0] == 2 && out[5] == 7 && out[7] == 11, "");
+    popped = q.try_pop(val);
+    CX_ASSERT(q.empty() && !popped, "");
+
+    std::cout << "  Testing non trivial elements..." << std::endl;
+    {
+      SPSCQueue<std::string> s(4);
+      s.emplace(40, 'a');
+      s.push("b");
+      CX_ASSERT(s.front().size() == 40, "");
+      s.pop();
+      s.push("left in queue");
+    }
+
+    std::cout << "  Testing producer and consumer threads..." << std::endl;
+    constexpr int COUNT = 200000;
+    SPSCQueue<int> ring(64);
+    std::thread producer([&] {
+      int chunk[16];
+      for (int i = 0; i < COUNT;) {
+        if (i % 1000 < 500) {
+          ring.push(i++);
+          continue;
+        }
+        const int n = std::min(16, COUNT - i);
+        for (int k = 0; k < n; k++) chunk[k] = i + k;
+        i += (int)ring.push_n(chunk, n);
+      }
+    });
+    int expected = 0;
+    int chunk[32];
+    while (expected < COUNT) {
+      if (expected % 3 == 0) {
+        const size_t n = ring.pop_n(chunk, 32);
+        for (size_t k = 0; k < n; k++) {
+          CX_ASSERT(chunk[k] == expected, "FIFO order");
+          expected++;
+        }
+      } else if (!ring.empty()) {
+        CX_ASSERT(ring.front() == expected, "FIFO order");
+        expected++;
+        ring.pop();
+      }
+    }
+    producer.join();
+    CX_ASSERT(ring.empty(), "");
+  }
+#  endif
+};
+
+/**
+ * @class MPMCQueue
+ * @brief Bounded lock-free ring buffer for any number of producers and consumers (Vyukov style).
+ *
+ * Every slot carries a sequence number that tells whether it is ready to be written (seq == position) or read
+ * (seq == position + 1). Producers and consumers claim positions with a CAS on the tail or head counter and then
+ * publish the slot by advancing its sequence - no thread ever waits on a lock held by a preempted one.
+ * Slots are padded to a cache line so neighbouring producers and consumers do not share lines.<p>
+ * Keeps the {@link Queue} API where it is meaningful with several consumers: push() and emplace() spin while full,
+ * pop(out) spins while empty. There is no front() - another consumer could take the element between front() and
+ * pop(). The try_ variants never wait.<p>
+ * The capacity is rounded up to a power of two.
+ * @tparam T the datatype
+ */
+template <typename T>
+class MPMCQueue {
+  static constexpr size_t CACHE_LINE = 64;
+  struct alignas(CACHE_LINE) Slot {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    [[nodiscard]] inline T* ptr() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  Slot* slots_;
+  size_t mask_;
+  alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+  alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+  char pad_[CACHE_LINE - sizeof(std::atomic<size_t>)]{};
+
+ public:
+  /**
+   * @param capacity the maximum number of elements - rounded up to a power of two
+   */
+  explicit MPMCQueue(size_t capacity = 1024) {
+    size_t len = 2;
+    while (len < capacity) len <<= 1;
+    mask_ = len - 1;
+    slots_ = new Slot[len];
+    for (size_t i = 0; i < len; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  MPMCQueue(const MPMCQueue&) = delete;
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+  ~MPMCQueue() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      const size_t tail = tail_.load(std::memory_order_relaxed);
+      for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+        slots_[i & mask_].ptr()->~T();
+      }
+    }
+    delete[] slots_;
+  }
+  /**
+   * Constructs a new element at the back
+   * @return false if the ring is full
+   */
+  template <typename... Args>
+  inline bool try_emplace(Args&&... args) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[pos & mask_];
+      const size_t seq = slot->seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;  // The slot still holds the element from one lap ago
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    ::new (slot->storage) T(std::forward<Args>(args)...);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+  inline bool try_push(const T& e) { return try_emplace(e); }
+  inline bool try_push(T&& e) { return try_emplace(std::move(e)); }
+  /**
+   * Constructs a new element at the back - spins while the ring is full
+   */
+  template <typename... Args>
+  inline void emplace(Args&&... args) {
+    while (!try_emplace(std::forward<Args>(args)...)) {
+      std::this_thread::yield();
+    }
+  }
+  inline void push(const T& e) { emplace(e); }
+  inline void push(T&& e) { emplace(std::move(e)); }
+  /**
+   * Moves the front element out
+   * @return false if the ring is empty
+   */
+  inline bool try_pop(T& out) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &slots_[pos & mask_];
+      const size_t seq = slot->seq.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;  // Not written yet
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    T* elem = slot->ptr();
+    out = std::move(*elem);
+    elem->~T();
+    slot->seq.store(pos + mask_ + 1, std::memory_order_release);  // Ready for the write one lap later
+    return true;
+  }
+  /**
+   * Moves the front element out - spins while the ring is empty
+   */
+  inline void pop(T& out) {
+    while (!try_pop(out)) {
+      std::this_thread::yield();
+    }
+  }
+  /**
+   * @return the number of elements - a snapshot while other threads are active
+   */
+  [[nodiscard]] inline size_t size() const {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+  [[nodiscard]] inline bool empty() const { return size() == 0; }
+  [[nodiscard]] inline size_t capacity() const { return mask_ + 1; }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "MPMC QUEUE TESTS" << std::endl;
+    std::cout << "  Testing single thread..." << std::endl;
+    MPMCQueue<int> q(3);
+    CX_ASSERT(q.capacity() == 4 && q.empty(), "");
+    for (int lap = 0; lap < 3; lap++) {
+      for (int i = 0; i < 4; i++) {
+        [[maybe_unused]] const bool pushed = q.try_push(i);
+        CX_ASSERT(pushed, "");
+      }
+      [[maybe_unused]] const bool overfull = q.try_push(4);
+      CX_ASSERT(!overfull && q.size() == 4, "");
+      int val = -1;
+      for (int i = 0; i < 4; i++) {
+        [[maybe_unused]] const bool popped = q.try_pop(val);
+        CX_ASSERT(popped && val == i, "");
+      }
+      [[maybe_unused]] const bool popped = q.try_pop(val);
+      CX_ASSERT(!popped && q.empty(), "");
+    }
+    {
+      MPMCQueue<std::string> s(4);
+      s.emplace(40, 'a');
+      s.push("left in queue");
+      std::string str;
+      s.pop(str);
+      CX_ASSERT(str.size() == 40, "");
+    }
+
+    std::cout << "  Testing concurrent producers and consumers..." << std::endl;
+    constexpr int THREADS = 3;
+    constexpr int PER_THREAD = 50000;
+    MPMCQueue<int> ring(128);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<int>> received(THREADS);
+    for (int t = 0; t < THREADS; t++) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; i < PER_THREAD; i++) {
+          ring.push(t * PER_THREAD + i);
+        }
+      });
+      threads.emplace_back([&, t] {
+        int val;
+        for (int i = 0; i < PER_THREAD; i++) {
+          ring.pop(val);
+          received[t].push_back(val);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    std::vector<bool> seen(THREADS * PER_THREAD, false);
+    for (const auto& r : received) {
+      [[maybe_unused]] int last[THREADS] = {-1, -1, -1};
+      for (int val : r) {
+        CX_ASSERT(!seen[val], "Element popped twice");
+        seen[val] = true;
+        CX_ASSERT(val > last[val / PER_THREAD], "Elements of one producer stay in order");
+        last[val / PER_THREAD] = val;
+      }
+    }
+    CX_ASSERT(ring.empty(), "");
+  }
+#  endif
+};
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_CONCURRENTQUEUE_H_
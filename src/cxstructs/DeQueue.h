@@ -43,7 +43,8 @@ class DeQueue {
   int_32_cx back_;
 
   inline void grow() {
-    len_ *= 2;
+    const auto old_len = len_;
+    len_ = std::max<uint_32_cx>(len_ * 2, 1);
 
     T* n_arr = alloc.allocate(len_);
 
@@ -65,7 +66,7 @@ class DeQueue {
         std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
       }
     }
-    alloc.deallocate(arr_, len_);
+    alloc.deallocate(arr_, old_len);
 
     arr_ = n_arr;
     front_ = 0;
@@ -134,6 +135,9 @@ class DeQueue {
       : front_(o.front_), len_(o.len_), arr_(o.arr_), size_(o.size_), back_(o.back_) {
     o.arr_ = nullptr;  //avoid double deletion
     o.size_ = 0;
+    o.len_ = 0;
+    o.front_ = 0;
+    o.back_ = -1;
   }
   //move assign operator
   DeQueue& operator=(DeQueue&& o) noexcept {
@@ -153,12 +157,15 @@ class DeQueue {
 
       o.size_ = 0;
       o.arr_ = nullptr;
+      o.len_ = 0;
+      o.front_ = 0;
+      o.back_ = -1;
     }
     return *this;
   }
 
   inline ~DeQueue() {
-    if constexpr (!std::is_trivial_v<T>) {
+    if (!std::is_trivial_v<T> && size_ > 0) {
       uint_32_cx end = (front_ + size_) % len_;
       if (end < front_) {
         for (uint_32_cx i = front_; i < len_; i++) {
@@ -279,7 +286,7 @@ class DeQueue {
    * Clears the queue of all elements
    */
   inline void clear() noexcept {
-    if (!std::is_trivial_v<T>) {
+    if (!std::is_trivial_v<T> && size_ > 0) {
       uint_32_cx end = (front_ + size_) % len_;
       if (end < front_) {
         for (uint_32_cx i = front_; i < len_; i++) {
@@ -339,7 +346,7 @@ class DeQueue {
     bool operator==(const Iterator& other) const { return current == other.current; }
   };
   inline Iterator begin() { return Iterator(arr_, front_, len_); }
-  inline Iterator end() { return Iterator(arr_, (back_ + 1) % len_, len_); }
+  inline Iterator end() { return Iterator(arr_, len_ == 0 ? 0 : (back_ + 1) % len_, len_); }
 #  ifdef CX_INCLUDE_TESTS
 #    include <deque>
   static void TEST() {
@@ -476,6 +483,11 @@ class DeQueue {
 
       dq1.pop_front();
     }
+    // Moved-from deques are empty and reusable
+    dq3.push_front(1);
+    dq3.push_back(2);
+    dq3.push_front(0);
+    CX_ASSERT(dq3.size() == 3 && dq3.front() == 0 && dq3.back() == 2, "");
 
     de_queue.clear();
     std::cout
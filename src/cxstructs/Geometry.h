@@ -24,6 +24,20 @@
 #  include "../cxconfig.h"
 #  include "../cxutil/cxmath.h"
 #  include <algorithm>
+#  include <cstdint>
+#  if defined(__AVX512F__)
+#    include <immintrin.h>
+#    define CX_GEOMETRY_AVX512
+#  elif defined(__AVX2__)
+#    include <immintrin.h>
+#    define CX_GEOMETRY_AVX2
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define CX_GEOMETRY_SSE2
+#  endif
+#  ifdef CX_INCLUDE_TESTS
+#    include <vector>
+#  endif
 
 namespace cxstructs {
 
@@ -33,16 +47,30 @@ class Rect;
 class Sector;
 class Triangle;
 
+/**
+ * Static (CRTP) base of all shapes.<p>
+ * Shapes are plain value types without a vptr (a Rect is 16 bytes) and every test is a direct, inlinable call.
+ * Generic code takes a {@code const Shape<S>&} and dispatches at compile time:
+ * <pre>
+ * template &lt;typename S&gt;
+ * bool hit(const Shape&lt;S&gt;& s, const Point& p) { return s.contains(p); }
+ * </pre>
+ * The derived type has to provide {@code contains} and {@code intersects} for the argument type used
+ */
+template <typename Derived>
 class Shape {
  public:
-  [[nodiscard]] virtual bool contains(const Point& s) const = 0;
-  [[nodiscard]] virtual bool contains(const Rect& s) const = 0;
-  [[nodiscard]] virtual bool contains(const Circle& s) const = 0;
-  [[nodiscard]] virtual bool intersects(const Rect& r) const = 0;
-  [[nodiscard]] virtual bool intersects(const Circle& r) const = 0;
+  template <typename Other>
+  [[nodiscard]] inline bool contains(const Other& o) const {
+    return static_cast<const Derived&>(*this).contains(o);
+  }
+  template <typename Other>
+  [[nodiscard]] inline bool intersects(const Other& o) const {
+    return static_cast<const Derived&>(*this).intersects(o);
+  }
 };
 
-class Rect : public Shape {
+class Rect : public Shape<Rect> {
   float x_;
   float y_;
   float w_;
@@ -61,7 +89,7 @@ class Rect : public Shape {
    * @param r The other rectangle to check for intersection.
    * @return `true` if this rectangle contained with the other rectangle, `false` otherwise.
    */
-  [[nodiscard]] inline bool intersects(const Rect& r) const final {
+  [[nodiscard]] inline bool intersects(const Rect& r) const {
     return !(x_ > r.x_ + r.w_ || x_ + w_ < r.x_ || y_ > r.y_ + r.h_ || y_ + h_ < r.y_);
   }
   /**
@@ -72,22 +100,22 @@ class Rect : public Shape {
    * @param c The circle check for intersection.
    * @return `true` if this rectangle contained with the circle, `false` otherwise.
    */
-  [[nodiscard]] inline bool intersects(const Circle& c) const final;
+  [[nodiscard]] inline bool intersects(const Circle& c) const;
   /**
    * Checks if the given rect is fully contained inside this rectangle.<p>
    * Contained means non-touching
    * @param r the other rect
    * @return true only if r is fully contained
    */
-  [[nodiscard]] inline bool contains(const Rect& r) const final {
+  [[nodiscard]] inline bool contains(const Rect& r) const {
     return !(x_ > r.x_ || y_ > r.y_ || x_ + w_ < r.x_ + r.w_ || y_ + h_ < r.y_ + r.h_);
   }
   template <class PointType>
   [[nodiscard]] inline bool contains(PointType& r) const {
     return !(x_ > r.x() || y_ > r.y() || x_ + w_ < r.x() || y_ + h_ < r.y());
   }
-  [[nodiscard]] inline bool contains(const Circle& p) const final;
-  [[nodiscard]] inline bool contains(const Point& p) const final;
+  [[nodiscard]] inline bool contains(const Circle& p) const;
+  [[nodiscard]] inline bool contains(const Point& p) const;
   /**
  * @brief Getter method for the x position.
  * @return A readable/writable reference to the x position.
@@ -122,7 +150,7 @@ class Rect : public Shape {
   }
 };
 
-class Circle : public Shape {
+class Circle : public Shape<Circle> {
   float x_;
   float y_;
   float r_;
@@ -138,7 +166,7 @@ class Circle : public Shape {
    * @param r The rect check for intersection.
    * @return `true` if this circle contained with the rectangle, `false` otherwise.
    */
-  [[nodiscard]] inline bool intersects(const Rect& r) const final {
+  [[nodiscard]] inline bool intersects(const Rect& r) const {
     float closestX = std::clamp(x_, r.x(), r.x() + r.width());
     float closestY = std::clamp(y_, r.y(), r.y() + r.height());
 
@@ -155,7 +183,7 @@ class Circle : public Shape {
    * @param c The circle check for intersection.
    * @return `true` if this circle contained with the circle, `false` otherwise.
    */
-  [[nodiscard]] inline bool intersects(const Circle& c) const final {
+  [[nodiscard]] inline bool intersects(const Circle& c) const {
     return !(((x_ - c.x_) * (x_ - c.x_) + (y_ - c.y_) * (y_ - c.y_)) > (r_ * c.r_ + r_ * c.r_));
   }
   /**
@@ -164,16 +192,16 @@ class Circle : public Shape {
    * @param c the other circle
    * @return true only if c is fully contained
    */
-  [[nodiscard]] inline bool contains(const Circle& c) const final {
+  [[nodiscard]] inline bool contains(const Circle& c) const {
     return ((x_ - c.x_) * (x_ - c.x_) + (y_ - c.y_) * (y_ - c.y_)) < (r_ - c.r_) * (r_ - c.r_);
   }
-  [[nodiscard]] bool contains(const Rect& r) const final {
+  [[nodiscard]] bool contains(const Rect& r) const {
     float dx = std::max(0.0f, std::max(r.x() - x_, x_ - (r.x() + r.width())));
     float dy = std::max(0.0f, std::max(r.y() - y_, y_ - (r.y() + r.height())));
 
     return (dx * dx + dy * dy) <= (r_ * r_);
   }
-  [[nodiscard]] inline bool contains(const Point& p) const final;
+  [[nodiscard]] inline bool contains(const Point& p) const;
   /**
  * @brief Getter method for the x position.
  * @return A readable/writable reference to the x position.
@@ -333,7 +361,7 @@ struct PointT {
     return {(float)pointI.x, (float)pointI.y};
   }
 };
-class Sector : public Shape {
+class Sector : public Shape<Sector> {
   float radius_;
   float start_angle_;
   float end_angle;
@@ -384,6 +412,152 @@ bool Circle::contains(const Point& p) const {
   return ((x_ - p.x()) * (x_ - p.x()) + (y_ - p.y()) * (y_ - p.y()) < r_ * r_);
 }
 
+static_assert(sizeof(Rect) == 4 * sizeof(float), "shapes must not carry a vptr");
+static_assert(sizeof(Circle) == 3 * sizeof(float), "shapes must not carry a vptr");
+
+/**
+ * Tests {@code query} against n rects stored as structure-of-arrays (one array per component).<p>
+ * Bit i of {@code mask[i / 64]} is set if rect i intersects the query, with the same (touching counts)
+ * semantics as {@link Rect::intersects}. {@code mask} has to hold (n + 63) / 64 words; unused bits are cleared.<p>
+ * Runs 16 rects per step with AVX-512, 8 with AVX2, 4 with SSE2 and falls back to a scalar loop otherwise
+ *
+ * @param query the query rect
+ * @param xs x positions
+ * @param ys y positions
+ * @param ws widths
+ * @param hs heights
+ * @param n number of rects
+ * @param mask output bitmask
+ */
+inline void intersects_many(const Rect& query, const float* xs, const float* ys, const float* ws, const float* hs,
+                            uint_32_cx n, uint64_t* mask) {
+  const float qx = query.x();
+  const float qy = query.y();
+  const float qr = qx + query.width();
+  const float qb = qy + query.height();
+  std::fill(mask, mask + (n + 63) / 64, 0);
+  uint_32_cx i = 0;
+#  if defined(CX_GEOMETRY_AVX512)
+  const __m512 vqx = _mm512_set1_ps(qx);
+  const __m512 vqy = _mm512_set1_ps(qy);
+  const __m512 vqr = _mm512_set1_ps(qr);
+  const __m512 vqb = _mm512_set1_ps(qb);
+  for (; i + 16 <= n; i += 16) {
+    const __m512 x = _mm512_loadu_ps(xs + i);
+    const __m512 y = _mm512_loadu_ps(ys + i);
+    const __mmask16 apart = _mm512_cmp_ps_mask(vqx, _mm512_add_ps(x, _mm512_loadu_ps(ws + i)), _CMP_GT_OQ)
+                            | _mm512_cmp_ps_mask(vqr, x, _CMP_LT_OQ)
+                            | _mm512_cmp_ps_mask(vqy, _mm512_add_ps(y, _mm512_loadu_ps(hs + i)), _CMP_GT_OQ)
+                            | _mm512_cmp_ps_mask(vqb, y, _CMP_LT_OQ);
+    mask[i >> 6] |= static_cast<uint64_t>(static_cast<uint16_t>(~apart)) << (i & 63);
+  }
+#  elif defined(CX_GEOMETRY_AVX2)
+  const __m256 vqx = _mm256_set1_ps(qx);
+  const __m256 vqy = _mm256_set1_ps(qy);
+  const __m256 vqr = _mm256_set1_ps(qr);
+  const __m256 vqb = _mm256_set1_ps(qb);
+  for (; i + 8 <= n; i += 8) {
+    const __m256 x = _mm256_loadu_ps(xs + i);
+    const __m256 y = _mm256_loadu_ps(ys + i);
+    const __m256 apart = _mm256_or_ps(
+        _mm256_or_ps(_mm256_cmp_ps(vqx, _mm256_add_ps(x, _mm256_loadu_ps(ws + i)), _CMP_GT_OQ),
+                     _mm256_cmp_ps(vqr, x, _CMP_LT_OQ)),
+        _mm256_or_ps(_mm256_cmp_ps(vqy, _mm256_add_ps(y, _mm256_loadu_ps(hs + i)), _CMP_GT_OQ),
+                     _mm256_cmp_ps(vqb, y, _CMP_LT_OQ)));
+    const auto hits = static_cast<uint64_t>(~_mm256_movemask_ps(apart) & 0xFF);
+    mask[i >> 6] |= hits << (i & 63);
+  }
+#  elif defined(CX_GEOMETRY_SSE2)
+  const __m128 vqx = _mm_set1_ps(qx);
+  const __m128 vqy = _mm_set1_ps(qy);
+  const __m128 vqr = _mm_set1_ps(qr);
+  const __m128 vqb = _mm_set1_ps(qb);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 x = _mm_loadu_ps(xs + i);
+    const __m128 y = _mm_loadu_ps(ys + i);
+    const __m128 apart =
+        _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(vqx, _mm_add_ps(x, _mm_loadu_ps(ws + i))), _mm_cmplt_ps(vqr, x)),
+                  _mm_or_ps(_mm_cmpgt_ps(vqy, _mm_add_ps(y, _mm_loadu_ps(hs + i))), _mm_cmplt_ps(vqb, y)));
+    const auto hits = static_cast<uint64_t>(~_mm_movemask_ps(apart) & 0xF);
+    mask[i >> 6] |= hits << (i & 63);
+  }
+#  endif
+  // Scalar path: branch-free tests, one store per mask word
+  while (i < n) {
+    const uint_32_cx end = std::min<uint_32_cx>(n, (i | 63) + 1);
+    uint64_t bits = 0;
+    for (; i < end; ++i) {
+      const bool hit = !((qx > xs[i] + ws[i]) | (qr < xs[i]) | (qy > ys[i] + hs[i]) | (qb < ys[i]));
+      bits |= static_cast<uint64_t>(hit) << (i & 63);
+    }
+    mask[(end - 1) >> 6] |= bits;
+  }
+}
+
+/**
+ * Tests which of n points (structure-of-arrays) lie inside {@code circle}.<p>
+ * Bit i of {@code mask[i / 64]} is set if point i is contained, with the same (non-touching) semantics as
+ * {@link Circle::contains}. {@code mask} has to hold (n + 63) / 64 words; unused bits are cleared.<p>
+ * Runs 16 points per step with AVX-512, 8 with AVX2, 4 with SSE2 and falls back to a scalar loop otherwise
+ *
+ * @param circle the circle
+ * @param xs x positions
+ * @param ys y positions
+ * @param n number of points
+ * @param mask output bitmask
+ */
+inline void contains_points(const Circle& circle, const float* xs, const float* ys, uint_32_cx n, uint64_t* mask) {
+  const float cx = circle.x();
+  const float cy = circle.y();
+  const float rSqr = circle.radius() * circle.radius();
+  std::fill(mask, mask + (n + 63) / 64, 0);
+  uint_32_cx i = 0;
+#  if defined(CX_GEOMETRY_AVX512)
+  const __m512 vcx = _mm512_set1_ps(cx);
+  const __m512 vcy = _mm512_set1_ps(cy);
+  const __m512 vr = _mm512_set1_ps(rSqr);
+  for (; i + 16 <= n; i += 16) {
+    const __m512 dx = _mm512_sub_ps(vcx, _mm512_loadu_ps(xs + i));
+    const __m512 dy = _mm512_sub_ps(vcy, _mm512_loadu_ps(ys + i));
+    const __m512 dist = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy));
+    const __mmask16 inside = _mm512_cmp_ps_mask(dist, vr, _CMP_LT_OQ);
+    mask[i >> 6] |= static_cast<uint64_t>(inside) << (i & 63);
+  }
+#  elif defined(CX_GEOMETRY_AVX2)
+  const __m256 vcx = _mm256_set1_ps(cx);
+  const __m256 vcy = _mm256_set1_ps(cy);
+  const __m256 vr = _mm256_set1_ps(rSqr);
+  for (; i + 8 <= n; i += 8) {
+    const __m256 dx = _mm256_sub_ps(vcx, _mm256_loadu_ps(xs + i));
+    const __m256 dy = _mm256_sub_ps(vcy, _mm256_loadu_ps(ys + i));
+    const __m256 dist = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+    const auto inside = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(dist, vr, _CMP_LT_OQ)));
+    mask[i >> 6] |= inside << (i & 63);
+  }
+#  elif defined(CX_GEOMETRY_SSE2)
+  const __m128 vcx = _mm_set1_ps(cx);
+  const __m128 vcy = _mm_set1_ps(cy);
+  const __m128 vr = _mm_set1_ps(rSqr);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 dx = _mm_sub_ps(vcx, _mm_loadu_ps(xs + i));
+    const __m128 dy = _mm_sub_ps(vcy, _mm_loadu_ps(ys + i));
+    const __m128 dist = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+    const auto inside = static_cast<uint64_t>(_mm_movemask_ps(_mm_cmplt_ps(dist, vr)));
+    mask[i >> 6] |= inside << (i & 63);
+  }
+#  endif
+  while (i < n) {
+    const uint_32_cx end = std::min<uint_32_cx>(n, (i | 63) + 1);
+    uint64_t bits = 0;
+    for (; i < end; ++i) {
+      const float dx = cx - xs[i];
+      const float dy = cy - ys[i];
+      bits |= static_cast<uint64_t>(dx * dx + dy * dy < rSqr) << (i & 63);
+    }
+    mask[(end - 1) >> 6] |= bits;
+  }
+}
+
 }  // namespace cxstructs
 namespace std {
 template <>
@@ -524,6 +698,53 @@ static void GEOMETRY_TEST() {
   Point p4(15.0, 5.0);
 
   // Point p3 is inside Circle c8
+
+  std::cout << "  Testing batch kernels against scalar tests..." << std::endl;
+  const uint_32_cx n = 1000 + 13;
+  std::vector<float> xs(n), ys(n), ws(n), hs(n);
+  std::vector<uint64_t> mask((n + 63) / 64, ~0ULL);
+  uint32_t seed = 12345;
+  auto next = [&seed](uint32_t mod) {
+    seed = seed * 1103515245U + 12345U;
+    return static_cast<float>((seed >> 8) % mod);
+  };
+  for (uint_32_cx i = 0; i < n; i++) {
+    xs[i] = next(200);
+    ys[i] = next(200);
+    ws[i] = next(20);
+    hs[i] = next(20);
+  }
+  Rect query(50, 60, 40, 30);
+  intersects_many(query, xs.data(), ys.data(), ws.data(), hs.data(), n, mask.data());
+  uint_32_cx hits = 0;
+  for (uint_32_cx i = 0; i < n; i++) {
+    const bool bit = (mask[i / 64] >> (i % 64)) & 1;
+    CX_ASSERT(bit == query.intersects(Rect(xs[i], ys[i], ws[i], hs[i])), "");
+    hits += bit;
+  }
+  CX_ASSERT(hits > 0 && hits < n, "");
+  CX_ASSERT((mask.back() >> (n % 64)) == 0, "tail bits are cleared");
+
+  Circle circle(100, 100, 30);
+  contains_points(circle, xs.data(), ys.data(), n, mask.data());
+  hits = 0;
+  for (uint_32_cx i = 0; i < n; i++) {
+    const bool bit = (mask[i / 64] >> (i % 64)) & 1;
+    CX_ASSERT(bit == circle.contains(Point(xs[i], ys[i])), "");
+    hits += bit;
+  }
+  CX_ASSERT(hits > 0 && hits < n, "");
+
+  uint64_t single = ~0ULL;
+  intersects_many(query, xs.data(), ys.data(), ws.data(), hs.data(), 5, &single);
+  CX_ASSERT((single >> 5) == 0, "");
+  single = 0xDEADBEEFULL;
+  contains_points(circle, xs.data(), ys.data(), 0, &single);
+  CX_ASSERT(single == 0xDEADBEEFULL, "n == 0 writes nothing");
+
+  [[maybe_unused]] const Shape<Rect>& shape = query;
+  CX_ASSERT(shape.intersects(Rect(60, 70, 1, 1)), "");
+  CX_ASSERT(shape.contains(Point(55, 65)), "");
 }
 #  endif
 }  // namespace std
@@ -196,6 +196,21 @@ struct HashLinkedList {
     }
     return false;
   }
+  inline V* find(const K& key) {
+    for (uint_16_cx i = 0; i < ArrayLength; i++) {
+      if (data_[i].assigned() && data_[i].first() == key) {
+        return &data_[i].second();
+      }
+    }
+    HListNode* it = head_;
+    while (it) {
+      if (it->key_ == key) {
+        return &it->value_;
+      }
+      it = it->next_;
+    }
+    return nullptr;
+  }
   inline bool contains(const K& key) {
     for (uint_fast32_t i = 0; i < ArrayLength; i++) {
       if (data_[i].assigned() && data_[i].first() == key) {
@@ -312,7 +327,7 @@ class HashMap {
         arr_(new HList[next_power_of_2(initialCapacity)]),
         maxSize(next_power_of_2(initialCapacity) * loadFactor), hash_func_(hash_function),
         load_factor_(loadFactor) {}
-  HashMap(const HashMap<K, V>& o)
+  HashMap(const HashMap& o)
       : initialCapacity_(o.initialCapacity_), size_(o.size_), buckets_(o.buckets_),
         hash_func_(o.hash_func_), maxSize(o.maxSize), load_factor_(o.load_factor_) {
     arr_ = new HList[buckets_];
@@ -320,14 +335,14 @@ class HashMap {
       arr_[i] = o.arr_[i];
     }
   }
-  HashMap(HashMap<K, V>&& o) noexcept
+  HashMap(HashMap&& o) noexcept
       : initialCapacity_(o.initialCapacity_), size_(o.size_), buckets_(o.buckets_),
         hash_func_(std::move(o.hash_func_)), maxSize(o.maxSize), load_factor_(o.load_factor_),
         arr_(o.arr_) {
     o.arr_ = nullptr;
     o.size_ = 0;
   }
-  HashMap& operator=(const HashMap<K, V>& o) {
+  HashMap& operator=(const HashMap& o) {
     if (this != &o) {
       delete[] arr_;
 
@@ -344,7 +359,7 @@ class HashMap {
     }
     return *this;
   }
-  HashMap& operator=(HashMap<K, V>&& o) noexcept {
+  HashMap& operator=(HashMap&& o) noexcept {
     if (this != &o) {
       delete[] arr_;
 
@@ -388,6 +403,14 @@ class HashMap {
   [[nodiscard]] inline V& at(const K& key) const {
     return arr_[hash_func_(key) & (buckets_ - 1)].at(key);
   }
+  /**
+   * Looks up the value for the given key without throwing
+   * @param key - the key to the value
+   * @return pointer to the value at this key or nullptr if the key doesnt exist
+   */
+  [[nodiscard]] inline V* find(const K& key) const {
+    return arr_[hash_func_(key) & (buckets_ - 1)].find(key);
+  }
   /**
    * Removes this key, value Pair from the hashmap
    * @param key - they key to be removed
@@ -465,6 +488,7 @@ class HashMap {
     } catch (const std::exception& e) {
       CX_ASSERT(true, "");
     }
+    CX_ASSERT(map1.find(1) == nullptr && *map1.find(2) == "Two", "");
 
     // Test copy constructor
     std::cout << "  Testing copy constructor..." << std::endl;
@@ -0,0 +1,422 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_INTRUSIVELIST_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_INTRUSIVELIST_H_
+
+#  include "../cxconfig.h"
+#  include <cstddef>
+#  include <cstdint>
+#  include <iterator>
+#  include <type_traits>
+#  ifdef CX_INCLUDE_TESTS
+#    include <algorithm>
+#    include <iostream>
+#    include <string>
+#    include <vector>
+#  endif
+
+namespace cxstructs {
+/**
+ * Link embedded into the elements of an IntrusiveList<p>
+ * Copying an element does not copy its membership - the copy starts out unlinked.
+ */
+struct IntrusiveListHook {
+  IntrusiveListHook* next_ = nullptr;
+  IntrusiveListHook* previous_ = nullptr;
+
+  IntrusiveListHook() noexcept = default;
+  IntrusiveListHook(const IntrusiveListHook&) noexcept {}
+  IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept { return *this; }
+
+  /**
+   * @return true if the element is currently in a list
+   */
+  [[nodiscard]] inline bool is_linked() const noexcept { return next_ != nullptr; }
+};
+}  // namespace cxstructs
+
+namespace cxhelper {
+/**
+ * Byte offset of the hook member inside T - computed once on an uninitialized probe object
+ */
+template <typename T, cxstructs::IntrusiveListHook T::*Hook>
+inline std::ptrdiff_t hook_offset() noexcept {
+  static const std::ptrdiff_t offset = [] {
+    alignas(T) static unsigned char probe[sizeof(T)];
+    const T* object = reinterpret_cast<const T*>(probe);
+    return reinterpret_cast<const unsigned char*>(&(object->*Hook)) - probe;
+  }();
+  return offset;
+}
+}  // namespace cxhelper
+
+namespace cxstructs {
+/**
+ * <h2>Intrusive List</h2>
+ * A doubly linked list that does not own or allocate anything - the links live in an {@link IntrusiveListHook}
+ * member of the elements themselves.<p>
+ * Compared to the DoubleLinkedList there is no node allocation per value, no extra indirection on traversal
+ * and any element can be unlinked in O(1) given only a reference to it.
+ * This makes it the building block for LRU lists, free lists and schedulers where elements move between lists.
+ * <p>
+ * The list only links the elements - they must outlive their membership and must not move while linked.
+ * An element can be in one list per hook member.
+ * <pre>{@code
+ * struct Job {
+ *   int id;
+ *   IntrusiveListHook hook_;
+ * };
+ * IntrusiveList<Job, &Job::hook_> queue;
+ * }</pre>
+ * @tparam T element type
+ * @tparam Hook pointer to the hook member of T
+ */
+template <typename T, IntrusiveListHook T::*Hook>
+class IntrusiveList {
+  IntrusiveListHook head_;  // sentinel - the list is circular through it
+  uint_32_cx size_ = 0;
+
+  static inline IntrusiveListHook* hook(T& value) noexcept { return &(value.*Hook); }
+  static inline T* owner(IntrusiveListHook* link) noexcept {
+    return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(link) - cxhelper::hook_offset<T, Hook>());
+  }
+  static inline const T* owner(const IntrusiveListHook* link) noexcept {
+    return reinterpret_cast<const T*>(reinterpret_cast<const unsigned char*>(link) -
+                                      cxhelper::hook_offset<T, Hook>());
+  }
+  inline void link_before(IntrusiveListHook* pos, IntrusiveListHook* link) noexcept {
+    CX_ASSERT(!link->is_linked(), "element is already linked");
+    link->next_ = pos;
+    link->previous_ = pos->previous_;
+    pos->previous_->next_ = link;
+    pos->previous_ = link;
+    size_++;
+  }
+  inline void unlink(IntrusiveListHook* link) noexcept {
+    link->previous_->next_ = link->next_;
+    link->next_->previous_ = link->previous_;
+    link->next_ = link->previous_ = nullptr;
+    size_--;
+  }
+  inline void take(IntrusiveList& o) noexcept {
+    if (o.size_ == 0) {
+      head_.next_ = head_.previous_ = &head_;
+      size_ = 0;
+      return;
+    }
+    head_.next_ = o.head_.next_;
+    head_.previous_ = o.head_.previous_;
+    head_.next_->previous_ = &head_;
+    head_.previous_->next_ = &head_;
+    size_ = o.size_;
+    o.head_.next_ = o.head_.previous_ = &o.head_;
+    o.size_ = 0;
+  }
+
+ public:
+  template <bool Const>
+  class IteratorBase {
+    friend class IntrusiveList;
+    using LinkPtr = std::conditional_t<Const, const IntrusiveListHook*, IntrusiveListHook*>;
+    LinkPtr link_;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    IteratorBase() noexcept : link_(nullptr) {}
+    explicit IteratorBase(LinkPtr link) noexcept : link_(link) {}
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    IteratorBase(const IteratorBase<false>& o) noexcept  // NOLINT(*-explicit-constructor)
+        : link_(o.link_) {}
+
+    inline reference operator*() const noexcept { return *owner(link_); }
+    inline pointer operator->() const noexcept { return owner(link_); }
+    inline IteratorBase& operator++() noexcept {
+      link_ = link_->next_;
+      return *this;
+    }
+    inline IteratorBase operator++(int) noexcept {
+      IteratorBase copy = *this;
+      link_ = link_->next_;
+      return copy;
+    }
+    inline IteratorBase& operator--() noexcept {
+      link_ = link_->previous_;
+      return *this;
+    }
+    inline IteratorBase operator--(int) noexcept {
+      IteratorBase copy = *this;
+      link_ = link_->previous_;
+      return copy;
+    }
+    inline bool operator==(const IteratorBase& o) const noexcept { return link_ == o.link_; }
+    inline bool operator!=(const IteratorBase& o) const noexcept { return link_ != o.link_; }
+
+    template <bool>
+    friend class IteratorBase;
+  };
+  using iterator = IteratorBase<false>;
+  using const_iterator = IteratorBase<true>;
+
+  IntrusiveList() noexcept { head_.next_ = head_.previous_ = &head_; }
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+  IntrusiveList(IntrusiveList&& o) noexcept { take(o); }
+  IntrusiveList& operator=(IntrusiveList&& o) noexcept {
+    if (this != &o) {
+      clear();
+      take(o);
+    }
+    return *this;
+  }
+  /**
+   * Unlinks all elements - they are not destroyed
+   */
+  ~IntrusiveList() { clear(); }
+
+  /**
+   * Links the element at the end of the list - O(1)
+   * @param value element that is not linked into a list with this hook
+   */
+  inline void push_back(T& value) noexcept { link_before(&head_, hook(value)); }
+  /**
+   * Links the element at the front of the list - O(1)
+   * @param value element that is not linked into a list with this hook
+   */
+  inline void push_front(T& value) noexcept { link_before(head_.next_, hook(value)); }
+  /**
+   * Unlinks the last element - O(1)
+   * @return the unlinked element
+   */
+  inline T& pop_back() noexcept {
+    CX_ASSERT(size_ > 0, "pop on empty list");
+    IntrusiveListHook* link = head_.previous_;
+    unlink(link);
+    return *owner(link);
+  }
+  /**
+   * Unlinks the first element - O(1)
+   * @return the unlinked element
+   */
+  inline T& pop_front() noexcept {
+    CX_ASSERT(size_ > 0, "pop on empty list");
+    IntrusiveListHook* link = head_.next_;
+    unlink(link);
+    return *owner(link);
+  }
+  /**
+   * Links the element before the given position - O(1)
+   * @return iterator to the inserted element
+   */
+  inline iterator insert(iterator pos, T& value) noexcept {
+    link_before(pos.link_, hook(value));
+    return iterator(hook(value));
+  }
+  /**
+   * Unlinks the element at the given position - O(1)
+   * @return iterator to the element after it
+   */
+  inline iterator erase(iterator pos) noexcept {
+    CX_ASSERT(pos.link_ != &head_, "erase of end()");
+    IntrusiveListHook* next = pos.link_->next_;
+    unlink(pos.link_);
+    return iterator(next);
+  }
+  /**
+   * Unlinks the given element from this list - O(1)
+   * @param value element that is linked into <b>this</b> list
+   */
+  inline void erase(T& value) noexcept {
+    CX_ASSERT(hook(value)->is_linked(), "element is not linked");
+    unlink(hook(value));
+  }
+  /**
+   * Moves an element of this list to the front - O(1)
+   */
+  inline void move_to_front(T& value) noexcept {
+    IntrusiveListHook* link = hook(value);
+    if (head_.next_ != link) {
+      unlink(link);
+      link_before(head_.next_, link);
+    }
+  }
+  /**
+   * Moves an element of this list to the back - O(1)
+   */
+  inline void move_to_back(T& value) noexcept {
+    IntrusiveListHook* link = hook(value);
+    if (head_.previous_ != link) {
+      unlink(link);
+      link_before(&head_, link);
+    }
+  }
+  /**
+   * Moves all elements of the other list before pos - O(1)
+   */
+  inline void splice(iterator pos, IntrusiveList& o) noexcept {
+    if (o.size_ == 0 || &o == this) {
+      return;
+    }
+    IntrusiveListHook* first = o.head_.next_;
+    IntrusiveListHook* last = o.head_.previous_;
+    IntrusiveListHook* before = pos.link_->previous_;
+    before->next_ = first;
+    first->previous_ = before;
+    last->next_ = pos.link_;
+    pos.link_->previous_ = last;
+    size_ += o.size_;
+    o.head_.next_ = o.head_.previous_ = &o.head_;
+    o.size_ = 0;
+  }
+  /**
+   * Unlinks all elements - O(n) as every hook is reset
+   */
+  inline void clear() noexcept {
+    IntrusiveListHook* link = head_.next_;
+    while (link != &head_) {
+      IntrusiveListHook* next = link->next_;
+      link->next_ = link->previous_ = nullptr;
+      link = next;
+    }
+    head_.next_ = head_.previous_ = &head_;
+    size_ = 0;
+  }
+  /**
+   * @return an iterator pointing at the given element of this list - O(1)
+   */
+  [[nodiscard]] inline iterator iterator_to(T& value) noexcept { return iterator(hook(value)); }
+  [[nodiscard]] inline T& front() noexcept { return *owner(head_.next_); }
+  [[nodiscard]] inline const T& front() const noexcept { return *owner(head_.next_); }
+  [[nodiscard]] inline T& back() noexcept { return *owner(head_.previous_); }
+  [[nodiscard]] inline const T& back() const noexcept { return *owner(head_.previous_); }
+  [[nodiscard]] inline uint_32_cx size() const noexcept { return size_; }
+  [[nodiscard]] inline bool empty() const noexcept { return size_ == 0; }
+  /**
+   * @return true if the element is linked into a list with this hook
+   */
+  [[nodiscard]] static inline bool is_linked(const T& value) noexcept { return (value.*Hook).is_linked(); }
+
+  inline iterator begin() noexcept { return iterator(head_.next_); }
+  inline iterator end() noexcept { return iterator(&head_); }
+  inline const_iterator begin() const noexcept { return const_iterator(head_.next_); }
+  inline const_iterator end() const noexcept { return const_iterator(&head_); }
+
+};
+
+}  // namespace cxstructs
+
+#  ifdef CX_INCLUDE_TESTS
+namespace cxtests {
+using namespace cxstructs;
+
+static void TEST_INTRUSIVE_LIST() {
+  std::cout << "TESTING INTRUSIVE LIST\n";
+  struct Node {
+    int id = 0;
+    std::string payload;
+    IntrusiveListHook hook_;
+    IntrusiveListHook other_;
+  };
+  using List = IntrusiveList<Node, &Node::hook_>;
+
+  std::cout << "   Testing push and pop...\n";
+  std::vector<Node> nodes(100);
+  std::vector<int> reference;
+  List list;
+  for (int i = 0; i < 100; i++) {
+    nodes[i].id = i;
+    nodes[i].payload = std::string(20, 'a');
+    if (i % 2 == 0) {
+      list.push_back(nodes[i]);
+      reference.push_back(i);
+    } else {
+      list.push_front(nodes[i]);
+      reference.insert(reference.begin(), i);
+    }
+  }
+  CX_ASSERT(list.size() == 100 && list.front().id == 99 && list.back().id == 98, "");
+  [[maybe_unused]] Node& popped = list.pop_front();
+  CX_ASSERT(&popped == &nodes[99] && !List::is_linked(nodes[99]), "");
+  [[maybe_unused]] Node& poppedBack = list.pop_back();
+  CX_ASSERT(&poppedBack == &nodes[98] && list.size() == 98, "");
+  reference.erase(reference.begin());
+  reference.pop_back();
+
+  std::cout << "   Testing unlink from the middle...\n";
+  for (int i = 0; i < 98; i += 3) {
+    list.erase(nodes[i]);
+    reference.erase(std::find(reference.begin(), reference.end(), i));
+  }
+  CX_ASSERT(list.size() == reference.size(), "");
+  [[maybe_unused]] uint_32_cx index = 0;
+  for ([[maybe_unused]] const Node& node : list) {
+    CX_ASSERT(node.id == reference[index++], "");
+  }
+
+  std::cout << "   Testing move to front/back and iterators...\n";
+  List small;
+  for (int i = 0; i < 5; i++) {
+    if (List::is_linked(nodes[i])) list.erase(nodes[i]);
+    small.push_back(nodes[i]);
+  }
+  small.move_to_front(nodes[3]);
+  small.move_to_back(nodes[0]);
+  [[maybe_unused]] const int order[] = {3, 1, 2, 4, 0};
+  index = 0;
+  for (auto it = small.begin(); it != small.end(); ++it) {
+    CX_ASSERT(it->id == order[index++], "");
+  }
+  auto it = small.end();
+  for (int i = 4; i >= 0; i--) {
+    --it;
+    CX_ASSERT(it->id == order[i], "");
+  }
+  it = small.erase(small.iterator_to(nodes[2]));
+  CX_ASSERT(it->id == 4 && small.size() == 4, "");
+  small.insert(it, nodes[2]);
+  CX_ASSERT(std::next(small.begin(), 2)->id == 2, "");
+
+  std::cout << "   Testing second hook, splice and move...\n";
+  IntrusiveList<Node, &Node::other_> all;
+  for (auto& node : nodes) all.push_back(node);
+  CX_ASSERT(all.size() == 100 && List::is_linked(nodes[3]), "");
+  [[maybe_unused]] const uint_32_cx total = list.size() + small.size();
+  list.splice(list.begin(), small);
+  CX_ASSERT(small.empty() && list.size() == total && list.front().id == 3, "");
+  List moved = std::move(list);
+  CX_ASSERT(list.empty() && moved.size() == total && moved.back().id == reference.back(), "");
+  list.push_back(nodes[99]);
+  moved.clear();
+  CX_ASSERT(!List::is_linked(nodes[3]) && moved.empty() && list.size() == 1, "");
+  index = 0;
+  for ([[maybe_unused]] const Node& node : all) {
+    CX_ASSERT(node.id == (int)index++, "");
+  }
+  Node copy = nodes[5];
+  CX_ASSERT(!copy.hook_.is_linked() && !copy.other_.is_linked(), "");
+}
+}  // namespace cxtests
+#  endif
+#endif  // CXSTRUCTS_SRC_CXSTRUCTS_INTRUSIVELIST_H_
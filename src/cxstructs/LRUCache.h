@@ -0,0 +1,476 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_LRUCACHE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_LRUCACHE_H_
+
+#  include "../cxconfig.h"
+#  include <cstdint>
+#  include <functional>
+#  include <memory>
+#  include <mutex>
+#  include <optional>
+#  include <utility>
+#  include <vector>
+#  include "HashMap.h"
+#  include "IntrusiveList.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <algorithm>
+#    include <atomic>
+#    include <iostream>
+#    include <string>
+#    include <thread>
+#  endif
+
+namespace cxhelper {
+/**
+ * Entry of an LRUCache - linked into the recency list through its hook
+ */
+template <typename K, typename V>
+struct LRUEntry {
+  cxstructs::IntrusiveListHook hook_;
+  K key_;
+  V value_;
+
+  template <typename... Args>
+  explicit LRUEntry(const K& key, Args&&... args) : key_(key), value_(std::forward<Args>(args)...) {}
+};
+}  // namespace cxhelper
+
+namespace cxstructs {
+/**
+ * <h2>LRU Cache</h2>
+ * A fixed capacity key-value cache that evicts the least recently used entry when full.<p>
+ * The entries are constructed in a slot array that is allocated once - get, put and evict only relink
+ * entries in an {@link IntrusiveList} ordered by recency and look them up through a {@link HashMap}.
+ * All operations are O(1) and a cache touch never allocates.
+ * The map is sized to twice the capacity so it never rehashes - only keys whose bucket already holds another key
+ * take an overflow node on insert.
+ * <p>
+ * Pointers and references to values stay valid until the entry is evicted or erased.
+ * Not thread safe - use the {@link ShardedLRUCache} for concurrent access.
+ * @tparam K key type
+ * @tparam V value type
+ * @tparam Hash hash function for the keys
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LRUCache {
+  using Entry = cxhelper::LRUEntry<K, V>;
+  union Slot {
+    Slot* nextFree_;
+    Entry entry_;
+
+    Slot() noexcept : nextFree_(nullptr) {}
+    ~Slot() {}
+  };
+
+  Slot* slots_;
+  Slot* free_;
+  uint_32_cx capacity_;
+  IntrusiveList<Entry, &Entry::hook_> order_;  // most recently used at the front
+  HashMap<K, Entry*, Hash> map_;
+
+  inline void link_free_slots() noexcept {
+    free_ = nullptr;
+    for (uint_32_cx i = capacity_; i > 0; i--) {
+      slots_[i - 1].nextFree_ = free_;
+      free_ = &slots_[i - 1];
+    }
+  }
+  inline void destroy_entries() noexcept {
+    while (!order_.empty()) {
+      order_.pop_front().~Entry();
+    }
+  }
+  inline void release(Entry& entry) noexcept {
+    entry.~Entry();
+    auto* slot = reinterpret_cast<Slot*>(&entry);
+    slot->nextFree_ = free_;
+    free_ = slot;
+  }
+
+ public:
+  /**
+   * @param capacity maximum number of entries - all slots are allocated up front
+   * @param hash hash function for the keys
+   */
+  explicit LRUCache(uint_32_cx capacity, Hash hash = Hash())
+      : slots_(new Slot[capacity]), free_(nullptr), capacity_(capacity), map_(std::move(hash), capacity * 2) {
+    CX_ASSERT(capacity > 0, "capacity must be positive");
+    link_free_slots();
+  }
+  LRUCache(const LRUCache&) = delete;
+  LRUCache& operator=(const LRUCache&) = delete;
+  LRUCache(LRUCache&& o) noexcept
+      : slots_(o.slots_), free_(o.free_), capacity_(o.capacity_), order_(std::move(o.order_)),
+        map_(std::move(o.map_)) {
+    o.slots_ = o.free_ = nullptr;
+    o.capacity_ = 0;
+  }
+  LRUCache& operator=(LRUCache&& o) noexcept {
+    if (this != &o) {
+      destroy_entries();
+      delete[] slots_;
+      slots_ = o.slots_;
+      free_ = o.free_;
+      capacity_ = o.capacity_;
+      order_ = std::move(o.order_);
+      map_ = std::move(o.map_);
+      o.slots_ = o.free_ = nullptr;
+      o.capacity_ = 0;
+    }
+    return *this;
+  }
+  ~LRUCache() {
+    destroy_entries();
+    delete[] slots_;
+  }
+
+  /**
+   * Looks up the value and marks it as most recently used - O(1)
+   * @return pointer to the cached value or nullptr on a miss
+   */
+  [[nodiscard]] inline V* get(const K& key) noexcept {
+    Entry** entry = map_.find(key);
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    order_.move_to_front(**entry);
+    return &(*entry)->value_;
+  }
+  /**
+   * Looks up the value without changing the eviction order - O(1)
+   * @return pointer to the cached value or nullptr on a miss
+   */
+  [[nodiscard]] inline V* peek(const K& key) const noexcept {
+    Entry** entry = map_.find(key);
+    return entry == nullptr ? nullptr : &(*entry)->value_;
+  }
+  [[nodiscard]] inline bool contains(const K& key) const noexcept { return map_.find(key) != nullptr; }
+  /**
+   * Inserts or replaces the value for the key and marks it as most recently used - O(1)<p>
+   * When the cache is full the least recently used entry is evicted and its slot reused.
+   * @param args arguments to construct the value from
+   * @return reference to the cached value
+   */
+  template <typename... Args>
+  inline V& put(const K& key, Args&&... args) {
+    Entry** existing = map_.find(key);
+    if (existing != nullptr) {
+      Entry& entry = **existing;
+      entry.value_ = V(std::forward<Args>(args)...);
+      order_.move_to_front(entry);
+      return entry.value_;
+    }
+    if (free_ == nullptr) {
+      Entry& victim = order_.pop_back();
+      map_.erase(victim.key_);
+      release(victim);
+    }
+    Slot* slot = free_;
+    Slot* nextFree = slot->nextFree_;
+    Entry* entry = ::new (static_cast<void*>(&slot->entry_)) Entry(key, std::forward<Args>(args)...);
+    free_ = nextFree;
+    order_.push_front(*entry);
+    map_.insert(key, entry);
+    return entry->value_;
+  }
+  /**
+   * Removes the entry for the key - O(1)
+   * @return true if the key was cached
+   */
+  inline bool erase(const K& key) {
+    Entry** entry = map_.find(key);
+    if (entry == nullptr) {
+      return false;
+    }
+    Entry& removed = **entry;
+    map_.erase(key);
+    order_.erase(removed);
+    release(removed);
+    return true;
+  }
+  /**
+   * Removes all entries - the slots stay allocated
+   */
+  inline void clear() {
+    destroy_entries();
+    link_free_slots();
+    map_.clear();
+  }
+  /**
+   * Calls func(key, value) for all entries from the most to the least recently used
+   */
+  template <typename Func>
+  inline void for_each(Func func) {
+    for (Entry& entry : order_) {
+      func(static_cast<const K&>(entry.key_), entry.value_);
+    }
+  }
+  /**
+   * @return the key that would be evicted next
+   */
+  [[nodiscard]] inline const K& lru_key() const noexcept {
+    CX_ASSERT(!order_.empty(), "cache is empty");
+    return order_.back().key_;
+  }
+  [[nodiscard]] inline uint_32_cx size() const noexcept { return order_.size(); }
+  [[nodiscard]] inline uint_32_cx capacity() const noexcept { return capacity_; }
+  [[nodiscard]] inline bool empty() const noexcept { return order_.empty(); }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "TESTING LRU CACHE\n";
+
+    std::cout << "   Testing eviction order...\n";
+    LRUCache<int, int> cache(3);
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    CX_ASSERT(cache.size() == 3 && cache.lru_key() == 1, "");
+    [[maybe_unused]] int* one = cache.get(1);
+    CX_ASSERT(*one == 10 && cache.lru_key() == 2, "");
+    cache.put(4, 40);
+    CX_ASSERT(!cache.contains(2) && cache.size() == 3 && cache.get(2) == nullptr, "");
+    CX_ASSERT(*cache.peek(3) == 30 && cache.lru_key() == 3, "");
+    cache.put(3, 31);
+    [[maybe_unused]] int* three = cache.get(3);
+    CX_ASSERT(*three == 31 && cache.lru_key() == 1, "");
+    [[maybe_unused]] const int order[] = {3, 4, 1};
+    [[maybe_unused]] int index = 0;
+    cache.for_each([&]([[maybe_unused]] const int& key, [[maybe_unused]] int& value) {
+      CX_ASSERT(key == order[index++] && value / 10 == key, "");
+    });
+
+    std::cout << "   Testing erase and slot reuse...\n";
+    [[maybe_unused]] int* four = cache.get(4);
+    [[maybe_unused]] const bool erased = cache.erase(1);
+    [[maybe_unused]] const bool erasedTwice = cache.erase(1);
+    CX_ASSERT(erased && !erasedTwice && cache.size() == 2, "");
+    cache.put(5, 50);
+    cache.put(6, 60);
+    CX_ASSERT(cache.size() == 3 && !cache.contains(3) && cache.get(4) == four && *four == 40, "");
+    cache.clear();
+    CX_ASSERT(cache.empty() && cache.get(4) == nullptr, "");
+
+    std::cout << "   Testing against a reference model...\n";
+    LRUCache<int, std::string> strings(64);
+    std::vector<int> recency;  // reference - most recent at the back
+    uint32_t seed = 12345;
+    for (int i = 0; i < 20000; i++) {
+      seed = seed * 1664525 + 1013904223;
+      const int key = (int)((seed >> 8) % 150);
+      auto it = std::find(recency.begin(), recency.end(), key);
+      if ((seed >> 4) % 4 == 0) {
+        const bool cached = it != recency.end();
+        [[maybe_unused]] const bool erased = strings.erase(key);
+        CX_ASSERT(erased == cached, "");
+        if (cached) recency.erase(it);
+      } else if ((seed >> 4) % 4 == 1) {
+        std::string* value = strings.get(key);
+        CX_ASSERT((value != nullptr) == (it != recency.end()), "");
+        if (value != nullptr) {
+          CX_ASSERT(*value == std::string(40, (char)('a' + key % 26)), "");
+          recency.erase(it);
+          recency.push_back(key);
+        }
+      } else {
+        strings.put(key, 40, (char)('a' + key % 26));
+        if (it != recency.end()) {
+          recency.erase(it);
+        } else if (recency.size() == 64) {
+          recency.erase(recency.begin());
+        }
+        recency.push_back(key);
+      }
+      CX_ASSERT(strings.size() == recency.size(), "");
+      CX_ASSERT(recency.empty() || strings.lru_key() == recency.front(), "");
+    }
+    LRUCache<int, std::string> moved = std::move(strings);
+    CX_ASSERT(strings.empty() && moved.size() == recency.size(), "");
+    moved = LRUCache<int, std::string>(8);
+    moved.put(1, "one");
+    CX_ASSERT(*moved.get(1) == "one" && moved.capacity() == 8, "");
+  }
+#  endif
+};
+
+/**
+ * <h2>Sharded LRU Cache</h2>
+ * A thread safe LRU cache made of independent {@link LRUCache} shards, each behind its own mutex.<p>
+ * Keys are spread over the shards by the upper bits of their hash, so threads touching different keys
+ * rarely contend. Eviction is least recently used per shard - an approximation of a global LRU order.
+ * <p>
+ * get() returns a copy of the value - for large decoded objects cache a {@code std::shared_ptr} or use visit().
+ * @tparam K key type
+ * @tparam V value type
+ * @tparam Hash hash function for the keys
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ShardedLRUCache {
+  struct alignas(64) Shard {
+    std::mutex mutex_;
+    LRUCache<K, V, Hash> cache_;
+
+    Shard(uint_32_cx capacity, const Hash& hash) : cache_(capacity, hash) {}
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  Hash hash_;
+
+  [[nodiscard]] inline Shard& shard(const K& key) const noexcept {
+    // the upper half of the mixed hash - the shard maps use the low bits
+    const uint64_t mixed = static_cast<uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL;
+    return *shards_[(mixed >> 32) & (shards_.size() - 1)];
+  }
+
+ public:
+  /**
+   * @param capacity total number of entries - split evenly across the shards
+   * @param shardCount number of shards - rounded up to a power of two
+   * @param hash hash function for the keys
+   */
+  explicit ShardedLRUCache(uint_32_cx capacity, uint_32_cx shardCount = 16, Hash hash = Hash())
+      : hash_(std::move(hash)) {
+    CX_ASSERT(capacity > 0 && shardCount > 0, "capacity and shard count must be positive");
+    shardCount = cxstructs::next_power_of_2(shardCount);
+    const uint_32_cx perShard = (capacity + shardCount - 1) / shardCount;
+    shards_.reserve(shardCount);
+    for (uint_32_cx i = 0; i < shardCount; i++) {
+      shards_.push_back(std::make_unique<Shard>(perShard, hash_));
+    }
+  }
+
+  /**
+   * Looks up the value and marks it as most recently used in its shard
+   * @return a copy of the cached value or std::nullopt on a miss
+   */
+  [[nodiscard]] inline std::optional<V> get(const K& key) {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+    V* value = s.cache_.get(key);
+    return value == nullptr ? std::nullopt : std::optional<V>(*value);
+  }
+  /**
+   * Calls func(value) under the shard lock if the key is cached and marks it as most recently used
+   * @return true if the key was cached
+   */
+  template <typename Func>
+  inline bool visit(const K& key, Func func) {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+    V* value = s.cache_.get(key);
+    if (value == nullptr) {
+      return false;
+    }
+    func(*value);
+    return true;
+  }
+  /**
+   * Inserts or replaces the value for the key - evicts the least recently used entry of the shard when full
+   */
+  template <typename... Args>
+  inline void put(const K& key, Args&&... args) {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+    s.cache_.put(key, std::forward<Args>(args)...);
+  }
+  inline bool erase(const K& key) {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+    return s.cache_.erase(key);
+  }
+  [[nodiscard]] inline bool contains(const K& key) const {
+    Shard& s = shard(key);
+    std::lock_guard<std::mutex> lock(s.mutex_);
+    return s.cache_.contains(key);
+  }
+  inline void clear() {
+    for (auto& s : shards_) {
+      std::lock_guard<std::mutex> lock(s->mutex_);
+      s->cache_.clear();
+    }
+  }
+  /**
+   * @return the number of entries - only a snapshot while other threads modify the cache
+   */
+  [[nodiscard]] inline uint_32_cx size() const {
+    uint_32_cx total = 0;
+    for (auto& s : shards_) {
+      std::lock_guard<std::mutex> lock(s->mutex_);
+      total += s->cache_.size();
+    }
+    return total;
+  }
+  [[nodiscard]] inline uint_32_cx capacity() const noexcept {
+    return shards_.size() * shards_.front()->cache_.capacity();
+  }
+  [[nodiscard]] inline uint_32_cx shard_count() const noexcept { return shards_.size(); }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "TESTING SHARDED LRU CACHE\n";
+
+    std::cout << "   Testing single threaded...\n";
+    ShardedLRUCache<int, int> cache(1000, 5);
+    CX_ASSERT(cache.shard_count() == 8 && cache.capacity() == 1000, "");
+    for (int i = 0; i < 500; i++) {
+      cache.put(i, i * 2);
+    }
+    CX_ASSERT(cache.get(7).value() == 14 && !cache.get(700).has_value(), "");
+    [[maybe_unused]] const bool visited = cache.visit(8, [](int& value) { value = -1; });
+    CX_ASSERT(visited && *cache.get(8) == -1, "");
+    [[maybe_unused]] const bool erased = cache.erase(8);
+    CX_ASSERT(erased && !cache.contains(8) && cache.size() == 499, "");
+    for (int i = 0; i < 10000; i++) {
+      cache.put(i, i);
+    }
+    CX_ASSERT(cache.size() <= cache.capacity() && cache.contains(9999), "");
+    cache.clear();
+    CX_ASSERT(cache.size() == 0, "");
+
+    std::cout << "   Testing concurrent access...\n";
+    ShardedLRUCache<int, std::string> shared(256, 4);
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&shared, &mismatches, t] {
+        for (int i = 0; i < 20000; i++) {
+          const int key = (i * 7 + t * 13) % 512;
+          if (i % 3 == 0) {
+            shared.put(key, std::to_string(key));
+          } else if (i % 17 == 0) {
+            shared.erase(key);
+          } else {
+            auto value = shared.get(key);
+            if (value.has_value() && *value != std::to_string(key)) mismatches++;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    CX_ASSERT(mismatches == 0 && shared.size() <= shared.capacity(), "");
+  }
+#  endif
+};
+}  // namespace cxstructs
+#endif  // CXSTRUCTS_SRC_CXSTRUCTS_LRUCACHE_H_
@@ -25,6 +25,7 @@
 #  include <iostream>
 #  include <memory>
 #  include <stdexcept>
+#  include "../cxallocator.h"
 #  include "../cxconfig.h"
 
 namespace cxhelper {
@@ -55,7 +56,7 @@ namespace cxstructs {
  * However, accessing or searching for specific elements in the list requires potentially <b> traversing the entire list,
  * which is an O(n)</b> operation. This makes it less suitable for cases where random access is frequently required.<p>
  */
-template <typename T, typename Allocator = std::allocator<cxhelper::ListNode<T>>,
+template <typename T, typename Allocator = CXPoolAllocator<cxhelper::ListNode<T>>,
           typename size_type = uint32_t>
 class LinkedList {
   using Node = cxhelper::ListNode<T>;
@@ -275,7 +276,7 @@ class LinkedList {
   Iterator begin() { return Iterator(sentinel_.next_); }
   Iterator end() { return Iterator(nullptr); }
 
-  friend std::ostream& operator<<(std::ostream& os, const LinkedList<T>& q) {
+  friend std::ostream& operator<<(std::ostream& os, const LinkedList& q) {
     Node* current = q.sentinel_.next_;
     while (current != nullptr) {
       os << current->val_ << "->";
@@ -0,0 +1,251 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_MULTIQUEUE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_MULTIQUEUE_H_
+
+#  include "../cxconfig.h"
+#  include <atomic>
+#  include <limits>
+#  include <memory>
+#  include <thread>
+#  include "PriorityQueue.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <algorithm>
+#    include <vector>
+#  endif
+
+namespace cxstructs {
+
+/**
+ * @class MultiQueue
+ * @brief Scalable concurrent priority queue (MultiQueue) - smallest key first.
+ *
+ * Holds several independent heaps (lanes), each behind its own try-lock. push() inserts into a random free lane.
+ * try_pop() samples two random lanes and takes from the one whose top has the smaller key ("power of two choices").
+ * Threads never wait on a lock - if a lane is busy another one is picked - so the queue scales with the thread count
+ * where a single mutex protected heap serializes everything.<p>
+ * <b>Relaxed ordering:</b>
+ * <ul>
+ * <li>try_pop() does not always return the global minimum. The returned element is among the smallest O(lanes)
+ * elements in expectation - use more lanes per thread for throughput, fewer for precision.</li>
+ * <li>Elements of one thread are not popped in FIFO order, there is no linearizable order across threads.</li>
+ * <li>try_pop() only returns false after a full scan found every lane empty - with concurrent pushes that is a
+ * snapshot, not a guarantee that the queue is still empty.</li>
+ * </ul>
+ * The top key and the size of every lane are cached in atomics so sampling does not touch the heaps - Key has to be
+ * a trivially copyable arithmetic type. All keys including {@code std::numeric_limits<Key>::max()} are valid.
+ */
+template <typename Key, typename Value>
+class MultiQueue {
+  static_assert(std::is_arithmetic_v<Key>, "MultiQueue keys have to be arithmetic");
+  static constexpr Key EMPTY_TOP = std::numeric_limits<Key>::max();
+
+  struct Entry {
+    Key key;
+    Value value;
+    inline bool operator>(const Entry& o) const noexcept { return key > o.key; }
+  };
+  struct alignas(64) Lane {
+    std::atomic<bool> locked{false};
+    std::atomic<Key> top{EMPTY_TOP};   // Cached smallest key - only meaningful if count != 0
+    std::atomic<uint32_t> count{0};  // Cached heap size - a lane is empty exactly when it is 0
+    PriorityQueue<Entry> heap;
+
+    inline bool try_lock() noexcept {
+      return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+    }
+    inline void unlock() noexcept {
+      top.store(heap.empty() ? EMPTY_TOP : heap.top().key, std::memory_order_relaxed);
+      count.store((uint32_t)heap.size(), std::memory_order_relaxed);
+      locked.store(false, std::memory_order_release);
+    }
+  };
+  std::unique_ptr<Lane[]> lanes_;
+  uint32_t laneCount_;
+
+  // Per thread xorshift - no shared state between threads
+  static inline uint32_t random() noexcept {
+    thread_local uint32_t state =
+        (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1U;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+  inline Lane& random_lane() noexcept { return lanes_[random() % laneCount_]; }
+  // Pops from a locked lane - false if it turned out empty
+  inline bool pop_locked(Lane& lane, Key& key, Value& value) noexcept {
+    if (lane.heap.empty()) {
+      lane.unlock();
+      return false;
+    }
+    Entry& top = lane.heap.top();
+    key = top.key;
+    value = std::move(top.value);
+    lane.heap.pop();
+    lane.unlock();
+    return true;
+  }
+
+ public:
+  /**
+   * @param lanes amount of internal heaps - 2 to 4 per thread that uses the queue is a good default
+   */
+  explicit MultiQueue(uint32_t lanes = 2 * std::max(1U, std::thread::hardware_concurrency()))
+      : lanes_(new Lane[lanes < 2 ? 2 : lanes]), laneCount_(lanes < 2 ? 2 : lanes) {}
+  MultiQueue(const MultiQueue&) = delete;
+  MultiQueue& operator=(const MultiQueue&) = delete;
+  /**
+   * Adds an element - thread safe
+   * @param key priority - smaller keys are popped first
+   * @param value the element
+   */
+  void push(const Key key, const Value& value) {
+    while (true) {
+      Lane& lane = random_lane();
+      if (!lane.try_lock()) continue;
+      lane.heap.push({key, value});
+      lane.unlock();
+      return;
+    }
+  }
+  /**
+   * Removes one of the smallest elements - thread safe
+   * @param key receives the key of the element
+   * @param value receives the element
+   * @return false if all lanes were empty
+   */
+  bool try_pop(Key& key, Value& value) {
+    // Sampling - a few rounds of two random choices
+    for (int attempt = 0; attempt < 8; attempt++) {
+      Lane& a = random_lane();
+      Lane& b = random_lane();
+      const bool emptyA = a.count.load(std::memory_order_relaxed) == 0;
+      const bool emptyB = b.count.load(std::memory_order_relaxed) == 0;
+      if (emptyA && emptyB) continue;
+      const Key topA = a.top.load(std::memory_order_relaxed);
+      const Key topB = b.top.load(std::memory_order_relaxed);
+      Lane& best = emptyB || (!emptyA && topA <= topB) ? a : b;
+      if (!best.try_lock()) continue;
+      if (pop_locked(best, key, value)) return true;
+    }
+    // Fallback - scan everything so an almost empty queue is still drained
+    for (uint32_t i = 0; i < laneCount_; i++) {
+      Lane& lane = lanes_[i];
+      if (lane.count.load(std::memory_order_relaxed) == 0) continue;
+      while (!lane.try_lock()) std::this_thread::yield();
+      if (pop_locked(lane, key, value)) return true;
+    }
+    return false;
+  }
+  /**
+   * @return the amount of elements - only exact without concurrent modifications
+   */
+  [[nodiscard]] size_t size() const noexcept {
+    size_t size = 0;
+    for (uint32_t i = 0; i < laneCount_; i++) {
+      while (!lanes_[i].try_lock()) std::this_thread::yield();
+      size += lanes_[i].heap.size();
+      lanes_[i].unlock();
+    }
+    return size;
+  }
+  [[nodiscard]] inline bool empty() const noexcept {
+    for (uint32_t i = 0; i < laneCount_; i++) {
+      if (lanes_[i].count.load(std::memory_order_relaxed) != 0) return false;
+    }
+    return true;
+  }
+  [[nodiscard]] inline uint32_t lanes() const noexcept { return laneCount_; }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "MULTI QUEUE TESTS" << std::endl;
+    std::cout << "  Testing single thread..." << std::endl;
+    MultiQueue<uint32_t, int> q(8);
+    CX_ASSERT(q.empty(), "");
+    for (int i = 0; i < 1000; i++) {
+      q.push(i, i);
+    }
+    CX_ASSERT(q.size() == 1000 && !q.empty(), "");
+    uint32_t key;
+    int value;
+    std::vector<int> popped;
+    uint64_t rankError = 0;
+    while (q.try_pop(key, value)) {
+      CX_ASSERT((int)key == value, "");
+      rankError += std::abs(value - (int)popped.size());
+      popped.push_back(value);
+    }
+    CX_ASSERT(popped.size() == 1000 && q.empty(), "");
+    CX_ASSERT(rankError / 1000 < 8 * 8, "Pops should be close to the minimum");
+    std::sort(popped.begin(), popped.end());
+    for (int i = 0; i < 1000; i++) {
+      CX_ASSERT(popped[i] == i, "");
+    }
+
+    std::cout << "  Testing the largest key..." << std::endl;
+    q.push(std::numeric_limits<uint32_t>::max(), 7);
+    CX_ASSERT(!q.empty() && q.size() == 1, "");
+    [[maybe_unused]] bool poppedMax = q.try_pop(key, value);
+    CX_ASSERT(poppedMax && key == std::numeric_limits<uint32_t>::max() && value == 7, "");
+    poppedMax = q.try_pop(key, value);
+    CX_ASSERT(q.empty() && !poppedMax, "");
+
+    std::cout << "  Testing concurrent push/pop..." << std::endl;
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 20000;
+    MultiQueue<uint64_t, int> shared(THREADS * 2);
+    std::vector<std::vector<int>> results(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+      threads.emplace_back([&, t] {
+        uint64_t k;
+        int v;
+        for (int i = 0; i < PER_THREAD; i++) {
+          const int id = t * PER_THREAD + i;
+          shared.push(id % 977, id);
+          if (i % 2 == 1 && shared.try_pop(k, v)) results[t].push_back(v);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    uint64_t k;
+    int v;
+    while (shared.try_pop(k, v)) {
+      results[0].push_back(v);
+    }
+    std::vector<int> all;
+    for (auto& r : results) {
+      all.insert(all.end(), r.begin(), r.end());
+    }
+    std::sort(all.begin(), all.end());
+    CX_ASSERT(all.size() == THREADS * PER_THREAD, "Elements lost or duplicated");
+    for (int i = 0; i < (int)all.size(); i++) {
+      CX_ASSERT(all[i] == i, "");
+    }
+  }
+#  endif
+};
+
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_MULTIQUEUE_H_
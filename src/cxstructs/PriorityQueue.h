@@ -23,7 +23,9 @@
 
 #  include "../cxconfig.h"
 #  include <memory>  // For std::allocator<T>
+#  include <vector>
 #  ifdef CX_INCLUDE_TESTS
+#    include <algorithm>
 #    include <queue>
 #  endif
 
@@ -31,74 +33,101 @@ namespace cxstructs {
 
 /**
  * @class PriorityQueue
- * @brief A priority queue implementation using a binary heap.
+ * @brief A priority queue implementation using a d-ary heap.
  *
  * This class provides a priority queue data structure, which is a container adaptor that provides constant time lookup
  * of the largest (by default) element, at the expense of logarithmic insertion and extraction. A user-defined comparator
  * can be supplied to change the ordering, e.g., using std::greater<T> would cause the smallest element to appear as the top().
+ * <p>
+ * Every node has Arity children stored next to each other. The array is offset so that the children of a node start on
+ * a cache line - with 4 or 8 children and small elements one sift down level touches a single line and the tree is
+ * only half or a third as deep as a binary heap. Sifting moves a hole instead of swapping.
  */
 template <typename T, typename Compare = std::greater<T>, typename Allocator = std::allocator<T>,
-          typename size_type = uint32_t>
+          typename size_type = uint32_t, uint_32_cx Arity = 4>
 class PriorityQueue {
+  static_assert(Arity >= 2, "a heap needs at least 2 children per node");
+  static constexpr uint_32_cx CACHE_LINE = 64;
+  // Extra elements allocated to be able to align the children - only possible if elements tile a cache line
+  static constexpr uint_32_cx ALIGN_PAD = CACHE_LINE % sizeof(T) == 0 ? CACHE_LINE / sizeof(T) : 0;
+
   Allocator alloc;
-  T* arr_;
+  T* raw_;  // Start of the allocation
+  T* arr_;  // Root of the heap
+  uint_32_cx rawLen_;
   uint_32_cx len_;
   uint_32_cx size_;
   Compare comp;
 
-  void resize() noexcept {
-    len_ *= 2;
-
-    T* n_arr = alloc.allocate(len_);
-    std::uninitialized_move(arr_, arr_ + size_, n_arr);
-
-    if constexpr (!std::is_trivial_v<T>) {
-      for (size_t i = 0; i < size_; i++) {
+  // Allocates space for len elements with the first child group (index 1) on a cache line
+  T* allocate(uint_32_cx len) noexcept {
+    rawLen_ = len + ALIGN_PAD;
+    raw_ = alloc.allocate(rawLen_);
+    if constexpr (ALIGN_PAD > 0) {
+      const auto misalign = reinterpret_cast<uintptr_t>(raw_ + 1) % CACHE_LINE;
+      if (misalign % sizeof(T) == 0) return raw_ + (CACHE_LINE - misalign) % CACHE_LINE / sizeof(T);
+    }
+    return raw_;
+  }
+  void release() noexcept {
+    destroy_all();
+    alloc.deallocate(raw_, rawLen_);
+  }
+  void destroy_all() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (uint_32_cx i = 0; i < size_; i++) {
         std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
       }
     }
-    alloc.deallocate(arr_, size_);
-    arr_ = n_arr;
   }
-  void shrink() noexcept {
-    auto old_len = len_;
-    len_ = size_ * 1.5;
+  void reallocate(uint_32_cx len) noexcept {
+    T* oldRaw = raw_;
+    T* oldArr = arr_;
+    const uint_32_cx oldRawLen = rawLen_;
 
-    T* n_arr = alloc.allocate(len_);
-    std::uninitialized_move(arr_, arr_ + size_, n_arr);
-
-    // Destroy the original objects
-    if constexpr (!std::is_trivial_v<T>) {
-      for (size_t i = 0; i < old_len; i++) {
-        std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
+    T* n_arr = allocate(len);
+    std::uninitialized_move(oldArr, oldArr + size_, n_arr);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (uint_32_cx i = 0; i < size_; i++) {
+        std::allocator_traits<Allocator>::destroy(alloc, &oldArr[i]);
       }
     }
-
-    alloc.deallocate(arr_, old_len);
+    alloc.deallocate(oldRaw, oldRawLen);
     arr_ = n_arr;
+    len_ = len;
   }
+  void resize() noexcept { reallocate(len_ * 2); }
+  void shrink() noexcept { reallocate(size_ * 1.5 < 2 ? 2 : size_ * 1.5); }
   void sift_up(uint_32_cx index) noexcept {
-    auto parent = (index - 1) / 2;
-    while (index != 0 && !comp(arr_[index], arr_[parent])) {
-      std::swap(arr_[index], arr_[parent]);
+    T value = std::move(arr_[index]);
+    while (index != 0) {
+      const uint_32_cx parent = (index - 1) / Arity;
+      if (!comp(arr_[parent], value)) break;
+      arr_[index] = std::move(arr_[parent]);
       index = parent;
-      parent = (index - 1) / 2;
     }
+    arr_[index] = std::move(value);
   }
   void sift_down(uint_32_cx index) noexcept {
-    auto left = 2 * index + 1;
-    auto right = 2 * index + 2;
-    while ((left < size_ && comp(arr_[index], arr_[left]))
-           || (right < size_ && comp(arr_[index], arr_[right]))) {
-      auto smallest = (right >= size_ || comp(arr_[right], arr_[left])) ? left : right;
-      std::swap(arr_[index], arr_[smallest]);
-      index = smallest;
-      left = 2 * index + 1;
-      right = 2 * index + 2;
+    T value = std::move(arr_[index]);
+    while (true) {
+      const uint_32_cx first = index * Arity + 1;
+      if (first >= size_) break;
+      const uint_32_cx last = first + Arity < size_ ? first + Arity : size_;
+      uint_32_cx best = first;
+      for (uint_32_cx child = first + 1; child < last; child++) {
+        if (comp(arr_[best], arr_[child])) best = child;
+      }
+      if (!comp(value, arr_[best])) break;
+      arr_[index] = std::move(arr_[best]);
+      index = best;
     }
+    arr_[index] = std::move(value);
   }
+  // Floyd's bottom up construction - O(n)
   void heapify() noexcept {
-    for (uint_fast32_t i = len_ - 1; i > -1; i--) {
+    if (size_ < 2) return;
+    for (uint_32_cx i = (size_ - 2) / Arity + 1; i-- > 0;) {
       sift_down(i);
     }
   }
@@ -108,16 +137,18 @@ class PriorityQueue {
    * Per default is a min heap. Pass std::greater<> as comparator to bits_get a max-heap
    * @param len initial length and expansion factor
    */
-  explicit PriorityQueue(uint_32_cx len = 32) : arr_(alloc.allocate(len)), len_(len), size_(0) {}
+  explicit PriorityQueue(uint_32_cx len = 32) : len_(len < 2 ? 2 : len), size_(0) { arr_ = allocate(len_); }
   /**
    * @brief Constructor that initializes the priority queue with an existing array.
-   *  <b>Takes ownership of the array</b>
+   *  <b>Takes ownership of the array</b> - it has to be allocated with the same allocator
    * @param arr Pointer to the array to copy elements from.
    * @param len The number of elements in the array.
    */
-  explicit PriorityQueue(T*&& arr, uint_32_cx len) : arr_(arr), len_(len), size_(len) {
+  explicit PriorityQueue(T*&& arr, uint_32_cx len)
+      : raw_(arr), arr_(arr), rawLen_(len), len_(len), size_(len) {
     heapify();
     arr = nullptr;  //avoid double deletion
+    if (len_ < 2) reallocate(2);
   }
   /**
    * @brief Constructor that initializes the priority queue by copying the contents of an existing array.
@@ -125,53 +156,28 @@ class PriorityQueue {
    * @param arr Pointer to the array to copy elements from.
    * @param len The number of elements in the array.
    */
-  explicit PriorityQueue(const T* arr, uint_32_cx len)
-      : arr_(alloc.allocate(len)), len_(len), size_(len) {
-    if (std::is_trivial_v<T>) {
-      std::copy(arr, arr + len, arr_);
-    } else {
-      std::uninitialized_copy(arr, arr + len, arr_);
-    }
+  explicit PriorityQueue(const T* arr, uint_32_cx len) : len_(len < 2 ? 2 : len), size_(len) {
+    arr_ = allocate(len_);
+    std::uninitialized_copy(arr, arr + len, arr_);
     heapify();
   }
 
   PriorityQueue(const PriorityQueue& o) : len_(o.len_), size_(o.size_), comp(o.comp) {
-    arr_ = alloc.allocate(len_);
-    if (std::is_trivial_v<T>) {
-      std::copy(o.arr_, o.arr_ + o.size_, arr_);
-    } else {
-      std::uninitialized_copy(o.arr_, o.arr_ + o.size_, arr_);
-    }
+    arr_ = allocate(len_);
+    std::uninitialized_copy(o.arr_, o.arr_ + o.size_, arr_);
   }
   PriorityQueue& operator=(const PriorityQueue& o) {
     if (this != &o) {
-      if (!std::is_trivial_v<T>) {
-        for (uint_32_cx i = 0; i < len_; i++) {
-          std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-        }
-      }
-      alloc.deallocate(arr_, len_);
-
+      release();
       len_ = o.len_;
       size_ = o.size_;
-      arr_ = alloc.allocate(len_);
-
-      if (std::is_trivial_v<T>) {
-        std::copy(o.arr_, o.arr_ + o.size_, arr_);
-      } else {
-        std::uninitialized_copy(o.arr_, o.arr_ + o.size_, arr_);
-      }
+      comp = o.comp;
+      arr_ = allocate(len_);
+      std::uninitialized_copy(o.arr_, o.arr_ + o.size_, arr_);
     }
     return *this;
   }
-  inline ~PriorityQueue() {
-    if (!std::is_trivial_v<T>) {
-      for (uint_32_cx i = 0; i < len_; i++) {
-        std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-      }
-    }
-    alloc.deallocate(arr_, len_);
-  }
+  inline ~PriorityQueue() { release(); }
   /**
    *
    * @return the current n_elem of the priority-queue
@@ -185,7 +191,7 @@ class PriorityQueue {
     if (size_ == len_) {
       resize();
     }
-    arr_[size_] = e;
+    std::allocator_traits<Allocator>::construct(alloc, &arr_[size_], e);
     sift_up(size_++);
   }
   /**
@@ -201,13 +207,46 @@ class PriorityQueue {
     std::allocator_traits<Allocator>::construct(alloc, &arr_[size_], std::forward<Args>(args)...);
     sift_up(size_++);
   }
+  /**
+   * Adds all elements of the range in O(n + k)<p>
+   * Large ranges are appended unordered and the whole heap is rebuilt bottom up - faster than pushing one by one
+   * @param first begin of the range
+   * @param last end of the range
+   */
+  template <typename It>
+  void push_range(It first, It last) noexcept {
+    const auto count = static_cast<uint_32_cx>(std::distance(first, last));
+    reserve(size_ + count);
+    const uint_32_cx oldSize = size_;
+    for (; first != last; ++first) {
+      std::allocator_traits<Allocator>::construct(alloc, &arr_[size_++], *first);
+    }
+    if (count >= oldSize) {
+      heapify();
+    } else {
+      for (uint_32_cx i = oldSize; i < size_; i++) {
+        sift_up(i);
+      }
+    }
+  }
+  /**
+   * Makes sure the queue can hold at least len elements without reallocating
+   */
+  inline void reserve(uint_32_cx len) noexcept {
+    if (len > len_) reallocate(len);
+  }
   /**
    * Removes the highest priority element from the priority queue
    */
   inline void pop() noexcept {
     CX_ASSERT(size_ > 0, "no such element");
-    std::swap(arr_[0], arr_[--size_]);
-    sift_down(0);
+    if (--size_ > 0) {
+      arr_[0] = std::move(arr_[size_]);
+      std::allocator_traits<Allocator>::destroy(alloc, &arr_[size_]);
+      sift_down(0);
+    } else {
+      std::allocator_traits<Allocator>::destroy(alloc, &arr_[0]);
+    }
   }
   /**
    * Returns a read/write reference to the highest priority element of the queue.
@@ -224,15 +263,18 @@ class PriorityQueue {
    * Clears the queue of all elements
    */
   inline void clear() {
-    if (!std::is_trivial_v<T>) {
-      for (uint_32_cx i = 0; i < len_; i++) {
-        std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-      }
-    }
-    alloc.deallocate(arr_, len_);
+    release();
     size_ = 0;
     len_ = 32;
-    arr_ = alloc.allocate(32);
+    arr_ = allocate(32);
+  }
+  /**
+   * Removes all elements but keeps the allocated memory<p>
+   * Use this instead of clear() when the queue is refilled right after (e.g. search algorithms)
+   */
+  inline void reset() noexcept {
+    destroy_all();
+    size_ = 0;
   }
   /**
    * Reduces the underlying array size to something close to the actual data size.
@@ -370,12 +412,319 @@ class PriorityQueue {
     std::cout << "  Testing heapify..." << std::endl;
     int nums[4] = {5, 2, 3, 1};
     PriorityQueue<int> q12(const_cast<const int*>(nums), 4);
-    CX_ASSERT(q12.top() == 5, "");
+    CX_ASSERT(q12.top() == 1, "");
 
-    int* nums2 = new int[5]{2, 3, 54, 123};
+    int* nums2 = std::allocator<int>().allocate(4);
+    std::copy(nums, nums + 4, nums2);
     PriorityQueue<int, std::less<>> q13(std::move(nums2), 4);
     CX_ASSERT(nums2 == nullptr, "");
-    CX_ASSERT(q13.top() == 2, "");
+    CX_ASSERT(q13.top() == 5, "");
+    for ([[maybe_unused]] int expected : {5, 3, 2, 1}) {
+      CX_ASSERT(q13.top() == expected, "");
+      q13.pop();
+    }
+    q13.push(7);
+    CX_ASSERT(q13.top() == 7, "");
+
+    std::cout << "  Testing arity..." << std::endl;
+    PriorityQueue<int, std::greater<>, std::allocator<int>, uint32_t, 2> binary;
+    PriorityQueue<int, std::greater<>, std::allocator<int>, uint32_t, 8> octal;
+    frontier = {};
+    for (int i = 0; i < 5000; i++) {
+      const int ran = rand() % 1000;
+      binary.push(ran);
+      octal.push(ran);
+      frontier.push(ran);
+      if (i % 3 == 0) {
+        CX_ASSERT(binary.top() == frontier.top() && octal.top() == frontier.top(), "");
+        binary.pop();
+        octal.pop();
+        frontier.pop();
+      }
+    }
+    while (!frontier.empty()) {
+      CX_ASSERT(binary.top() == frontier.top() && octal.top() == frontier.top(), "");
+      binary.pop();
+      octal.pop();
+      frontier.pop();
+    }
+    CX_ASSERT(binary.empty() && octal.empty(), "");
+
+    std::cout << "  Testing push_range..." << std::endl;
+    std::vector<int> values(1000);
+    for (auto& v : values) {
+      v = rand() % 500;
+    }
+    PriorityQueue<int> q14;
+    q14.push_range(values.begin(), values.end());  // Rebuilds the heap
+    q14.push_range(values.begin(), values.begin() + 10);  // Sifts the new elements
+    std::vector<int> sorted = values;
+    sorted.insert(sorted.end(), values.begin(), values.begin() + 10);
+    std::sort(sorted.begin(), sorted.end());
+    CX_ASSERT(q14.size() == sorted.size(), "");
+    for ([[maybe_unused]] int expected : sorted) {
+      CX_ASSERT(q14.top() == expected, "");
+      q14.pop();
+    }
+
+    std::cout << "  Testing non trivial elements..." << std::endl;
+    PriorityQueue<std::string> q15(2);
+    for (int i = 0; i < 50; i++) {
+      q15.push(std::string(30, (char)('a' + i % 26)));
+    }
+    PriorityQueue<std::string> q16 = q15;
+    CX_ASSERT(q16.top()[0] == 'a', "");
+    q16.pop();
+    q16.pop();
+    CX_ASSERT(q16.top()[0] == 'b', "");
+    q15.reset();
+    CX_ASSERT(q15.empty(), "");
+    q15.push("x");
+    q15.shrink_to_fit();
+    CX_ASSERT(q15.top() == "x", "");
+  }
+#  endif
+};
+
+/**
+ * @class IndexedPriorityQueue
+ * @brief A d-ary heap whose elements can be changed and removed through handles.
+ *
+ * push() returns a handle that stays valid until the element is popped or erased - handles of removed elements are
+ * reused. Ordering is the same as for PriorityQueue (std::greater puts the smallest element on top).<p>
+ * decrease_key() and erase() are O(log n) - made for Dijkstra like searches and schedulers that change priorities a lot
+ * instead of pushing duplicates.
+ */
+template <typename T, typename Compare = std::greater<T>, uint_32_cx Arity = 4>
+class IndexedPriorityQueue {
+  static_assert(Arity >= 2, "a heap needs at least 2 children per node");
+
+ public:
+  using handle = uint32_t;
+  static constexpr handle INVALID_HANDLE = UINT32_MAX;
+
+ private:
+  struct Entry {
+    T value;
+    handle id;
+  };
+  std::vector<Entry> heap_;
+  std::vector<uint32_t> position_;  // Per handle - index into heap_ or INVALID_HANDLE if unused
+  std::vector<handle> free_;
+  Compare comp;
+
+  inline void place(const uint32_t index, Entry&& entry) noexcept {
+    position_[entry.id] = index;
+    heap_[index] = std::move(entry);
+  }
+  void sift_up(uint32_t index) noexcept {
+    Entry entry = std::move(heap_[index]);
+    while (index != 0) {
+      const uint32_t parent = (index - 1) / Arity;
+      if (!comp(heap_[parent].value, entry.value)) break;
+      place(index, std::move(heap_[parent]));
+      index = parent;
+    }
+    place(index, std::move(entry));
+  }
+  void sift_down(uint32_t index) noexcept {
+    const auto size = (uint32_t)heap_.size();
+    Entry entry = std::move(heap_[index]);
+    while (true) {
+      const uint32_t first = index * Arity + 1;
+      if (first >= size) break;
+      const uint32_t last = first + Arity < size ? first + Arity : size;
+      uint32_t best = first;
+      for (uint32_t child = first + 1; child < last; child++) {
+        if (comp(heap_[best].value, heap_[child].value)) best = child;
+      }
+      if (!comp(entry.value, heap_[best].value)) break;
+      place(index, std::move(heap_[best]));
+      index = best;
+    }
+    place(index, std::move(entry));
+  }
+  // Moves the element at index into its correct place
+  inline void fix(const uint32_t index) noexcept {
+    if (index != 0 && comp(heap_[(index - 1) / Arity].value, heap_[index].value)) {
+      sift_up(index);
+    } else {
+      sift_down(index);
+    }
+  }
+  void remove_at(const uint32_t index) noexcept {
+    const handle id = heap_[index].id;
+    position_[id] = INVALID_HANDLE;
+    free_.push_back(id);
+    if (index + 1 == heap_.size()) {
+      heap_.pop_back();
+      return;
+    }
+    Entry last = std::move(heap_.back());
+    heap_.pop_back();
+    place(index, std::move(last));
+    fix(index);
+  }
+
+ public:
+  /**
+   * Per default is a min heap
+   * @param len initial capacity
+   */
+  explicit IndexedPriorityQueue(uint32_t len = 32) {
+    heap_.reserve(len);
+    position_.reserve(len);
+  }
+  /**
+   * Adds an element
+   * @param value the element to be added
+   * @return handle to change or remove the element later
+   */
+  handle push(const T& value) {
+    handle id;
+    if (free_.empty()) {
+      id = (handle)position_.size();
+      position_.push_back(0);
+    } else {
+      id = free_.back();
+      free_.pop_back();
+    }
+    heap_.push_back({value, id});
+    position_[id] = (uint32_t)heap_.size() - 1;
+    sift_up((uint32_t)heap_.size() - 1);
+    return id;
+  }
+  /**
+   * @return the highest priority element
+   */
+  [[nodiscard]] inline const T& top() const noexcept { return heap_[0].value; }
+  /**
+   * @return the handle of the highest priority element
+   */
+  [[nodiscard]] inline handle top_handle() const noexcept { return heap_[0].id; }
+  /**
+   * Removes the highest priority element - its handle becomes invalid
+   */
+  inline void pop() noexcept {
+    CX_ASSERT(!heap_.empty(), "no such element");
+    remove_at(0);
+  }
+  /**
+   * Removes the element of the handle
+   */
+  inline void erase(const handle h) noexcept {
+    CX_ASSERT(contains(h), "invalid handle");
+    remove_at(position_[h]);
+  }
+  /**
+   * Raises the priority of an element (e.g. a shorter distance with the default min heap)
+   * @param h handle of the element
+   * @param value new value - must not have a lower priority than the current one
+   */
+  inline void decrease_key(const handle h, const T& value) noexcept {
+    CX_ASSERT(contains(h), "invalid handle");
+    const uint32_t index = position_[h];
+    CX_ASSERT(!comp(value, heap_[index].value), "new value has a lower priority");
+    heap_[index].value = value;
+    sift_up(index);
+  }
+  /**
+   * Changes an element to any new value
+   */
+  inline void update(const handle h, const T& value) noexcept {
+    CX_ASSERT(contains(h), "invalid handle");
+    const uint32_t index = position_[h];
+    heap_[index].value = value;
+    fix(index);
+  }
+  /**
+   * @return true if the handle belongs to an element currently in the queue
+   */
+  [[nodiscard]] inline bool contains(const handle h) const noexcept {
+    return h < position_.size() && position_[h] != INVALID_HANDLE;
+  }
+  /**
+   * @return the element of the handle
+   */
+  [[nodiscard]] inline const T& get(const handle h) const noexcept {
+    CX_ASSERT(contains(h), "invalid handle");
+    return heap_[position_[h]].value;
+  }
+  [[nodiscard]] inline uint32_t size() const noexcept { return (uint32_t)heap_.size(); }
+  [[nodiscard]] inline bool empty() const noexcept { return heap_.empty(); }
+  /**
+   * Removes all elements and invalidates all handles - keeps the allocated memory
+   */
+  inline void clear() noexcept {
+    heap_.clear();
+    position_.clear();
+    free_.clear();
+  }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "INDEXED PRIORITY QUEUE TESTS" << std::endl;
+    std::cout << "  Testing push/pop..." << std::endl;
+    IndexedPriorityQueue<int> q;
+    CX_ASSERT(q.empty(), "");
+    [[maybe_unused]] const handle h5 = q.push(5);
+    const handle h3 = q.push(3);
+    const handle h8 = q.push(8);
+    CX_ASSERT(q.size() == 3 && q.top() == 3 && q.top_handle() == h3, "");
+    CX_ASSERT(q.get(h5) == 5 && q.get(h8) == 8, "");
+
+    std::cout << "  Testing decrease_key..." << std::endl;
+    q.decrease_key(h8, 1);
+    CX_ASSERT(q.top() == 1 && q.top_handle() == h8, "");
+    q.update(h8, 10);
+    CX_ASSERT(q.top() == 3, "");
+
+    std::cout << "  Testing erase..." << std::endl;
+    q.erase(h3);
+    CX_ASSERT(!q.contains(h3) && q.top() == 5, "");
+    [[maybe_unused]] const handle reused = q.push(4);
+    CX_ASSERT(reused == h3 && q.top() == 4, "");
+    q.pop();
+    q.pop();
+    CX_ASSERT(q.top() == 10 && q.size() == 1, "");
+    q.clear();
+    CX_ASSERT(q.empty() && !q.contains(h8), "");
+
+    std::cout << "  Testing random operations..." << std::endl;
+    std::vector<int> reference;  // Per handle - value or -1
+    IndexedPriorityQueue<int, std::greater<>, 8> r;
+    srand(12);
+    for (int i = 0; i < 20000; i++) {
+      const int op = rand() % 10;
+      if (op < 4 || r.empty()) {
+        const int value = rand() % 100000;
+        const handle h = r.push(value);
+        if (h >= reference.size()) reference.resize(h + 1, -1);
+        reference[h] = value;
+      } else if (op < 6) {
+        int best = INT32_MAX;
+        for (const int v : reference) {
+          if (v != -1 && v < best) best = v;
+        }
+        CX_ASSERT(r.top() == best, "");
+        reference[r.top_handle()] = -1;
+        r.pop();
+      } else {
+        const handle h = rand() % reference.size();
+        if (reference[h] == -1) continue;
+        if (op < 9) {
+          reference[h] = reference[h] / 2;
+          r.decrease_key(h, reference[h]);
+        } else {
+          reference[h] = -1;
+          r.erase(h);
+        }
+      }
+    }
+    while (!r.empty()) {
+      [[maybe_unused]] const int value = r.top();
+      r.pop();
+      CX_ASSERT(r.empty() || r.top() >= value, "");
+    }
   }
 #  endif
 };
@@ -48,6 +48,7 @@ class Queue {
   size_type front_;
 
   inline void grow() noexcept {
+    const auto old_capacity = capacity_;
     capacity_ *= 2;
 
     T* n_arr = alloc.allocate(capacity_);
@@ -65,11 +66,12 @@ class Queue {
       }
     }
 
-    alloc.deallocate(arr_, size_);
+    alloc.deallocate(arr_, old_capacity);
     arr_ = n_arr;
     front_ = 0;
   }
   inline void shrink() noexcept {
+    const auto old_capacity = capacity_;
     capacity_ = size_ * 1.5;
 
     T* n_arr = alloc.allocate(capacity_);
@@ -87,7 +89,7 @@ class Queue {
       }
     }
 
-    alloc.deallocate(arr_, size_);
+    alloc.deallocate(arr_, old_capacity);
     arr_ = n_arr;
     front_ = 0;
   }
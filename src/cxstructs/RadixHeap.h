@@ -0,0 +1,222 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_RADIXHEAP_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_RADIXHEAP_H_
+
+#  include "../cxconfig.h"
+#  include <bit>
+#  include <type_traits>
+#  include <vector>
+#  include "PriorityQueue.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <queue>
+#  endif
+
+namespace cxstructs {
+
+/**
+ * @class RadixHeap
+ * @brief Monotone priority queue for unsigned integer keys with amortized O(1) push and pop.
+ *
+ * Works if the popped keys never decrease - true for Dijkstra, A* with a consistent heuristic and event schedulers.
+ * Elements are kept in one bucket per bit of the key, sorted by the highest bit that differs from the last popped key.
+ * An element only moves to a lower bucket when its bucket is redistributed, so each element is touched at most once per
+ * key bit.<p>
+ * Keys smaller than the last popped key are treated as equal to it and come out next - a search with an inconsistent
+ * (e.g. weighted) heuristic still works, just with a less exact order. Equal keys are popped last in first out.
+ */
+template <typename Key, typename Value>
+class RadixHeap {
+  static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key>, "RadixHeap needs unsigned integer keys");
+  static constexpr int BUCKETS = sizeof(Key) * 8 + 1;
+
+  struct Entry {
+    Key key;
+    Value value;
+  };
+  std::vector<Entry> buckets_[BUCKETS];
+  uint32_t size_ = 0;
+  Key last_ = 0;
+
+  [[nodiscard]] inline int bucket(const Key key) const noexcept {
+    return key == last_ ? 0 : (int)std::bit_width((Key)(key ^ last_));
+  }
+  // Makes sure bucket 0 holds the minimum - redistributes the first non-empty bucket
+  void pull() noexcept {
+    if (!buckets_[0].empty()) return;
+    int i = 1;
+    while (buckets_[i].empty()) i++;
+    auto& source = buckets_[i];
+    Key minKey = source[0].key;
+    for (const Entry& e : source) {
+      if (e.key < minKey) minKey = e.key;
+    }
+    last_ = minKey;
+    for (Entry& e : source) {
+      buckets_[bucket(e.key)].push_back(std::move(e));
+    }
+    source.clear();
+  }
+
+ public:
+  RadixHeap() = default;
+  /**
+   * Adds an element
+   * @param key priority - should not be smaller than the last popped key
+   * @param value the element
+   */
+  inline void push(Key key, const Value& value) {
+    if (key < last_) key = last_;
+    buckets_[bucket(key)].push_back({key, value});
+    size_++;
+  }
+  /**
+   * @return the element with the smallest key
+   */
+  [[nodiscard]] inline Value& top() noexcept {
+    CX_ASSERT(size_ > 0, "no such element");
+    pull();
+    return buckets_[0].back().value;
+  }
+  /**
+   * @return the smallest key
+   */
+  [[nodiscard]] inline Key top_key() noexcept {
+    CX_ASSERT(size_ > 0, "no such element");
+    pull();
+    return last_;
+  }
+  /**
+   * Removes the element with the smallest key
+   */
+  inline void pop() noexcept {
+    CX_ASSERT(size_ > 0, "no such element");
+    pull();
+    buckets_[0].pop_back();
+    size_--;
+  }
+  [[nodiscard]] inline uint32_t size() const noexcept { return size_; }
+  [[nodiscard]] inline bool empty() const noexcept { return size_ == 0; }
+  /**
+   * Removes all elements and restarts at key 0 - keeps the allocated memory
+   */
+  inline void reset() noexcept {
+    for (auto& b : buckets_) {
+      b.clear();
+    }
+    size_ = 0;
+    last_ = 0;
+  }
+  inline void clear() noexcept { reset(); }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "RADIX HEAP TESTS" << std::endl;
+    std::cout << "  Testing push/pop..." << std::endl;
+    RadixHeap<uint32_t, int> heap;
+    CX_ASSERT(heap.empty(), "");
+    heap.push(5, 50);
+    heap.push(1, 10);
+    heap.push(3, 30);
+    heap.push(1, 11);
+    CX_ASSERT(heap.size() == 4 && heap.top_key() == 1, "");
+    CX_ASSERT(heap.top() == 11, "Equal keys are last in first out");
+    heap.pop();
+    CX_ASSERT(heap.top() == 10, "");
+    heap.pop();
+    heap.push(2, 20);
+    CX_ASSERT(heap.top_key() == 2 && heap.top() == 20, "");
+    heap.pop();
+    heap.push(0, 0);  // Smaller than the last popped key
+    CX_ASSERT(heap.top_key() == 2 && heap.top() == 0, "");
+    heap.pop();
+    CX_ASSERT(heap.top_key() == 3, "");
+    heap.reset();
+    CX_ASSERT(heap.empty(), "");
+
+    std::cout << "  Testing against std::priority_queue..." << std::endl;
+    RadixHeap<uint16_t, uint16_t> small;
+    RadixHeap<uint64_t, uint64_t> large;
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>> reference;
+    srand(7);
+    uint64_t last = 0;
+    for (int i = 0; i < 50000; i++) {
+      if (rand() % 3 != 0 || reference.empty()) {
+        const uint64_t key = last + rand() % 1000;
+        if (key <= UINT16_MAX) {
+          small.push((uint16_t)key, (uint16_t)key);
+        }
+        large.push(key << 20, key);
+        reference.push(key);
+      } else {
+        last = reference.top();
+        reference.pop();
+        CX_ASSERT(large.top_key() == last << 20 && large.top() == last, "");
+        large.pop();
+        if (last <= UINT16_MAX) {
+          CX_ASSERT(small.top_key() == last && small.top() == last, "");
+          small.pop();
+        }
+      }
+    }
+  }
+#  endif
+};
+}  // namespace cxstructs
+
+namespace cxhelper {
+// PriorityQueue behind the RadixHeap interface - for keys the RadixHeap cannot handle
+template <typename Key, typename Value>
+class KeyedHeap {
+  struct Entry {
+    Key key;
+    Value value;
+    inline bool operator>(const Entry& o) const noexcept { return key > o.key; }
+  };
+  cxstructs::PriorityQueue<Entry> heap_;
+
+ public:
+  inline void push(const Key key, const Value& value) { heap_.push({key, value}); }
+  [[nodiscard]] inline Value& top() noexcept { return heap_.top().value; }
+  [[nodiscard]] inline Key top_key() noexcept { return heap_.top().key; }
+  inline void pop() noexcept { heap_.pop(); }
+  [[nodiscard]] inline uint32_t size() const noexcept { return heap_.size(); }
+  [[nodiscard]] inline bool empty() noexcept { return heap_.empty(); }
+  inline void reset() noexcept { heap_.reset(); }
+  inline void clear() noexcept { heap_.reset(); }
+};
+}  // namespace cxhelper
+
+namespace cxstructs {
+/**
+ * True if the key type allows a RadixHeap - unsigned integers
+ */
+template <typename Key>
+inline constexpr bool is_radix_key_v = std::is_integral_v<Key> && std::is_unsigned_v<Key>;
+
+/**
+ * Open list for searches with monotone priorities - picks a RadixHeap for unsigned integral keys and falls back to
+ * a PriorityQueue otherwise. Both have the same interface: push(key, value), top(), top_key(), pop()
+ */
+template <typename Key, typename Value>
+using MonotoneQueue = std::conditional_t<is_radix_key_v<Key>, RadixHeap<Key, Value>, cxhelper::KeyedHeap<Key, Value>>;
+
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_RADIXHEAP_H_
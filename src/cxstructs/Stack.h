@@ -30,7 +30,7 @@
 #  include <stdexcept>
 #  include "../cxconfig.h"
 #  include "../cxstructs/mat.h"
-#  include "CXAllocator.h"
+#  include "../cxallocator.h"
 
 //this stack is very fast and implemented natively (std::stack is using the std::vector)
 //can be up to 1.6 times faster and should be faster in any use case
@@ -47,7 +47,7 @@ namespace cxstructs {
 template <typename T, bool UseCXPoolAllocator = true>
 class Stack {
   using Allocator =
-      typename std::conditional<UseCXPoolAllocator, CXPoolAllocator<T, sizeof(T) * 33, 1>,
+      typename std::conditional<UseCXPoolAllocator, CXPoolAllocator<T>,
                                 std::allocator<T>>::type;
 
   Allocator alloc;
@@ -57,7 +57,8 @@ class Stack {
   bool is_trivial_destr = std::is_trivially_destructible<T>::value;
 
   inline void grow() {
-    len_ *= 2;
+    auto old_len = len_;
+    len_ = std::max<uint_32_cx>(len_ * 2, 1);
 
     T* n_arr = alloc.allocate(len_);
 
@@ -70,7 +71,7 @@ class Stack {
       }
     }
 
-    alloc.deallocate(arr_, size_);
+    alloc.deallocate(arr_, old_len);
     arr_ = n_arr;
     //as array is moved no need for delete []
   }
@@ -177,8 +178,10 @@ class Stack {
   }
   //move constructor
   Stack(Stack&& o) noexcept : arr_(o.arr_), size_(o.size_), len_(o.len_) {
-    //leve other in previous state
+    // other is left empty
     o.arr_ = nullptr;  // PREVENT DOUBLE DELETION!
+    o.size_ = 0;
+    o.len_ = 0;
   }
   //move assignment
   Stack& operator=(Stack&& o) noexcept {
@@ -194,8 +197,10 @@ class Stack {
       size_ = o.size_;
       len_ = o.len_;
 
-      //other is left in previous state but invalidated
+      // other is left empty
       o.arr_ = nullptr;  // PREVENT DOUBLE DELETION!
+      o.size_ = 0;
+      o.len_ = 0;
     }
     return *this;
   }
@@ -316,6 +321,10 @@ class Stack {
     Stack<int> moveStack(std::move(fillStack));
     CX_ASSERT(moveStack.size() == copyStack.size(), "");
     CX_ASSERT(fillStack.empty(), "");
+    for (int i = 0; i < 100; i++) {
+      fillStack.push(i);
+    }
+    CX_ASSERT(fillStack.size() == 100 && fillStack.top() == 99, "");
 
     std::cout << "  Testing initializer list constructor..." << std::endl;
     Stack<int> initListStack({1, 2, 3, 4, 5});
@@ -0,0 +1,408 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_SWEEPANDPRUNE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_SWEEPANDPRUNE_H_
+
+#  include "../cxconfig.h"
+#  include <algorithm>
+#  include <atomic>
+#  include <bit>
+#  include <limits>
+#  include <utility>
+#  include <vector>
+#  include "Geometry.h"
+#  include "../cxutil/cxexec.h"
+
+namespace cxstructs {
+
+/**
+ * @class SweepAndPrune
+ * @brief Broad-phase collision detection - finds all overlapping pairs among a set of moving AABBs.
+ *
+ * The boxes are kept in an order sorted by their lower bound on the sweep axis. Each find_pairs() call re-sorts that
+ * order with an insertion sort: objects move little between two ticks, so last tick's order is almost sorted and the
+ * sort is close to O(n) (temporal coherence). Large reorderings (bulk inserts, teleports) fall back to std::sort.
+ * The sweep then only tests boxes whose intervals overlap on the sweep axis, the other axis is tested 8 (AVX2) or
+ * 4 (SSE2) candidates at a time.<p>
+ * find_pairs_parallel() keeps a sorted order for both axes (sorted concurrently), sweeps along the axis with the
+ * larger spread of box centers and splits the sweep across the shared {@link exec::pool}.<p>
+ * Overlap matches {@link Rect::intersects} - touching boxes are a pair. Pairs are reported as (smaller id, larger id)
+ * in no particular order.
+ *
+ * <h2>Usage</h2>
+ * <pre>
+ * SweepAndPrune sap;
+ * uint32_t id = sap.add({x, y, w, h});
+ * // every tick
+ * sap.update(id, {x, y, w, h});
+ * sap.find_pairs(pairs);
+ * </pre>
+ */
+class SweepAndPrune {
+ public:
+  using PairList = std::vector<std::pair<uint32_t, uint32_t>>;
+
+ private:
+  struct Bounds {
+    float min[2];
+    float max[2];
+  };
+  struct Endpoint {
+    float min;
+    uint32_t id;
+  };
+  static constexpr float INF = std::numeric_limits<float>::infinity();
+  static constexpr uint32_t CHUNK = 1024;  // Sweep start indices a thread claims at once
+
+  std::vector<Bounds> bounds_;
+  std::vector<uint32_t> freeIds_;
+  std::vector<Endpoint> order_[2];
+  float spread_[2]{};
+  // Bounds gathered in sweep order - p is the sweep axis, s the other one
+  std::vector<float> pMin_;
+  std::vector<float> pMax_;
+  std::vector<float> sMin_;
+  std::vector<float> sMax_;
+  std::vector<uint32_t> ids_;
+  std::vector<PairList> threadPairs_;
+  uint32_t size_ = 0;
+
+  // Refreshes the keys of the axis order and re-sorts it - returns the variance of the box centers on that axis
+  inline float sort_axis(int axis) {
+    auto& order = order_[axis];
+    double sum = 0;
+    double sumSqr = 0;
+    for (auto& e : order) {
+      const Bounds& b = bounds_[e.id];
+      e.min = b.min[axis];
+      if (b.min[axis] <= b.max[axis]) {
+        const double center = 0.5 * ((double)b.min[axis] + b.max[axis]);
+        sum += center;
+        sumSqr += center * center;
+      }
+    }
+    // Insertion sort with a budget of shifts, falls back to std::sort if the order changed a lot
+    const auto len = (uint32_t)order.size();
+    uint64_t budget = 8ULL * len + 64;
+    for (uint32_t i = 1; i < len; ++i) {
+      const Endpoint e = order[i];
+      uint32_t j = i;
+      while (j > 0 && order[j - 1].min > e.min) {
+        order[j] = order[j - 1];
+        --j;
+      }
+      order[j] = e;
+      if ((budget -= std::min<uint64_t>(budget, i - j)) == 0) {
+        std::sort(order.begin(), order.end(), [](const Endpoint& a, const Endpoint& b) { return a.min < b.min; });
+        break;
+      }
+    }
+    if (size_ == 0) return 0;
+    const double mean = sum / size_;
+    return (float)(sumSqr / size_ - mean * mean);
+  }
+  inline void gather(int axis) {
+    const int other = 1 - axis;
+    const auto len = order_[axis].size();
+    pMin_.resize(len);
+    pMax_.resize(len);
+    sMin_.resize(len);
+    sMax_.resize(len);
+    ids_.resize(len);
+    for (size_t k = 0; k < len; ++k) {
+      const Endpoint& e = order_[axis][k];
+      const Bounds& b = bounds_[e.id];
+      pMin_[k] = e.min;
+      pMax_[k] = b.max[axis];
+      sMin_[k] = b.min[other];
+      sMax_[k] = b.max[other];
+      ids_[k] = e.id;
+    }
+  }
+  inline void emit(PairList& pairs, uint32_t a, uint32_t b) const {
+    pairs.emplace_back(std::min(a, b), std::max(a, b));
+  }
+  // Sweeps the start indices [begin, end) against everything after them in sweep order
+  inline void sweep(uint32_t begin, uint32_t end, PairList& pairs) const {
+    const auto n = (uint32_t)ids_.size();
+    const float* pMin = pMin_.data();
+    const float* sMin = sMin_.data();
+    const float* sMax = sMax_.data();
+    for (uint32_t i = begin; i < end; ++i) {
+      const float maxP = pMax_[i];
+      const float minS = sMin[i];
+      const float maxS = sMax[i];
+      uint32_t j = i + 1;
+#  if defined(CX_GEOMETRY_AVX512) || defined(CX_GEOMETRY_AVX2)
+      const __m256 vMaxP = _mm256_set1_ps(maxP);
+      const __m256 vMinS = _mm256_set1_ps(minS);
+      const __m256 vMaxS = _mm256_set1_ps(maxS);
+      for (; j + 8 <= n; j += 8) {
+        // Sorted by pMin - the in range lanes are always a prefix
+        const int inRange = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(pMin + j), vMaxP, _CMP_LE_OQ));
+        const __m256 overlap = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(sMin + j), vMaxS, _CMP_LE_OQ),
+                                             _mm256_cmp_ps(_mm256_loadu_ps(sMax + j), vMinS, _CMP_GE_OQ));
+        auto hits = static_cast<uint32_t>(inRange & _mm256_movemask_ps(overlap));
+        while (hits != 0) {
+          emit(pairs, ids_[i], ids_[j + std::countr_zero(hits)]);
+          hits &= hits - 1;
+        }
+        if (inRange != 0xFF) {
+          j = n;
+          break;
+        }
+      }
+#  elif defined(CX_GEOMETRY_SSE2)
+      const __m128 vMaxP = _mm_set1_ps(maxP);
+      const __m128 vMinS = _mm_set1_ps(minS);
+      const __m128 vMaxS = _mm_set1_ps(maxS);
+      for (; j + 4 <= n; j += 4) {
+        const int inRange = _mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(pMin + j), vMaxP));
+        const __m128 overlap =
+            _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(sMin + j), vMaxS), _mm_cmpge_ps(_mm_loadu_ps(sMax + j), vMinS));
+        auto hits = static_cast<uint32_t>(inRange & _mm_movemask_ps(overlap));
+        while (hits != 0) {
+          emit(pairs, ids_[i], ids_[j + std::countr_zero(hits)]);
+          hits &= hits - 1;
+        }
+        if (inRange != 0xF) {
+          j = n;
+          break;
+        }
+      }
+#  endif
+      for (; j < n && pMin[j] <= maxP; ++j) {
+        if (sMin[j] <= maxS && sMax[j] >= minS) emit(pairs, ids_[i], ids_[j]);
+      }
+    }
+  }
+
+ public:
+  SweepAndPrune() = default;
+  /**
+   * Adds a box - ids of removed boxes are reused
+   * @param r the box
+   * @return the id of the box
+   */
+  inline uint32_t add(const Rect& r) {
+    uint32_t id;
+    if (!freeIds_.empty()) {
+      id = freeIds_.back();
+      freeIds_.pop_back();
+    } else {
+      id = (uint32_t)bounds_.size();
+      bounds_.push_back({});
+      order_[0].push_back({INF, id});
+      order_[1].push_back({INF, id});
+    }
+    size_++;
+    update(id, r);
+    return id;
+  }
+  /**
+   * Sets the new bounds of a box - the sorted order is only repaired on the next find_pairs()
+   * @param id id returned by add()
+   * @param r the new bounds
+   */
+  inline void update(uint32_t id, const Rect& r) {
+    CX_ASSERT(id < bounds_.size(), "invalid id");
+    bounds_[id] = {{r.x(), r.y()}, {r.x() + r.width(), r.y() + r.height()}};
+  }
+  /**
+   * Removes a box. Its slot stays in the sorted order as an empty box that sorts to the end and overlaps nothing
+   * @param id id returned by add()
+   */
+  inline void remove(uint32_t id) {
+    CX_ASSERT(id < bounds_.size() && bounds_[id].min[0] <= bounds_[id].max[0], "invalid id");
+    bounds_[id] = {{INF, INF}, {-INF, -INF}};
+    freeIds_.push_back(id);
+    size_--;
+  }
+  /**
+   * Finds all overlapping pairs, sweeping along the x-axis
+   * @param pairs cleared and filled with (smaller id, larger id) pairs
+   */
+  inline void find_pairs(PairList& pairs) {
+    pairs.clear();
+    spread_[0] = sort_axis(0);
+    spread_[1] = 0;  // Only the x order is current - sweep_axis() reports x
+    gather(0);
+    sweep(0, (uint32_t)ids_.size(), pairs);
+  }
+  /**
+   * Finds all overlapping pairs using multiple threads.<p>
+   * Both axis orders are re-sorted concurrently, the sweep runs along the axis with the larger spread and is split
+   * into chunks that the tasks claim dynamically. Runs on the shared {@link exec::pool}.
+   * The result is the same set of pairs as find_pairs()
+   * @param pairs cleared and filled with (smaller id, larger id) pairs
+   * @param threadCount number of tasks including the calling thread - 1 (or inline exec) is the serial find_pairs()
+   */
+  inline void find_pairs_parallel(PairList& pairs, uint32_t threadCount = exec::concurrency()) {
+    if (threadCount <= 1 || exec::is_inline()) {
+      find_pairs(pairs);
+      return;
+    }
+    exec::parallel_invoke([this] { spread_[0] = sort_axis(0); }, [this] { spread_[1] = sort_axis(1); });
+    gather(sweep_axis());
+
+    const auto n = (uint32_t)ids_.size();
+    threadPairs_.resize(threadCount);
+    std::atomic<uint32_t> next{0};
+    auto work = [&](uint32_t t) {
+      PairList& local = threadPairs_[t];
+      local.clear();
+      for (uint32_t begin; (begin = next.fetch_add(CHUNK, std::memory_order_relaxed)) < n;) {
+        sweep(begin, std::min(begin + CHUNK, n), local);
+      }
+    };
+    exec::TaskGroup group;
+    for (uint32_t t = 1; t < threadCount; ++t) {
+      group.run([&work, t] { work(t); });
+    }
+    work(0);
+    group.wait();
+    pairs.clear();
+    for (const auto& local : threadPairs_) {
+      pairs.insert(pairs.end(), local.begin(), local.end());
+    }
+  }
+  /**
+   * Removes all boxes
+   */
+  inline void clear() {
+    bounds_.clear();
+    freeIds_.clear();
+    order_[0].clear();
+    order_[1].clear();
+    size_ = 0;
+  }
+  inline void reserve(uint32_t n) {
+    bounds_.reserve(n);
+    order_[0].reserve(n);
+    order_[1].reserve(n);
+  }
+  [[nodiscard]] inline uint32_t size() const { return size_; }
+  [[nodiscard]] inline bool empty() const { return size_ == 0; }
+  /**
+   * @return the axis (0 = x, 1 = y) the last find_pairs() or find_pairs_parallel() call swept along
+   */
+  [[nodiscard]] inline int sweep_axis() const { return spread_[0] >= spread_[1] ? 0 : 1; }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "SWEEP AND PRUNE TESTS" << std::endl;
+    uint32_t seed = 4242;
+    auto next = [&seed](uint32_t mod) {
+      seed = seed * 1103515245U + 12345U;
+      return static_cast<float>((seed >> 8) % mod);
+    };
+    std::vector<Rect> boxes;
+    std::vector<bool> alive;
+    auto brute = [&]() {
+      PairList pairs;
+      for (uint32_t i = 0; i < boxes.size(); i++) {
+        for (uint32_t j = i + 1; j < boxes.size(); j++) {
+          if (alive[i] && alive[j] && boxes[i].intersects(boxes[j])) pairs.emplace_back(i, j);
+        }
+      }
+      return pairs;
+    };
+    [[maybe_unused]] auto sorted = [](PairList pairs) {
+      std::sort(pairs.begin(), pairs.end());
+      return pairs;
+    };
+
+    std::cout << "  Testing touching boxes..." << std::endl;
+    SweepAndPrune sap;
+    CX_ASSERT(sap.empty(), "");
+    sap.add({0, 0, 10, 10});
+    sap.add({10, 0, 10, 10});
+    sap.add({21, 0, 10, 10});
+    PairList pairs;
+    sap.find_pairs(pairs);
+    CX_ASSERT(pairs.size() == 1 && pairs[0] == std::make_pair(0U, 1U), "");
+    sap.clear();
+
+    std::cout << "  Testing against brute force..." << std::endl;
+    for (int i = 0; i < 2000; i++) {
+      boxes.emplace_back(next(1000), next(1000), next(30), next(30));
+      alive.push_back(true);
+      [[maybe_unused]] const uint32_t id = sap.add(boxes.back());
+      CX_ASSERT(id == (uint32_t)i, "");
+    }
+    sap.find_pairs(pairs);
+    auto expected = brute();
+    CX_ASSERT(!expected.empty() && sorted(pairs) == expected, "");
+    sap.find_pairs_parallel(pairs, 4);
+    CX_ASSERT(sorted(pairs) == expected, "");
+
+    std::cout << "  Testing incremental updates..." << std::endl;
+    for (int tick = 0; tick < 5; tick++) {
+      for (uint32_t i = 0; i < boxes.size(); i++) {
+        boxes[i].x() += next(11) - 5;
+        boxes[i].y() += next(11) - 5;
+        sap.update(i, boxes[i]);
+      }
+      sap.find_pairs(pairs);
+      expected = brute();
+      CX_ASSERT(sorted(pairs) == expected, "");
+      sap.find_pairs_parallel(pairs, 3);
+      CX_ASSERT(sorted(pairs) == expected, "");
+    }
+
+    std::cout << "  Testing remove and reuse..." << std::endl;
+    for (uint32_t i = 0; i < boxes.size(); i += 3) {
+      sap.remove(i);
+      alive[i] = false;
+    }
+    CX_ASSERT(sap.size() == 2000 - 667, "");
+    sap.find_pairs(pairs);
+    CX_ASSERT(sorted(pairs) == brute(), "");
+    for (int i = 0; i < 100; i++) {
+      const uint32_t id = sap.add({next(1000), next(1000), next(30), next(30)});
+      CX_ASSERT(!alive[id], "only free ids are reused");
+      alive[id] = true;
+      boxes[id] = Rect(next(1000), next(1000), next(30), next(30));
+      sap.update(id, boxes[id]);
+    }
+    sap.find_pairs_parallel(pairs, 2);
+    expected = brute();
+    CX_ASSERT(sorted(pairs) == expected, "");
+    sap.find_pairs(pairs);
+    CX_ASSERT(sorted(pairs) == expected, "");
+
+    std::cout << "  Testing axis selection..." << std::endl;
+    SweepAndPrune column;
+    for (int i = 0; i < 500; i++) {
+      column.add({next(10), (float)i * 4, 3, 3});
+    }
+    column.find_pairs_parallel(pairs, 2);
+    CX_ASSERT(column.sweep_axis() == 1, "Boxes spread along y should be swept along y");
+    PairList single;
+    column.find_pairs(single);
+    CX_ASSERT(column.sweep_axis() == 0, "find_pairs() always sweeps along x");
+    CX_ASSERT(sorted(pairs) == sorted(single), "");
+    column.find_pairs_parallel(pairs, 1);
+    CX_ASSERT(column.sweep_axis() == 0 && sorted(pairs) == sorted(single), "One thread is the serial sweep");
+  }
+#  endif
+};
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_SWEEPANDPRUNE_H_
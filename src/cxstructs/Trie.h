@@ -32,6 +32,7 @@
 #  include <memory>
 #  include <string>
 #  include <vector>
+#  include "../cxallocator.h"
 #  include "../cxconfig.h"
 
 namespace cxhelper {
@@ -54,7 +55,7 @@ using namespace cxhelper;
  */
 
 class Trie {
-  using Allocator = CXPoolAllocator<TrieNode, sizeof(TrieNode) * 31, 1>;
+  using Allocator = CXPoolAllocator<TrieNode>;
   TrieNode* root;
   Allocator alloc;
   uint_32_cx size_;
@@ -0,0 +1,544 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_UNROLLEDLINKEDLIST_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_UNROLLEDLINKEDLIST_H_
+
+#  include "../cxconfig.h"
+#  include <cstddef>
+#  include <cstdint>
+#  include <iterator>
+#  include <memory>
+#  include <utility>
+#  include "../cxallocator.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <iostream>
+#    include <string>
+#    include <vector>
+#  endif
+
+namespace cxhelper {
+/**
+ * Node of an UnrolledLinkedList - the live elements are the contiguous range [begin_, end_) of the slots
+ */
+template <typename T, size_t ChunkBytes>
+struct UnrolledChunk {
+  struct Header {
+    void* next;
+    void* previous;
+    uint16_t begin;
+    uint16_t end;
+  };
+  static constexpr size_t STORAGE_OFFSET = (sizeof(Header) + alignof(T) - 1) & ~(alignof(T) - 1);
+  static constexpr uint16_t CAPACITY =
+      static_cast<uint16_t>(ChunkBytes > STORAGE_OFFSET + sizeof(T) ? (ChunkBytes - STORAGE_OFFSET) / sizeof(T) : 1);
+  static_assert(ChunkBytes <= STORAGE_OFFSET || (ChunkBytes - STORAGE_OFFSET) / sizeof(T) < 65536, "chunk too large");
+
+  UnrolledChunk* next_ = nullptr;
+  UnrolledChunk* previous_ = nullptr;
+  uint16_t begin_ = 0;
+  uint16_t end_ = 0;
+  alignas(T) unsigned char storage_[CAPACITY * sizeof(T)];
+
+  [[nodiscard]] inline T* slots() noexcept { return std::launder(reinterpret_cast<T*>(storage_)); }
+  [[nodiscard]] inline const T* slots() const noexcept { return std::launder(reinterpret_cast<const T*>(storage_)); }
+  [[nodiscard]] inline uint16_t size() const noexcept { return end_ - begin_; }
+};
+}  // namespace cxhelper
+
+namespace cxstructs {
+/**
+ * <h2>Unrolled Linked List</h2>
+ * A doubly linked list where every node (chunk) holds a small array of elements instead of a single one.<p>
+ * Each chunk is {@code ChunkBytes} large (a few cache lines) - so a traversal touches one cache line per
+ * many elements and an append allocates only once per chunk. Iteration and appending get close to a vec
+ * while keeping the list properties:
+ * <ul>
+ * <li>O(1) push and pop at both ends - never moves or invalidates other elements</li>
+ * <li>insert / erase in the middle only shift elements within one chunk - iterators into other chunks stay valid</li>
+ * <li>O(1) splice of whole lists (plus one chunk split when splicing into the middle of a chunk)</li>
+ * </ul>
+ * Chunks are allocated with the given allocator - the pool allocator per default.
+ * @tparam T value type
+ * @tparam ChunkBytes size of one chunk including its header
+ */
+template <typename T, size_t ChunkBytes = 256,
+          typename Allocator = CXPoolAllocator<cxhelper::UnrolledChunk<T, ChunkBytes>>>
+class UnrolledLinkedList {
+  using Chunk = cxhelper::UnrolledChunk<T, ChunkBytes>;
+  using ChunkAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>;
+  static constexpr uint16_t CAP = Chunk::CAPACITY;
+
+  ChunkAllocator alloc;
+  Chunk* head_ = nullptr;
+  Chunk* tail_ = nullptr;
+  uint32_t size_ = 0;
+
+  inline Chunk* new_chunk(uint16_t start) {
+    Chunk* chunk = alloc.allocate(1);
+    ::new (static_cast<void*>(chunk)) Chunk;  // default-init - leaves the slots uninitialized
+    chunk->begin_ = chunk->end_ = start;
+    return chunk;
+  }
+  inline void free_chunk(Chunk* chunk) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      std::destroy(chunk->slots() + chunk->begin_, chunk->slots() + chunk->end_);
+    }
+    alloc.deallocate(chunk, 1);
+  }
+  // Links chunk directly after pos (at the front if pos is nullptr)
+  inline void link_after(Chunk* pos, Chunk* chunk) noexcept {
+    chunk->previous_ = pos;
+    chunk->next_ = pos == nullptr ? head_ : pos->next_;
+    if (chunk->next_ != nullptr) {
+      chunk->next_->previous_ = chunk;
+    } else {
+      tail_ = chunk;
+    }
+    if (pos != nullptr) {
+      pos->next_ = chunk;
+    } else {
+      head_ = chunk;
+    }
+  }
+  inline void unlink(Chunk* chunk) noexcept {
+    if (chunk->previous_ != nullptr) {
+      chunk->previous_->next_ = chunk->next_;
+    } else {
+      head_ = chunk->next_;
+    }
+    if (chunk->next_ != nullptr) {
+      chunk->next_->previous_ = chunk->previous_;
+    } else {
+      tail_ = chunk->previous_;
+    }
+  }
+  // Moves [index, end) of a full chunk into a new chunk after it - returns the new chunk
+  Chunk* split(Chunk* chunk, uint16_t index) {
+    Chunk* right = new_chunk(0);
+    const uint16_t count = chunk->end_ - index;
+    std::uninitialized_move(chunk->slots() + index, chunk->slots() + chunk->end_, right->slots());
+    std::destroy(chunk->slots() + index, chunk->slots() + chunk->end_);
+    right->end_ = count;
+    chunk->end_ = index;
+    link_after(chunk, right);
+    return right;
+  }
+  // Moves the elements of chunk to [0, size) so there is room at the back
+  static void compact(Chunk* chunk) noexcept {
+    if (chunk->begin_ == 0) return;
+    T* slots = chunk->slots();
+    for (uint16_t i = chunk->begin_; i < chunk->end_; i++) {
+      ::new (static_cast<void*>(slots + i - chunk->begin_)) T(std::move(slots[i]));
+      slots[i].~T();
+    }
+    chunk->end_ -= chunk->begin_;
+    chunk->begin_ = 0;
+  }
+  void copy_from(const UnrolledLinkedList& o) {
+    for (const Chunk* chunk = o.head_; chunk != nullptr; chunk = chunk->next_) {
+      for (uint16_t i = chunk->begin_; i < chunk->end_; i++) {
+        emplace_back(chunk->slots()[i]);
+      }
+    }
+  }
+
+ public:
+  template <bool Const>
+  class IteratorBase {
+    friend class UnrolledLinkedList;
+    using ChunkPtr = std::conditional_t<Const, const Chunk*, Chunk*>;
+    ChunkPtr chunk_;
+    uint16_t index_;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    IteratorBase() noexcept : chunk_(nullptr), index_(0) {}
+    IteratorBase(ChunkPtr chunk, uint16_t index) noexcept : chunk_(chunk), index_(index) {}
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    IteratorBase(const IteratorBase<false>& o) noexcept  // NOLINT(*-explicit-constructor)
+        : chunk_(o.chunk_), index_(o.index_) {}
+
+    inline reference operator*() const noexcept { return chunk_->slots()[index_]; }
+    inline pointer operator->() const noexcept { return chunk_->slots() + index_; }
+    inline IteratorBase& operator++() noexcept {
+      if (++index_ == chunk_->end_) [[unlikely]] {
+        chunk_ = chunk_->next_;
+        index_ = chunk_ != nullptr ? chunk_->begin_ : 0;
+      }
+      return *this;
+    }
+    inline IteratorBase operator++(int) noexcept {
+      IteratorBase copy = *this;
+      ++*this;
+      return copy;
+    }
+    inline bool operator==(const IteratorBase& o) const noexcept {
+      return chunk_ == o.chunk_ && index_ == o.index_;
+    }
+    inline bool operator!=(const IteratorBase& o) const noexcept { return !(*this == o); }
+
+    template <bool>
+    friend class IteratorBase;
+  };
+  using iterator = IteratorBase<false>;
+  using const_iterator = IteratorBase<true>;
+
+  UnrolledLinkedList() = default;
+  UnrolledLinkedList(std::initializer_list<T> init) {
+    for (const auto& val : init) {
+      push_back(val);
+    }
+  }
+  UnrolledLinkedList(const UnrolledLinkedList& o) { copy_from(o); }
+  UnrolledLinkedList& operator=(const UnrolledLinkedList& o) {
+    if (this != &o) {
+      clear();
+      copy_from(o);
+    }
+    return *this;
+  }
+  UnrolledLinkedList(UnrolledLinkedList&& o) noexcept
+      : alloc(std::move(o.alloc)), head_(o.head_), tail_(o.tail_), size_(o.size_) {
+    o.head_ = o.tail_ = nullptr;
+    o.size_ = 0;
+  }
+  UnrolledLinkedList& operator=(UnrolledLinkedList&& o) noexcept {
+    if (this != &o) {
+      clear();
+      std::swap(head_, o.head_);
+      std::swap(tail_, o.tail_);
+      std::swap(size_, o.size_);
+    }
+    return *this;
+  }
+  ~UnrolledLinkedList() { clear(); }
+
+  /**
+   * Constructs a new element at the end of the list - O(1)
+   */
+  template <typename... Args>
+  inline T& emplace_back(Args&&... args) {
+    if (tail_ == nullptr || tail_->end_ == CAP) [[unlikely]] {
+      link_after(tail_, new_chunk(0));
+    }
+    T* slot = tail_->slots() + tail_->end_;
+    ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+    tail_->end_++;
+    size_++;
+    return *slot;
+  }
+  /**
+   * Constructs a new element at the front of the list - O(1)
+   */
+  template <typename... Args>
+  inline T& emplace_front(Args&&... args) {
+    if (head_ == nullptr || head_->begin_ == 0) [[unlikely]] {
+      link_after(nullptr, new_chunk(CAP));  // filled from the back so following push_fronts stay in it
+    }
+    T* slot = head_->slots() + head_->begin_ - 1;
+    ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+    head_->begin_--;
+    size_++;
+    return *slot;
+  }
+  inline void push_back(const T& val) { emplace_back(val); }
+  inline void push_back(T&& val) { emplace_back(std::move(val)); }
+  inline void push_front(const T& val) { emplace_front(val); }
+  inline void push_front(T&& val) { emplace_front(std::move(val)); }
+  inline void pop_back() noexcept {
+    CX_ASSERT(size_ > 0, "list is empty");
+    tail_->end_--;
+    tail_->slots()[tail_->end_].~T();
+    size_--;
+    if (tail_->size() == 0) {
+      Chunk* chunk = tail_;
+      unlink(chunk);
+      free_chunk(chunk);
+    }
+  }
+  inline void pop_front() noexcept {
+    CX_ASSERT(size_ > 0, "list is empty");
+    head_->slots()[head_->begin_].~T();
+    head_->begin_++;
+    size_--;
+    if (head_->size() == 0) {
+      Chunk* chunk = head_;
+      unlink(chunk);
+      free_chunk(chunk);
+    }
+  }
+  /**
+   * Inserts a new element before pos - shifts at most one chunk, splits it if it is full
+   * @return iterator to the new element
+   */
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    if (pos.chunk_ == nullptr) {
+      emplace_back(std::forward<Args>(args)...);
+      return {tail_, static_cast<uint16_t>(tail_->end_ - 1)};
+    }
+    auto* chunk = const_cast<Chunk*>(pos.chunk_);
+    uint16_t index = pos.index_;
+    if (chunk->size() == CAP) {
+      if (index == chunk->end_) {
+        chunk = new_chunk(0);
+        link_after(const_cast<Chunk*>(pos.chunk_), chunk);
+        index = 0;
+      } else {
+        Chunk* right = split(chunk, static_cast<uint16_t>(chunk->begin_ + chunk->size() / 2));
+        if (index >= chunk->end_) {
+          index = index - chunk->end_;
+          chunk = right;
+        }
+      }
+    }
+    if (chunk->end_ == CAP) {
+      const uint16_t offset = chunk->begin_;
+      compact(chunk);
+      index -= offset;
+    }
+    T* slots = chunk->slots();
+    if (index < chunk->end_) {
+      ::new (static_cast<void*>(slots + chunk->end_)) T(std::move(slots[chunk->end_ - 1]));
+      std::move_backward(slots + index, slots + chunk->end_ - 1, slots + chunk->end_);
+      slots[index] = T(std::forward<Args>(args)...);
+    } else {
+      ::new (static_cast<void*>(slots + index)) T(std::forward<Args>(args)...);
+    }
+    chunk->end_++;
+    size_++;
+    return {chunk, index};
+  }
+  iterator insert(const_iterator pos, const T& val) { return emplace(pos, val); }
+  iterator insert(const_iterator pos, T&& val) { return emplace(pos, std::move(val)); }
+  /**
+   * Removes the element at pos - shifts the rest of its chunk
+   * @return iterator to the element after the removed one
+   */
+  iterator erase(const_iterator pos) noexcept {
+    CX_ASSERT(pos.chunk_ != nullptr, "cannot erase end()");
+    auto* chunk = const_cast<Chunk*>(pos.chunk_);
+    T* slots = chunk->slots();
+    std::move(slots + pos.index_ + 1, slots + chunk->end_, slots + pos.index_);
+    chunk->end_--;
+    slots[chunk->end_].~T();
+    size_--;
+    if (chunk->size() == 0) {
+      Chunk* next = chunk->next_;
+      unlink(chunk);
+      free_chunk(chunk);
+      return {next, next != nullptr ? next->begin_ : static_cast<uint16_t>(0)};
+    }
+    if (pos.index_ == chunk->end_) {
+      return {chunk->next_, chunk->next_ != nullptr ? chunk->next_->begin_ : static_cast<uint16_t>(0)};
+    }
+    return {chunk, pos.index_};
+  }
+  /**
+   * Moves all elements of other before pos without copying them - other is left empty.
+   * O(1) at chunk boundaries (begin, end or the first element of a chunk), otherwise the chunk at pos is split.
+   * The allocators have to compare equal.
+   */
+  void splice(const_iterator pos, UnrolledLinkedList& other) {
+    CX_ASSERT(alloc == other.alloc, "splice needs equal allocators");
+    if (other.head_ == nullptr || &other == this) return;
+    Chunk* before;
+    if (pos.chunk_ == nullptr) {
+      before = tail_;
+    } else if (pos.index_ == pos.chunk_->begin_) {
+      before = pos.chunk_->previous_;
+    } else {
+      before = const_cast<Chunk*>(pos.chunk_);
+      split(before, pos.index_);
+    }
+    Chunk* after = before == nullptr ? head_ : before->next_;
+    other.head_->previous_ = before;
+    other.tail_->next_ = after;
+    if (before != nullptr) {
+      before->next_ = other.head_;
+    } else {
+      head_ = other.head_;
+    }
+    if (after != nullptr) {
+      after->previous_ = other.tail_;
+    } else {
+      tail_ = other.tail_;
+    }
+    size_ += other.size_;
+    other.head_ = other.tail_ = nullptr;
+    other.size_ = 0;
+  }
+  /**
+   * Destroys all elements and frees all chunks
+   */
+  void clear() noexcept {
+    for (Chunk* chunk = head_; chunk != nullptr;) {
+      Chunk* next = chunk->next_;
+      free_chunk(chunk);
+      chunk = next;
+    }
+    head_ = tail_ = nullptr;
+    size_ = 0;
+  }
+  [[nodiscard]] inline T& front() noexcept {
+    CX_ASSERT(size_ > 0, "list is empty");
+    return head_->slots()[head_->begin_];
+  }
+  [[nodiscard]] inline T& back() noexcept {
+    CX_ASSERT(size_ > 0, "list is empty");
+    return tail_->slots()[tail_->end_ - 1];
+  }
+  [[nodiscard]] inline const T& front() const noexcept { return head_->slots()[head_->begin_]; }
+  [[nodiscard]] inline const T& back() const noexcept { return tail_->slots()[tail_->end_ - 1]; }
+  [[nodiscard]] inline uint32_t size() const noexcept { return size_; }
+  [[nodiscard]] inline bool empty() const noexcept { return size_ == 0; }
+  // Number of elements one chunk holds
+  [[nodiscard]] static constexpr uint16_t chunk_capacity() noexcept { return CAP; }
+  /**
+   * Calls f on every element - walks each chunk as a plain array, faster than iterators
+   */
+  template <typename Func>
+  inline void for_each(Func f) {
+    for (Chunk* chunk = head_; chunk != nullptr; chunk = chunk->next_) {
+      T* slots = chunk->slots();
+      for (uint16_t i = chunk->begin_; i < chunk->end_; i++) {
+        f(slots[i]);
+      }
+    }
+  }
+  inline iterator begin() noexcept { return {head_, head_ != nullptr ? head_->begin_ : static_cast<uint16_t>(0)}; }
+  inline iterator end() noexcept { return {nullptr, 0}; }
+  inline const_iterator begin() const noexcept {
+    return {head_, head_ != nullptr ? head_->begin_ : static_cast<uint16_t>(0)};
+  }
+  inline const_iterator end() const noexcept { return {nullptr, 0}; }
+
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "TESTING UNROLLED LINKED LIST\n";
+
+    std::cout << "   Testing push and pop at both ends...\n";
+    UnrolledLinkedList<int> list;
+    for (int i = 0; i < 1000; i++) {
+      list.push_back(i);
+      list.push_front(-i - 1);
+    }
+    CX_ASSERT(list.size() == 2000 && list.front() == -1000 && list.back() == 999, "");
+    int expected = -1000;
+    for ([[maybe_unused]] int val : list) {
+      CX_ASSERT(val == expected, "");
+      expected++;
+    }
+    for (int i = 0; i < 500; i++) {
+      list.pop_front();
+      list.pop_back();
+    }
+    CX_ASSERT(list.size() == 1000 && list.front() == -500 && list.back() == 499, "");
+
+    std::cout << "   Testing iterator stability...\n";
+    auto it = list.begin();
+    for (int i = 0; i < 300; i++) ++it;
+    [[maybe_unused]] int* address = &*it;
+    for (int i = 0; i < 5000; i++) {
+      list.push_back(i);
+      list.push_front(i);
+    }
+    CX_ASSERT(&*it == address && *it == -200, "");
+    for (int i = 0; i < 5000; i++) {
+      list.pop_back();
+      list.pop_front();
+    }
+
+    std::cout << "   Testing insert and erase...\n";
+    UnrolledLinkedList<int, 64> small;
+    std::vector<int> reference;
+    for (int i = 0; i < 100; i++) {
+      small.push_back(i);
+      reference.push_back(i);
+    }
+    for (int i = 0; i < 200; i++) {
+      const int position = (i * 37) % (int)reference.size();
+      auto pos = small.begin();
+      for (int j = 0; j < position; j++) ++pos;
+      [[maybe_unused]] auto inserted = small.insert(pos, 1000 + i);
+      CX_ASSERT(*inserted == 1000 + i, "");
+      reference.insert(reference.begin() + position, 1000 + i);
+    }
+    for (int i = 0; i < 150; i++) {
+      const int position = (i * 13) % (int)reference.size();
+      auto pos = small.begin();
+      for (int j = 0; j < position; j++) ++pos;
+      [[maybe_unused]] auto next = small.erase(pos);
+      reference.erase(reference.begin() + position);
+      CX_ASSERT(next == small.end() || *next == reference[position], "");
+    }
+    CX_ASSERT(small.size() == reference.size(), "");
+    uint32_t index = 0;
+    for ([[maybe_unused]] int val : small) {
+      CX_ASSERT(val == reference[index++], "");
+    }
+
+    std::cout << "   Testing splice...\n";
+    UnrolledLinkedList<int, 64> a;
+    UnrolledLinkedList<int, 64> b;
+    for (int i = 0; i < 50; i++) a.push_back(i);
+    for (int i = 0; i < 20; i++) b.push_back(100 + i);
+    auto middle = a.begin();
+    for (int i = 0; i < 25; i++) ++middle;
+    a.splice(middle, b);
+    CX_ASSERT(b.empty() && a.size() == 70, "");
+    index = 0;
+    for ([[maybe_unused]] int val : a) {
+      [[maybe_unused]] const int want = index < 25 ? (int)index : index < 45 ? 100 + (int)index - 25 : (int)index - 20;
+      CX_ASSERT(val == want, "");
+      index++;
+    }
+    for (int i = 0; i < 5; i++) b.push_back(-1);
+    a.splice(a.begin(), b);
+    a.splice(a.end(), b);
+    CX_ASSERT(a.front() == -1 && a.size() == 75, "");
+
+    std::cout << "   Testing non-trivial types and copies...\n";
+    UnrolledLinkedList<std::string> strings;
+    for (int i = 0; i < 100; i++) {
+      strings.push_back(std::to_string(i));
+      strings.emplace_front(std::string(30, 'a'));
+    }
+    UnrolledLinkedList<std::string> copy = strings;
+    CX_ASSERT(copy.size() == 200 && copy.back() == "99" && copy.front() == std::string(30, 'a'), "");
+    strings.insert(strings.begin(), "first");
+    UnrolledLinkedList<std::string> moved = std::move(strings);
+    CX_ASSERT(strings.empty() && moved.front() == "first", "");
+    copy = moved;
+    CX_ASSERT(copy.size() == 201, "");
+    size_t total = 0;
+    copy.for_each([&](std::string& s) { total += s.size(); });
+    CX_ASSERT(total == 5 + 100 * 30 + 10 + 90 * 2, "");
+  }
+#  endif
+};
+}  // namespace cxstructs
+#endif  // CXSTRUCTS_SRC_CXSTRUCTS_UNROLLEDLINKEDLIST_H_
@@ -0,0 +1,446 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXSTRUCTS_WORKSTEALINGDEQUE_H_
+#  define CXSTRUCTS_SRC_CXSTRUCTS_WORKSTEALINGDEQUE_H_
+
+#  include "../cxconfig.h"
+#  include <atomic>
+#  include <condition_variable>
+#  include <cstdint>
+#  include <functional>
+#  include <memory>
+#  include <mutex>
+#  include <thread>
+#  include <vector>
+#  include "ConcurrentQueue.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <iostream>
+#  endif
+
+namespace cxstructs {
+
+/**
+ * @class WorkStealingDeque
+ * @brief Lock-free Chase-Lev work-stealing deque.
+ *
+ * Like the {@link DeQueue} the elements live in a circular array, but the two ends belong to different threads:
+ * the owner pushes and pops at the bottom (LIFO - hot in cache), any number of thieves steal from the top (FIFO -
+ * the oldest and usually biggest tasks). Only the race for the very last element needs a CAS.<p>
+ * The array doubles when full. Thieves may still read the old array, so it is retired and only freed with the deque.
+ * <p>
+ * Memory orderings follow Lê et al. "Correct and Efficient Work-Stealing for Weak Memory Models" and are correct on
+ * ARM and POWER, not only on x86.<p>
+ * T has to be trivially copyable (task pointers, indices) - slots are read speculatively by thieves.
+ */
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque elements have to be trivially copyable");
+  static constexpr size_t CACHE_LINE = 64;
+
+  struct Ring {
+    int64_t capacity;
+    int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+
+    explicit Ring(int64_t len) : capacity(len), mask(len - 1), slots(new std::atomic<T>[len]) {}
+    [[nodiscard]] inline T get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+    inline void put(int64_t i, T val) { slots[i & mask].store(val, std::memory_order_relaxed); }
+  };
+
+  alignas(CACHE_LINE) std::atomic<int64_t> top_{0};  // Thieves
+  alignas(CACHE_LINE) std::atomic<int64_t> bottom_{0};
+  std::atomic<Ring*> ring_;
+  std::vector<std::unique_ptr<Ring>> rings_;  // Owner only - current and retired arrays
+
+  inline Ring* grow(Ring* old, int64_t bottom, int64_t top) {
+    rings_.push_back(std::make_unique<Ring>(old->capacity * 2));
+    Ring* ring = rings_.back().get();
+    for (int64_t i = top; i < bottom; ++i) {
+      ring->put(i, old->get(i));
+    }
+    ring_.store(ring, std::memory_order_release);
+    return ring;
+  }
+
+ public:
+  /**
+   * @param capacity initial capacity - rounded up to a power of two, grows on demand
+   */
+  explicit WorkStealingDeque(int64_t capacity = 256) {
+    int64_t len = 2;
+    while (len < capacity) len <<= 1;
+    rings_.push_back(std::make_unique<Ring>(len));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  /**
+   * Owner only. Adds an element at the bottom
+   */
+  inline void push(T val) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    if (bottom - top > ring->capacity - 1) {
+      ring = grow(ring, bottom, top);
+    }
+    ring->put(bottom, val);
+    // Release store instead of the paper's release fence + relaxed store - same cost and visible to TSan
+    bottom_.store(bottom + 1, std::memory_order_release);
+  }
+  /**
+   * Owner only. Removes the newest element
+   * @return false if the deque is empty (or a thief took the last element)
+   */
+  inline bool pop(T& out) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring* ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    out = ring->get(bottom);
+    if (top == bottom) {
+      // Last element - race the thieves for it
+      const bool won =
+          top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+  /**
+   * Any thread. Removes the oldest element
+   * @return false if the deque is empty or another thread won the race for the element
+   */
+  inline bool steal(T& out) {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) return false;
+    // Acquire instead of consume - compilers promote consume anyway
+    const T val = ring_.load(std::memory_order_acquire)->get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return false;
+    }
+    out = val;
+    return true;
+  }
+  /**
+   * @return the number of elements - a snapshot while other threads are active
+   */
+  [[nodiscard]] inline size_t size() const {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+  [[nodiscard]] inline bool empty() const { return size() == 0; }
+  [[nodiscard]] inline size_t capacity() const { return ring_.load(std::memory_order_relaxed)->capacity; }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "WORK STEALING DEQUE TESTS" << std::endl;
+    std::cout << "  Testing owner and thief ends..." << std::endl;
+    WorkStealingDeque<int> d(4);
+    int val = -1;
+    [[maybe_unused]] bool ownerPop = d.pop(val);
+    [[maybe_unused]] bool thiefSteal = d.steal(val);
+    CX_ASSERT(d.empty() && !ownerPop && !thiefSteal, "");
+    for (int i = 0; i < 100; i++) {
+      d.push(i);
+    }
+    CX_ASSERT(d.size() == 100 && d.capacity() == 128, "");
+    ownerPop = d.pop(val);
+    CX_ASSERT(ownerPop && val == 99, "Owner pops the newest");
+    thiefSteal = d.steal(val);
+    CX_ASSERT(thiefSteal && val == 0, "Thieves take the oldest");
+    for (int i = 98; i > 0; i--) {
+      ownerPop = d.pop(val);
+      CX_ASSERT(ownerPop && val == i, "");
+    }
+    ownerPop = d.pop(val);
+    CX_ASSERT(d.empty() && !ownerPop, "");
+
+    std::cout << "  Testing concurrent steals..." << std::endl;
+    constexpr int COUNT = 100000;
+    constexpr int THIEVES = 3;
+    WorkStealingDeque<int> shared(8);
+    std::atomic<bool> done{false};
+    std::vector<std::vector<int>> stolen(THIEVES);
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < THIEVES; t++) {
+      thieves.emplace_back([&, t] {
+        int v;
+        while (!done.load(std::memory_order_acquire) || !shared.empty()) {
+          if (shared.steal(v)) stolen[t].push_back(v);
+        }
+      });
+    }
+    std::vector<int> owned;
+    for (int i = 0; i < COUNT; i++) {
+      shared.push(i);
+      if (i % 3 == 0 && shared.pop(val)) owned.push_back(val);
+    }
+    while (shared.pop(val)) {
+      owned.push_back(val);
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thief : thieves) {
+      thief.join();
+    }
+    std::vector<int> seen(COUNT, 0);
+    for (int v : owned) seen[v]++;
+    for (const auto& s : stolen) {
+      for (int v : s) seen[v]++;
+    }
+    for (int i = 0; i < COUNT; i++) {
+      CX_ASSERT(seen[i] == 1, "Every element is taken exactly once");
+    }
+  }
+#  endif
+};
+
+/**
+ * @class WorkStealingPool
+ * @brief Small work-stealing thread pool.
+ *
+ * Every worker owns a {@link WorkStealingDeque}. Jobs submitted from a worker go to its own deque (so recursive
+ * splitting stays local), jobs from other threads go to a shared {@link MPMCQueue}. An idle worker first drains its
+ * own deque, then the shared queue and then steals from random victims before it goes to sleep.<p>
+ * wait_for() lets the calling thread execute jobs while it waits, so waiting inside a job cannot deadlock the pool.
+ *
+ * <h2>Usage</h2>
+ * <pre>
+ * WorkStealingPool pool;
+ * std::atomic&lt;uint32_t&gt; remaining{2};
+ * pool.submit([&] { left(); remaining--; });
+ * pool.submit([&] { right(); remaining--; });
+ * pool.wait_for(remaining);
+ * </pre>
+ */
+class WorkStealingPool {
+ public:
+  using Job = std::function<void()>;
+
+ private:
+  static constexpr int SPINS_BEFORE_SLEEP = 64;
+
+  struct alignas(64) Worker {
+    WorkStealingDeque<Job*> deque;
+    std::thread thread;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  MPMCQueue<Job*> injected_;
+  std::atomic<int64_t> pending_{0};  // Submitted but not yet started
+  std::atomic<uint32_t> sleeping_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex mutex_;
+  std::condition_variable wake_;
+
+  static inline thread_local WorkStealingPool* currentPool_ = nullptr;
+  static inline thread_local uint32_t currentIndex_ = 0;
+  static inline thread_local uint32_t rng_ = 0x9E3779B9U;
+
+  inline Job* find_job() {
+    Job* job = nullptr;
+    const bool isWorker = currentPool_ == this;
+    if (isWorker && workers_[currentIndex_]->deque.pop(job)) return job;
+    if (injected_.try_pop(job)) return job;
+    const auto count = (uint32_t)workers_.size();
+    for (uint32_t i = 0; i < count; ++i) {
+      rng_ ^= rng_ << 13;
+      rng_ ^= rng_ >> 17;
+      rng_ ^= rng_ << 5;
+      const uint32_t victim = rng_ % count;
+      if (isWorker && victim == currentIndex_) continue;
+      if (workers_[victim]->deque.steal(job)) return job;
+    }
+    return nullptr;
+  }
+  inline void run(Job* job) {
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    (*job)();
+    delete job;
+  }
+  inline void worker_loop(uint32_t index, const std::function<void(uint32_t)>& onStart) {
+    currentPool_ = this;
+    currentIndex_ = index;
+    if (onStart) onStart(index);
+    rng_ += index * 0x632BE5ABU;
+    int idle = 0;
+    while (true) {
+      if (Job* job = find_job()) {
+        run(job);
+        idle = 0;
+        continue;
+      }
+      if (++idle < SPINS_BEFORE_SLEEP) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      sleeping_.fetch_add(1, std::memory_order_seq_cst);
+      wake_.wait(lock, [this] {
+        return pending_.load(std::memory_order_seq_cst) > 0 || stop_.load(std::memory_order_relaxed);
+      });
+      sleeping_.fetch_sub(1, std::memory_order_relaxed);
+      if (stop_.load(std::memory_order_relaxed) && pending_.load(std::memory_order_relaxed) <= 0) return;
+      idle = 0;
+    }
+  }
+
+ public:
+  /**
+   * @param threadCount number of worker threads - at least one
+   * @param onStart optional - called on each worker thread with its index before it takes jobs (pinning, naming)
+   */
+  explicit WorkStealingPool(uint32_t threadCount = std::thread::hardware_concurrency(),
+                            std::function<void(uint32_t)> onStart = {})
+      : injected_(1024) {
+    threadCount = std::max(threadCount, 1U);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < threadCount; ++i) {
+      workers_[i]->thread = std::thread([this, i, onStart] { worker_loop(i, onStart); });
+    }
+  }
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+  /**
+   * Runs all submitted jobs and joins the workers
+   */
+  ~WorkStealingPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_.store(true, std::memory_order_relaxed);
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker->thread.join();
+    }
+  }
+  /**
+   * Schedules a job. From a worker of this pool it goes to the worker's own deque, otherwise to the shared queue
+   */
+  inline void submit(Job job) {
+    Job* ptr = new Job(std::move(job));
+    pending_.fetch_add(1, std::memory_order_seq_cst);
+    if (currentPool_ == this) {
+      workers_[currentIndex_]->deque.push(ptr);
+    } else {
+      injected_.push(ptr);
+    }
+    if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      wake_.notify_one();
+    }
+  }
+  /**
+   * Runs one pending job on the calling thread
+   * @return false if no job could be found
+   */
+  inline bool try_run_one() {
+    Job* job = find_job();
+    if (job == nullptr) return false;
+    run(job);
+    return true;
+  }
+  /**
+   * Executes pending jobs until the counter reaches zero - safe to call from inside a job
+   * @param remaining counter the jobs decrement when they finish
+   */
+  template <typename Counter>
+  inline void wait_for(const std::atomic<Counter>& remaining) {
+    while (remaining.load(std::memory_order_acquire) != 0) {
+      if (!try_run_one()) std::this_thread::yield();
+    }
+  }
+  /**
+   * @return the number of worker threads
+   */
+  [[nodiscard]] inline uint32_t size() const { return (uint32_t)workers_.size(); }
+  /**
+   * @return true if the calling thread is a worker of this pool
+   */
+  [[nodiscard]] inline bool is_worker() const { return currentPool_ == this; }
+#  ifdef CX_INCLUDE_TESTS
+  static void TEST() {
+    std::cout << "WORK STEALING POOL TESTS" << std::endl;
+    std::cout << "  Testing submit and wait..." << std::endl;
+    WorkStealingPool pool(4);
+    CX_ASSERT(pool.size() == 4 && !pool.is_worker(), "");
+    std::atomic<uint32_t> remaining{2000};
+    std::atomic<uint64_t> sum{0};
+    for (uint32_t i = 0; i < 2000; i++) {
+      pool.submit([&, i] {
+        sum.fetch_add(i, std::memory_order_relaxed);
+        remaining.fetch_sub(1, std::memory_order_release);
+      });
+    }
+    pool.wait_for(remaining);
+    CX_ASSERT(sum.load() == 1999 * 2000 / 2, "");
+
+    std::cout << "  Testing nested jobs..." << std::endl;
+    // Recursive splitting - jobs wait for their children inside the pool
+    std::function<uint64_t(uint32_t, uint32_t)> rangeSum = [&](uint32_t lo, uint32_t hi) -> uint64_t {
+      if (hi - lo <= 64) {
+        uint64_t s = 0;
+        for (uint32_t i = lo; i < hi; i++) s += i;
+        return s;
+      }
+      const uint32_t mid = lo + (hi - lo) / 2;
+      uint64_t left = 0;
+      std::atomic<int> child{1};
+      pool.submit([&] {
+        left = rangeSum(lo, mid);
+        child.fetch_sub(1, std::memory_order_release);
+      });
+      const uint64_t right = rangeSum(mid, hi);
+      pool.wait_for(child);
+      return left + right;
+    };
+    std::atomic<int> root{1};
+    uint64_t total = 0;
+    pool.submit([&] {
+      total = rangeSum(0, 100000);
+      root.fetch_sub(1, std::memory_order_release);
+    });
+    pool.wait_for(root);
+    CX_ASSERT(total == 99999ULL * 100000 / 2, "");
+
+    std::cout << "  Testing shutdown runs pending jobs..." << std::endl;
+    std::atomic<int> ran{0};
+    {
+      WorkStealingPool small(2);
+      for (int i = 0; i < 100; i++) {
+        small.submit([&] { ran.fetch_add(1, std::memory_order_relaxed); });
+      }
+    }
+    CX_ASSERT(ran.load() == 100, "");
+  }
+#  endif
+};
+}  // namespace cxstructs
+#endif  //CXSTRUCTS_SRC_CXSTRUCTS_WORKSTEALINGDEQUE_H_
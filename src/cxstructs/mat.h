@@ -24,6 +24,7 @@
 
 #  include "../cxconfig.h"
 #  include <cmath>
+#  include "../cxallocator.h"
 #  include "vec.h"
 
 namespace cxstructs {
@@ -40,16 +41,23 @@ namespace cxstructs {
     A 2D Matrix is essential in various applications such as graphics transformations, solving systems of linear equations, and data analysis. The flattened array representation ensures that the elements are stored in a contiguous block of memory, which is beneficial for cache performance.<p>
 
     <b>Use Cases:</b> 2D Matrices are widely used in linear algebra, image processing, computer graphics, and scientific computing.
+    <br><br>
+    <b>Memory:</b> Large matrices (>= CX_HUGE_PAGE_THRESHOLD) are backed by huge pages via the HugePageAllocator.
     */
 class mat {
   float* arr;
   uint_32_cx n_rows_;
   uint_32_cx n_cols_;
 
+  inline static float* allocate(uint_32_cx n) { return HugePageAllocator<float>().allocate(n); }
+  inline static void deallocate(float* ptr, uint_32_cx n) noexcept {
+    if (ptr != nullptr) HugePageAllocator<float>().deallocate(ptr, n);
+  }
+
  public:
   inline mat() : n_cols_(0), n_rows_(0), arr(nullptr){};
   inline mat(std::initializer_list<float> list) : n_rows_(1), n_cols_((uint_32_cx)list.size()) {
-    arr = new float[n_cols_];
+    arr = allocate(n_cols_);
     uint32_t i = 0;
     for (float val : list) {
       arr[i++] = val;
@@ -57,7 +65,7 @@ class mat {
   }
   inline mat(std::initializer_list<std::initializer_list<float>> list)
       : n_rows_((uint_32_cx)list.size()), n_cols_((uint_32_cx)list.begin()->size()) {
-    arr = new float[n_rows_ * n_cols_];
+    arr = allocate(n_rows_ * n_cols_);
     uint32_t i = 0;
     for (const auto& sublist : list) {
       for (float val : sublist) {
@@ -73,13 +81,13 @@ class mat {
    */
   inline mat(const uint_32_cx& n_rows, const uint_32_cx& n_cols)
       : n_rows_(n_rows), n_cols_(n_cols) {
-    arr = new float[n_rows * n_cols];
+    arr = allocate(n_rows * n_cols);
     std::fill(arr, arr + n_rows * n_cols, 0);
   }
 
   inline explicit mat(std::vector<std::vector<float>> vec)
       : n_rows_(vec.size()), n_cols_((uint_32_cx)vec[0].size()) {
-    arr = new float[n_rows_ * n_cols_];
+    arr = allocate(n_rows_ * n_cols_);
     for (uint_32_cx i = 0; i < n_rows_; i++) {
       std::copy_n(vec[i].begin(), n_cols_, arr + i * n_cols_);
     }
@@ -97,7 +105,7 @@ class mat {
             typename = std::enable_if_t<std::is_invocable_r_v<double, fill_form, double>>>
   inline mat(uint_32_cx n_rows, uint_32_cx n_cols, fill_form form)
       : n_rows_(n_rows), n_cols_(n_cols) {
-    arr = new float[n_rows * n_cols];
+    arr = allocate(n_rows * n_cols);
     for (int i = 0; i < n_rows * n_cols; i++) {
       arr[i] = form(i);
     }
@@ -110,14 +118,14 @@ class mat {
    * @param cols
    */
   inline mat(float* data, uint_32_cx rows, uint_32_cx cols)
-      : n_rows_(rows), n_cols_(cols), arr(new float[rows * cols]) {
+      : n_rows_(rows), n_cols_(cols), arr(allocate(rows * cols)) {
     std::copy(data, data + rows * cols, arr);
   }
   inline mat(const mat& o) : n_rows_(o.n_rows_), n_cols_(o.n_cols_) {
-    arr = new float[n_rows_ * n_cols_];
+    arr = allocate(n_rows_ * n_cols_);
     std::copy(o.arr, o.arr + n_rows_ * n_cols_, arr);
   }
-  inline ~mat() { delete[] arr; };
+  inline ~mat() { deallocate(arr, n_rows_ * n_cols_); };
   inline float& operator()(const uint_32_cx& row, const uint_32_cx& col) {
     return arr[row * n_cols_ + col];
   }
@@ -132,15 +140,16 @@ class mat {
    * @return a pointer to the underlying array
    */
   float* get_raw() { return arr; }
+  [[nodiscard]] const float* get_raw() const { return arr; }
   //assign
   inline mat& operator=(const mat& other) {
     if (this != &other) {
-      delete[] arr;
+      deallocate(arr, n_rows_ * n_cols_);
 
       n_rows_ = other.n_rows_;
       n_cols_ = other.n_cols_;
 
-      arr = new float[n_rows_ * n_cols_];
+      arr = allocate(n_rows_ * n_cols_);
       std::copy(other.arr, other.arr + n_rows_ * n_cols_, arr);
     }
     return *this;
@@ -449,8 +458,8 @@ class mat {
   /**Prints out the matrix
    * @param header optional header
    */
-  void print(const char* name = "") const {
-    if (!header.empty()) {
+  void print(const char* header = "") const {
+    if (header[0] != '\0') {
       std::cout << header << std::endl;
       for (uint_32_cx i = 0; i < n_rows_; i++) {
         std::cout << "     [";
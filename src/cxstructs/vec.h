@@ -21,9 +21,22 @@
 #ifndef CXSTRUCTS_ARRAYLIST_H
 #  define CXSTRUCTS_ARRAYLIST_H
 
+#  include <cstddef>
+#  include <cstdlib>
+#  include <cstring>
 #  include <initializer_list>
+#  include <limits>
+#  include <memory>
 #  include "../cxalgos/Sorting.h"
 #  include "../cxconfig.h"
+#  ifdef CX_INCLUDE_TESTS
+#    include <string>
+#  endif
+
+// Capacity multiplier when a vec runs full - smaller factors waste less memory, larger ones copy less often
+#  ifndef CX_VEC_GROWTH_FACTOR
+#    define CX_VEC_GROWTH_FACTOR 2.0
+#  endif
 
 /*This implementation is well optimized and should generally be a bit faster than the std::vector in a lot of use cases
  * Its using explicit allocator syntax to switch between the default and a custom one
@@ -31,12 +44,30 @@
 */
 
 namespace cxstructs {
+/**
+ * Marks types that can be moved to a new address with a plain memcpy (and the old bytes simply forgotten).<p>
+ * True for all trivially copyable types. Most types that do not point into themselves qualify as well -
+ * specialize it for them: {@code template <> struct is_trivially_relocatable<MyType> : std::true_type {};}<p>
+ * Do NOT specialize it for types holding pointers to their own members (e.g. std::string with small buffer).
+ */
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T>> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 /**
  * <h2>vec</h2>
  * This is an implementation of a dynamic array data structure, similar to the <code>ArrayList</code> in Java or <code>std::vector</code> in C++.
  * <br><br>
  * <p>A dynamic array is a random access, variable-n_elem list data structure that allows elements to be added or removed.
  * It provides the capability to index into the list, push_back elements to the end, and erase elements from the end in a time-efficient manner.</p>
+ * Only the elements [0, size) are constructed - spare capacity is raw memory. Growing multiplies the capacity by
+ * CX_VEC_GROWTH_FACTOR. Trivially relocatable types are moved with memcpy, and with the default allocator the buffer
+ * is managed with malloc/realloc so it can often grow in place (glibc uses mremap for large blocks).
  */
 template <typename T, typename Allocator = std::allocator<T>, typename size_type = uint32_t>
 class vec {
@@ -53,47 +84,62 @@ class vec {
   size_type size_;
   size_type capacity_;
 
-  inline void grow() noexcept {
-    capacity_ *= 2;
-
-    T* n_arr = alloc.allocate(capacity_);
+  // realloc only works on malloc'ed memory - used when we own the allocation strategy
+  static constexpr bool USE_REALLOC = std::is_same_v<Allocator, std::allocator<T>> && is_trivially_relocatable_v<T>
+                                      && alignof(T) <= alignof(std::max_align_t);
 
-    std::uninitialized_move(arr_, arr_ + size_, n_arr);
-
-    // Destroy the original objects
-    if constexpr (!std::is_trivial_v<T>) {
-      for (size_type i = 0; i < size_; i++) {
-        std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-      }
+  inline T* allocate(size_type n) noexcept {
+    if constexpr (USE_REALLOC) {
+      auto* ptr = static_cast<T*>(std::malloc(static_cast<size_t>(n) * sizeof(T)));
+      if (ptr == nullptr && n > 0) std::abort();
+      return ptr;
+    } else {
+      return alloc.allocate(n);
     }
-
-    alloc.deallocate(arr_, capacity_);
-    arr_ = n_arr;
-
-    if constexpr (!std::is_trivial_v<T>) {
-      for (uint_fast32_t i = size_; i < capacity_; i++) {
-        std::allocator_traits<Allocator>::construct(alloc, &arr_[i]);
-      }
+  }
+  inline void deallocate(T* ptr, size_type n) noexcept {
+    if constexpr (USE_REALLOC) {
+      std::free(ptr);
+    } else if (ptr != nullptr) {
+      alloc.deallocate(ptr, n);
     }
   }
-  inline void shrink() noexcept {
-    auto old_len = capacity_;
-    capacity_ = size_ * 1.5;
-
-    T* n_arr = alloc.allocate(capacity_);
-
-    std::uninitialized_move(arr_, arr_ + size_, n_arr);
-
-    // Destroy the original objects
-    if constexpr (!std::is_trivial_v<T>) {
-      for (size_t i = 0; i < old_len; i++) {
+  inline void destroy(size_type from, size_type to) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_type i = from; i < to; i++) {
         std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
       }
     }
-
-    alloc.deallocate(arr_, old_len);
-    arr_ = n_arr;
   }
+  // Moves the live elements into a buffer of the given capacity
+  inline void relocate(size_type newCapacity) noexcept {
+    CX_ASSERT(newCapacity >= size_, "relocation would drop elements");
+    if constexpr (USE_REALLOC) {
+      auto* ptr = static_cast<T*>(std::realloc(static_cast<void*>(arr_), std::max<size_t>(newCapacity, 1) * sizeof(T)));
+      if (ptr == nullptr) std::abort();
+      arr_ = ptr;
+    } else {
+      T* n_arr = allocate(newCapacity);
+      if constexpr (is_trivially_relocatable_v<T>) {
+        if (size_ > 0) std::memcpy(static_cast<void*>(n_arr), static_cast<void*>(arr_), size_ * sizeof(T));
+      } else {
+        std::uninitialized_move(arr_, arr_ + size_, n_arr);
+        destroy(0, size_);
+      }
+      deallocate(arr_, capacity_);
+      arr_ = n_arr;
+    }
+    capacity_ = newCapacity;
+  }
+  inline void grow(size_type minCapacity = 0) noexcept {
+    constexpr size_type MAX_CAPACITY = std::numeric_limits<size_type>::max();
+    CX_ASSERT(capacity_ < MAX_CAPACITY, "vec is at its maximum capacity");
+    // Saturate instead of casting an out of range double
+    const double scaled = static_cast<double>(capacity_) * CX_VEC_GROWTH_FACTOR;
+    const size_type next = scaled >= static_cast<double>(MAX_CAPACITY) ? MAX_CAPACITY : static_cast<size_type>(scaled);
+    relocate(std::max({next, static_cast<size_type>(capacity_ + 1), minCapacity}));
+  }
+  inline void shrink() noexcept { relocate(static_cast<size_type>(size_ * 1.5)); }
 
  public:
   /**
@@ -101,16 +147,9 @@ class vec {
    * Recommended to leave it at 32 due to optimizations with the allocator
    * @param n_elem number of starting elements
    */
-  inline explicit vec(uint_32_cx n_elems = 32)
-      : capacity_(n_elems), size_(0), arr_(alloc.allocate(n_elems)) {
-    if constexpr (!std::is_trivial_v<T>) {
-      for (uint_fast32_t i = 0; i < n_elems; i++) {
-        std::allocator_traits<Allocator>::construct(alloc, &arr_[i]);
-      }
-    }
-  }
+  inline explicit vec(uint_32_cx n_elems = 32) : capacity_(n_elems), size_(0), arr_(allocate(n_elems)) {}
   inline vec(uint_32_cx n_elems, const T fillVal)
-      : capacity_(n_elems), size_(n_elems), arr_(alloc.allocate(n_elems)) {
+      : capacity_(n_elems), size_(n_elems), arr_(allocate(n_elems)) {
     if constexpr (std::is_trivial_v<T>) {
       std::fill(arr_, arr_ + n_elems, fillVal);
     } else {
@@ -129,7 +168,7 @@ class vec {
   template <typename fill_form,
             typename = std::enable_if_t<std::is_invocable_r_v<T, fill_form, int>>>
   inline vec(uint_32_cx n_elem, fill_form form)
-      : capacity_(n_elem), size_(n_elem), arr_(alloc.allocate(n_elem)) {
+      : capacity_(n_elem), size_(n_elem), arr_(allocate(n_elem)) {
     for (uint_fast32_t i = 0; i < n_elem; i++) {
       std::allocator_traits<Allocator>::construct(alloc, &arr_[i], form(i));
     }
@@ -140,14 +179,12 @@ class vec {
    * @param vector
    */
   explicit vec(const std::vector<T>& vector)
-      : capacity_(vector.size() * 1.5), size_(vector.size()),
-        arr_(alloc.allocate(vector.size() * 1.5)) {
-    std::copy(vector.begin(), vector.end(), arr_);
+      : capacity_(vector.size() * 1.5), size_(vector.size()), arr_(allocate(vector.size() * 1.5)) {
+    std::uninitialized_copy(vector.begin(), vector.end(), arr_);
   }
   explicit vec(const std::vector<T>&& move_vector)
-      : capacity_(move_vector.size() * 1.5), size_(move_vector.size()),
-        arr_(alloc.allocate(move_vector.size() * 1.5)) {
-    std::move(move_vector.begin(), move_vector.end(), arr_);
+      : capacity_(move_vector.size() * 1.5), size_(move_vector.size()), arr_(allocate(move_vector.size() * 1.5)) {
+    std::uninitialized_copy(move_vector.begin(), move_vector.end(), arr_);
   }
   /**
    * Constructs a new vector by copying from the given pointer
@@ -156,8 +193,8 @@ class vec {
    * @param n_elem
    */
   inline explicit vec(T* data, uint_32_cx n_elem) : size_(n_elem), capacity_(n_elem * 2) {
-    arr_ = new T[capacity_];
-    std::copy(data, data + n_elem, arr_);
+    arr_ = allocate(capacity_);
+    std::uninitialized_copy(data, data + n_elem, arr_);
   }
   /**
    * Initializer list constructor<p>
@@ -167,7 +204,7 @@ class vec {
    */
   inline vec(std::initializer_list<T> init_list)
       : size_(init_list.size()), capacity_(init_list.size() * 10),
-        arr_(alloc.allocate(init_list.size() * 10)) {
+        arr_(allocate(init_list.size() * 10)) {
     if (std::is_trivial_v<T>) {
       std::copy(init_list.begin(), init_list.end(), arr_);
     } else {
@@ -179,7 +216,7 @@ class vec {
     }
   }
   inline vec(const vec<T>& o) : size_(o.size_), capacity_(o.capacity_) {
-    arr_ = alloc.allocate(capacity_);
+    arr_ = allocate(capacity_);
     if (std::is_trivial_v<T>) {
       std::copy(o.arr_, o.arr_ + o.size_, arr_);
     } else {
@@ -188,16 +225,12 @@ class vec {
   }
   inline vec& operator=(const vec<T>& o) {
     if (this != &o) {
-      if constexpr (!std::is_trivial_v<T>) {
-        for (uint_32_cx i = 0; i < capacity_; i++) {
-          std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-        }
-      }
-      alloc.deallocate(arr_, capacity_);
+      destroy(0, size_);
+      deallocate(arr_, capacity_);
 
       size_ = o.size_;
       capacity_ = o.capacity_;
-      arr_ = alloc.allocate(capacity_);
+      arr_ = allocate(capacity_);
 
       if (std::is_trivial_v<T>) {
         std::copy(o.arr_, o.arr_ + o.size_, arr_);
@@ -209,35 +242,31 @@ class vec {
   }
   //move constructor
   inline vec(vec&& o) noexcept : arr_(o.arr_), size_(o.size_), capacity_(o.capacity_) {
-    //leve other in previous state
+    // other is left empty
     o.arr_ = nullptr;  // PREVENT DOUBLE DELETION!
+    o.size_ = 0;
+    o.capacity_ = 0;
   }
   //move assignment
   vec& operator=(vec&& o) noexcept {
     if (this != &o) {
-      if (!std::is_trivial_v<T>) {
-        for (uint_32_cx i = 0; i < capacity_; i++) {
-          std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-        }
-      }
-      alloc.deallocate(arr_, capacity_);
+      destroy(0, size_);
+      deallocate(arr_, capacity_);
 
       arr_ = o.arr_;
       size_ = o.size_;
       capacity_ = o.capacity_;
 
-      //other is left in previous state but invalidated
+      // other is left empty
       o.arr_ = nullptr;  // PREVENT DOUBLE DELETION!
+      o.size_ = 0;
+      o.capacity_ = 0;
     }
     return *this;
   }
   inline ~vec() {
-    if (!std::is_trivial_v<T>) {
-      for (uint_32_cx i = 0; i < size_; i++) {
-        std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-      }
-    }
-    alloc.deallocate(arr_, capacity_);
+    destroy(0, size_);
+    deallocate(arr_, capacity_);
   }
   /**
    * Direct access to the underlying array
@@ -268,10 +297,13 @@ class vec {
    * @param e the element to be added
    */
   inline void push_back(const T& e) noexcept {
-    if (size_ == capacity_) {
+    if (size_ == capacity_) [[unlikely]] {
+      T copy(e);  // e might live inside the buffer that is about to move
       grow();
+      std::allocator_traits<Allocator>::construct(alloc, &arr_[size_++], std::move(copy));
+      return;
     }
-    arr_[size_++] = e;
+    std::allocator_traits<Allocator>::construct(alloc, &arr_[size_++], e);
   }
   [[nodiscard]] inline T& front() const noexcept { return arr_[0]; }
   [[nodiscard]] inline T& back() const noexcept { return arr_[size_ - 1]; }
@@ -281,7 +313,7 @@ class vec {
    */
   template <typename... Args>
   inline void emplace_back(Args&&... args) noexcept {
-    if (size_ == capacity_) {
+    if (size_ == capacity_) [[unlikely]] {
       grow();
     }
     std::allocator_traits<Allocator>::construct(alloc, &arr_[size_++], std::forward<Args>(args)...);
@@ -304,9 +336,7 @@ class vec {
   inline void pop_back() noexcept {
     CX_ASSERT(size_ > 0, "out of bounds");
     size_--;
-    if (!std::is_trivial_v<T>) {
-      std::allocator_traits<Allocator>::destroy(alloc, &arr_[size_]);
-    }
+    destroy(size_, size_ + 1);
   }
   /**
    * Removes the first element of the vec<p>
@@ -315,10 +345,8 @@ class vec {
    */
   inline void pop_front() noexcept {
     CX_ASSERT(size_ > 0, "out of bounds");
-    if (!std::is_trivial_v<T>) {
-      std::allocator_traits<Allocator>::destroy(alloc, &arr_[0]);
-    }
-    std::move(arr_ + 1, arr_ + size_--, arr_);
+    std::move(arr_ + 1, arr_ + size_, arr_);
+    pop_back();
   }
   /**
    * Removes the element at index i of the vec<p>
@@ -327,10 +355,8 @@ class vec {
    */
   inline void pop(const uint_32_cx& i) noexcept {
     CX_ASSERT(i < size_, "out of bounds");
-    if (!std::is_trivial_v<T>) {
-      std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-    }
-    std::move(arr_ + i + 1, arr_ + size_--, arr_ + i);
+    std::move(arr_ + i + 1, arr_ + size_, arr_ + i);
+    pop_back();
   }
   /**
    * Removes the first occurrence of the given element from the list
@@ -338,20 +364,20 @@ class vec {
    */
   inline void erase(const T& e) noexcept {
 #  pragma omp simd linear(i : 1)
-    for (uint_32_cx i = 0; i < capacity_; i++) {
+    for (uint_32_cx i = 0; i < size_; i++) {
       if (arr_[i] == e) {
         std::move(arr_ + i + 1, arr_ + size_, arr_ + i);
-        size_--;
+        pop_back();
         return;
       }
     }
   }
   template <typename lambda>
   inline void erase_if(lambda condition) {
-    for (uint_32_cx i = 0; i < capacity_; i++) {
+    for (uint_32_cx i = 0; i < size_; i++) {
       if (condition(arr_[i])) {
         std::move(arr_ + i + 1, arr_ + size_, arr_ + i);
-        size_--;
+        pop_back();
         return;
       }
     }
@@ -361,8 +387,9 @@ class vec {
    * @param index index of removal
    */
   inline void removeAt(const uint_32_cx& index) noexcept {
-    CX_ASSERT(index < capacity_, "index out of bounds");
-    std::move(arr_ + index + 1, arr_ + size_--, arr_ + index);
+    CX_ASSERT(index < size_, "index out of bounds");
+    std::move(arr_ + index + 1, arr_ + size_, arr_ + index);
+    pop_back();
   }
   /**
  *
@@ -372,21 +399,7 @@ class vec {
   [[nodiscard]] inline uint_32_cx capacity() const noexcept { return capacity_; }
   inline void reserve(uint_32_cx new_capacity) noexcept {
     if (capacity_ < new_capacity) {
-      capacity_ = new_capacity;
-
-      T* n_arr = alloc.allocate(capacity_);
-
-      std::uninitialized_move(arr_, arr_ + size_, n_arr);
-
-      // Destroy the original objects
-      if (!std::is_trivial_v<T>) {
-        for (size_t i = 0; i < size_; i++) {
-          std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-        }
-      }
-      alloc.deallocate(arr_, size_);
-
-      arr_ = n_arr;
+      relocate(new_capacity);
     }
   }
   /**
@@ -394,16 +407,11 @@ class vec {
    * Resets the length back to its starting value
    */
   inline void clear() noexcept {
-    int ar[3] = {2, 2, 1};
-    if (!std::is_trivial_v<T>) {
-      for (uint_32_cx i = 0; i < capacity_; i++) {
-        std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-      }
-    }
-    alloc.deallocate(arr_, capacity_);
+    destroy(0, size_);
+    deallocate(arr_, capacity_);
     size_ = 0;
     capacity_ = 32;
-    arr_ = alloc.allocate(32);
+    arr_ = allocate(32);
   }
   /**
    * Provides access to the underlying array which can be used for sorting
@@ -440,10 +448,10 @@ class vec {
  * @param vec  the vec to append
  */
   inline void append(const vec<T>& vec) noexcept {
-    while (capacity_ - size_ < vec.size_) {
-      grow();
+    if (capacity_ - size_ < vec.size_) {
+      grow(size_ + vec.size_);
     }
-    std::copy(vec.arr_, vec.arr_ + vec.size_, arr_ + size_);
+    std::uninitialized_copy(vec.arr_, vec.arr_ + vec.size_, arr_ + size_);
     size_ += vec.size_;
   }
   /**
@@ -457,10 +465,10 @@ class vec {
  */
   inline void append(const vec<T>& list, uint_32_cx endIndex, uint_32_cx startIndex = 0) noexcept {
     CX_ASSERT(startIndex < endIndex || endIndex <= list.size_, "index out of bounds");
-    while (capacity_ - size_ < endIndex - startIndex) {
-      grow();
+    if (capacity_ - size_ < endIndex - startIndex) {
+      grow(size_ + endIndex - startIndex);
     }
-    std::copy(list.arr_ + startIndex, list.arr_ + endIndex, arr_ + size_);
+    std::uninitialized_copy(list.arr_ + startIndex, list.arr_ + endIndex, arr_ + size_);
     size_ += endIndex - startIndex;
   }
   /**
@@ -529,23 +537,9 @@ class vec {
   inline void resize(uint_32_cx new_size) noexcept {
     CX_WARNING(!(size_ <= new_size), "calling grow for no reason");
     if (size_ > new_size) {
-      auto old_len = capacity_;
-      capacity_ = new_size;
-
-      T* n_arr = alloc.allocate(capacity_);
-
-      std::uninitialized_move(arr_, arr_ + new_size, n_arr);
-
-      // Destroy the original objects
-      if (!std::is_trivial_v<T>) {
-        for (size_t i = 0; i < old_len; i++) {
-          std::allocator_traits<Allocator>::destroy(alloc, &arr_[i]);
-        }
-      }
-
-      alloc.deallocate(arr_, old_len);
-      arr_ = n_arr;
+      destroy(new_size, size_);
       size_ = new_size;
+      relocate(new_size);
     }
   }
 
@@ -774,6 +768,72 @@ class vec {
     list1.pop(3);
     CX_ASSERT(list1.size() == 6, "");
     CX_ASSERT(list1[3] == 6, "");
+
+    std::cout << "   Testing element lifetimes...\n";
+    struct Tracked {
+      int* live;
+      int val;
+      Tracked(int* live, int val) : live(live), val(val) { (*live)++; }
+      Tracked(const Tracked& o) : live(o.live), val(o.val) { (*live)++; }
+      Tracked(Tracked&& o) noexcept : live(o.live), val(o.val) { (*live)++; }
+      Tracked& operator=(const Tracked& o) = default;
+      Tracked& operator=(Tracked&& o) noexcept = default;
+      ~Tracked() { (*live)--; }
+      bool operator==(const Tracked& o) const { return val == o.val; }
+    };
+    static_assert(!is_trivially_relocatable_v<Tracked>);
+    int live = 0;
+    {
+      vec<Tracked> tracked(4);
+      CX_ASSERT(live == 0, "spare capacity must not be constructed");
+      for (int i = 0; i < 100; i++) {
+        tracked.emplace_back(&live, i);
+      }
+      CX_ASSERT(live == 100, "");
+      tracked.pop_front();
+      tracked.pop(10);
+      tracked.erase(Tracked(&live, 50));
+      tracked.removeAt(0);
+      CX_ASSERT(live == 96 && tracked.size() == 96, "");
+      CX_ASSERT(tracked[0].val == 2 && tracked[9].val == 12 && tracked[10].val == 13, "");
+      tracked.resize(50);
+      CX_ASSERT(live == 50, "");
+      vec<Tracked> copy = tracked;
+      CX_ASSERT(live == 100, "");
+      copy = tracked;
+      CX_ASSERT(live == 100, "");
+      copy.clear();
+      CX_ASSERT(live == 50, "");
+    }
+    CX_ASSERT(live == 0, "");
+
+    std::cout << "   Testing relocation of move-only types...\n";
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    vec<std::unique_ptr<int>> ptrs(1);
+    for (int i = 0; i < 1000; i++) {
+      ptrs.emplace_back(std::make_unique<int>(i));
+    }
+    for (int i = 0; i < 1000; i++) {
+      CX_ASSERT(*ptrs[i] == i, "");
+    }
+    ptrs.resize(10);
+    CX_ASSERT(*ptrs[9] == 9, "");
+
+    std::cout << "   Testing push_back of own element while growing...\n";
+    vec<std::string> strings(1);
+    strings.push_back(std::string(64, 'a'));
+    for (int i = 0; i < 100; i++) {
+      strings.push_back(strings[0]);
+    }
+    CX_ASSERT(strings.size() == 101 && strings[100] == std::string(64, 'a'), "");
+
+    std::cout << "   Testing growth near the size_type limit...\n";
+    vec<char, std::allocator<char>, uint16_t> bytes(40000);
+    for (int i = 0; i < 65535; i++) {
+      bytes.push_back((char)i);
+    }
+    CX_ASSERT(bytes.size() == 65535 && bytes.capacity() == 65535, "Growth should saturate at the size_type maximum");
+    CX_ASSERT(bytes[65534] == (char)65534, "");
   }
 #  endif
 };
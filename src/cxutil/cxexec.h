@@ -0,0 +1,352 @@
+// Copyright (c) 2023 gk646
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#define CX_FINISHED
+#ifndef CXSTRUCTS_SRC_CXEXEC_H_
+#define CXSTRUCTS_SRC_CXEXEC_H_
+
+#include "../cxconfig.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../cxstructs/WorkStealingDeque.h"
+#ifdef CX_INCLUDE_TESTS
+#  include <iostream>
+#endif
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+// Shared parallel execution runtime - one lazily started work-stealing pool for the whole library
+// parallel_for / parallel_reduce / parallel_invoke and TaskGroup all run on it and the calling thread helps while
+// it waits, so parallel algorithms can be nested freely
+// Define CX_EXEC_INLINE (or call exec::set_inline(true)) to run everything serially on the calling thread
+
+namespace cxstructs::exec {
+struct Config {
+  uint32_t threads = 0;  // Worker threads, 0 = hardware threads - 1 (the waiting thread helps)
+  bool pin = false;      // Pin workers to cpus, spread round-robin over the NUMA nodes
+};
+}  // namespace cxstructs::exec
+
+namespace cxhelper {
+struct ExecState {
+  std::mutex mutex;
+  cxstructs::exec::Config config;
+  std::atomic<cxstructs::WorkStealingPool*> pool{nullptr};
+  std::unique_ptr<cxstructs::WorkStealingPool> owner;
+  std::atomic<bool> inlineMode{false};
+};
+inline ExecState& exec_state() {
+  static ExecState state;
+  return state;
+}
+// Parses a sysfs cpulist like "0-3,8-11"
+inline void exec_parse_cpu_list(const char* list, std::vector<int>& cpus) {
+  while (*list != '\0' && *list != '\n') {
+    char* end;
+    const long first = std::strtol(list, &end, 10);
+    long last = first;
+    if (end == list) return;
+    if (*end == '-') last = std::strtol(end + 1, &end, 10);
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back((int)cpu);
+    }
+    list = *end == ',' ? end + 1 : end;
+  }
+}
+// Cpus of each NUMA node - a single node with all cpus if the topology is unknown
+inline std::vector<std::vector<int>> exec_numa_topology() {
+  std::vector<std::vector<int>> nodes;
+#if defined(__linux__)
+  char path[64];
+  char line[1024];
+  for (int node = 0;; ++node) {
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* file = std::fopen(path, "r");
+    if (file == nullptr) break;
+    std::vector<int> cpus;
+    if (std::fgets(line, sizeof(line), file) != nullptr) exec_parse_cpu_list(line, cpus);
+    std::fclose(file);
+    if (!cpus.empty()) nodes.push_back(std::move(cpus));
+  }
+#endif
+  if (nodes.empty()) {
+    nodes.emplace_back();
+    for (int cpu = 0; cpu < (int)std::max(std::thread::hardware_concurrency(), 1U); ++cpu) {
+      nodes.back().push_back(cpu);
+    }
+  }
+  return nodes;
+}
+inline bool exec_pin_current_thread(int cpu) {
+#ifdef _WIN32
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (cpu % (8 * sizeof(DWORD_PTR)))) != 0;
+#elif defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+}  // namespace cxhelper
+
+namespace cxstructs::exec {
+/**
+ * Sets the pool configuration - only possible before the pool is first used
+ * @return false if the pool is already running
+ */
+inline bool configure(const Config& config) {
+  auto& state = cxhelper::exec_state();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.pool.load(std::memory_order_acquire) != nullptr) return false;
+  state.config = config;
+  return true;
+}
+/**
+ * @return the cpus of each NUMA node
+ */
+inline const std::vector<std::vector<int>>& numa_topology() {
+  static const std::vector<std::vector<int>> topology = cxhelper::exec_numa_topology();
+  return topology;
+}
+/**
+ * Returns the shared pool - started on first use
+ */
+inline WorkStealingPool& pool() {
+  auto& state = cxhelper::exec_state();
+  WorkStealingPool* pool = state.pool.load(std::memory_order_acquire);
+  if (pool != nullptr) [[likely]] return *pool;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  pool = state.pool.load(std::memory_order_relaxed);
+  if (pool == nullptr) {
+    const Config config = state.config;
+    uint32_t threads = config.threads;
+    if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+    std::function<void(uint32_t)> onStart;
+    if (config.pin) {
+      // Worker i goes to node i % nodes so memory bandwidth of all nodes is used
+      std::vector<int> order;
+      const auto& nodes = numa_topology();
+      for (size_t k = 0; order.size() < threads; ++k) {
+        for (const auto& cpus : nodes) {
+          order.push_back(cpus[k % cpus.size()]);
+        }
+      }
+      onStart = [order](uint32_t index) { cxhelper::exec_pin_current_thread(order[index]); };
+    }
+    state.owner = std::make_unique<WorkStealingPool>(threads, std::move(onStart));
+    pool = state.owner.get();
+    state.pool.store(pool, std::memory_order_release);
+  }
+  return *pool;
+}
+/**
+ * Runtime opt-out - true makes all parallel calls run serially on the calling thread
+ */
+inline void set_inline(bool runInline) {
+  cxhelper::exec_state().inlineMode.store(runInline, std::memory_order_relaxed);
+}
+[[nodiscard]] inline bool is_inline() {
+#ifdef CX_EXEC_INLINE
+  return true;
+#else
+  return cxhelper::exec_state().inlineMode.load(std::memory_order_relaxed);
+#endif
+}
+/**
+ * @return the number of threads parallel calls use (workers + the calling thread), 1 if inline
+ */
+[[nodiscard]] inline uint32_t concurrency() { return is_inline() ? 1 : pool().size() + 1; }
+
+/**
+ * Group of tasks that is waited on together.<p>
+ * wait() executes pending jobs of the pool until all tasks of the group finished - it can be called from inside
+ * other tasks. The destructor waits as well. Tasks must not throw.
+ */
+class TaskGroup {
+  std::atomic<uint32_t> pending_{0};
+
+ public:
+  TaskGroup() = default;
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  ~TaskGroup() { wait(); }
+  template <typename Func>
+  inline void run(Func&& func) {
+    if (is_inline()) {
+      func();
+      return;
+    }
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    pool().submit([this, func = std::forward<Func>(func)]() mutable {
+      func();
+      pending_.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  inline void wait() {
+    if (pending_.load(std::memory_order_acquire) != 0) pool().wait_for(pending_);
+  }
+};
+
+/**
+ * Calls {@code func(i)} for every i in [begin, end).<p>
+ * The range is cut into chunks of {@code grain} indices that the threads claim dynamically - choose the grain so a
+ * chunk takes at least a few microseconds
+ */
+template <typename Index, typename Func>
+void parallel_for(Index begin, Index end, Index grain, Func&& func) {
+  if (!(begin < end)) return;
+  const auto count = static_cast<uint64_t>(end - begin);
+  const uint64_t step = std::max<uint64_t>(static_cast<uint64_t>(grain), 1);
+  if (count <= step || is_inline()) {
+    for (Index i = begin; i < end; ++i) func(i);
+    return;
+  }
+  const uint64_t chunks = (count + step - 1) / step;
+  const auto tasks = (uint32_t)std::min<uint64_t>(chunks, pool().size() + 1);
+  std::atomic<uint64_t> next{0};
+  auto body = [&] {
+    for (uint64_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+      const Index lo = begin + static_cast<Index>(c * step);
+      const Index hi = static_cast<uint64_t>(end - lo) > step ? lo + static_cast<Index>(step) : end;
+      for (Index i = lo; i < hi; ++i) func(i);
+    }
+  };
+  TaskGroup group;
+  for (uint32_t t = 1; t < tasks; ++t) {
+    group.run(body);
+  }
+  body();
+  group.wait();
+}
+
+/**
+ * Reduces [begin, end) in parallel.<p>
+ * {@code body(lo, hi, identity)} reduces one chunk and returns its result, the chunk results are then folded with
+ * {@code combine(a, b)} in index order - the result is deterministic even for floating point
+ * @return the reduced value, identity for an empty range
+ */
+template <typename Index, typename T, typename Body, typename Combine>
+T parallel_reduce(Index begin, Index end, Index grain, const T& identity, Body&& body, Combine&& combine) {
+  if (!(begin < end)) return identity;
+  const auto count = static_cast<uint64_t>(end - begin);
+  const uint64_t step = std::max<uint64_t>(static_cast<uint64_t>(grain), 1);
+  const uint64_t chunks = (count + step - 1) / step;
+  std::vector<T> partials(chunks, identity);
+  parallel_for<uint64_t>(0, chunks, 1, [&](uint64_t c) {
+    const Index lo = begin + static_cast<Index>(c * step);
+    const Index hi = static_cast<uint64_t>(end - lo) > step ? lo + static_cast<Index>(step) : end;
+    partials[c] = body(lo, hi, identity);
+  });
+  T result = identity;
+  for (const T& partial : partials) {
+    result = combine(result, partial);
+  }
+  return result;
+}
+
+/**
+ * Runs all functions in parallel and returns when all finished - the first one runs on the calling thread
+ */
+template <typename First, typename... Rest>
+void parallel_invoke(First&& first, Rest&&... rest) {
+  TaskGroup group;
+  (group.run(std::forward<Rest>(rest)), ...);
+  first();
+  group.wait();
+}
+}  // namespace cxstructs::exec
+
+#ifdef CX_INCLUDE_TESTS
+namespace cxtests {
+static void TEST_EXEC() {
+  using namespace cxstructs;
+  std::cout << "EXEC TESTS" << std::endl;
+  std::cout << "  Testing cpu list parsing..." << std::endl;
+  std::vector<int> cpus;
+  cxhelper::exec_parse_cpu_list("0-3,8,10-11\n", cpus);
+  CX_ASSERT(cpus == std::vector<int>({0, 1, 2, 3, 8, 10, 11}), "");
+  CX_ASSERT(!exec::numa_topology().empty() && !exec::numa_topology()[0].empty(), "");
+
+  std::cout << "  Testing parallel_for..." << std::endl;
+  // Another test may already have started the pool - then the configuration is rejected
+  [[maybe_unused]] const bool configured = exec::configure({3, true});
+  std::vector<int> hits(100000, 0);
+  exec::parallel_for(0, 100000, 1000, [&](int i) { hits[i]++; });
+  CX_ASSERT(!exec::configure({}), "The pool is running");
+  CX_ASSERT(exec::concurrency() == exec::pool().size() + 1, "");
+  CX_ASSERT(!configured || exec::concurrency() == 4, "");
+  CX_ASSERT(std::all_of(hits.begin(), hits.end(), [](int hit) { return hit == 1; }), "");
+  int calls = 0;
+  exec::parallel_for(5, 5, 1, [&](int) { calls++; });
+  exec::parallel_for(-3, 4, 2, [&](int i) { hits[i + 3]++; });
+  CX_ASSERT(calls == 0 && hits[0] == 2 && hits[6] == 2 && hits[7] == 1, "");
+
+  std::cout << "  Testing parallel_reduce..." << std::endl;
+  [[maybe_unused]] const auto sum = exec::parallel_reduce<uint64_t, uint64_t>(
+      1, 1000001, 4096, 0,
+      [](uint64_t lo, uint64_t hi, uint64_t acc) {
+        for (uint64_t i = lo; i < hi; ++i) acc += i;
+        return acc;
+      },
+      [](uint64_t a, uint64_t b) { return a + b; });
+  CX_ASSERT(sum == 1000000ULL * 1000001 / 2, "");
+  CX_ASSERT(exec::parallel_reduce(0, 0, 1, 7, [](int, int, int acc) { return acc; }, std::plus<>()) == 7, "");
+
+  std::cout << "  Testing nested parallelism..." << std::endl;
+  std::atomic<int> total{0};
+  exec::parallel_invoke([&] { exec::parallel_for(0, 1000, 10, [&](int) { total++; }); },
+                        [&] { exec::parallel_for(0, 1000, 10, [&](int) { total++; }); },
+                        [&] {
+                          exec::TaskGroup group;
+                          for (int i = 0; i < 100; i++) {
+                            group.run([&] { total++; });
+                          }
+                        });
+  CX_ASSERT(total.load() == 2100, "");
+
+  std::cout << "  Testing inline mode..." << std::endl;
+  exec::set_inline(true);
+  const auto caller = std::this_thread::get_id();
+  bool sameThread = true;
+  exec::parallel_for(0, 10000, 10, [&](int) { sameThread &= std::this_thread::get_id() == caller; });
+  CX_ASSERT(sameThread && exec::concurrency() == 1, "");
+  exec::set_inline(false);
+}
+}  // namespace cxtests
+#endif
+#endif  // CXSTRUCTS_SRC_CXEXEC_H_
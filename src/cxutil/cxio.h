@@ -22,7 +22,32 @@
 #define CXSTRUCTS_SRC_CXIO_H_
 
 #include "../cxconfig.h"
+#include <atomic>
+#include <charconv>
 #include <cstring>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#  include <io.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define CX_IO_SSE2
+#endif
 
 // Simple, readable and fast *symmetric* serialization structure with loading
 // and saving. Each line is a concatenated list of values and a separator
@@ -51,6 +76,121 @@ int manual_strncmp(const char* s1, const char* s2, int n) {
   }
   return 0;
 }
+// Flushes the OS buffers of the file to disk
+inline bool io_sync_fd(const int fd) {
+#ifdef _WIN32
+  return _commit(fd) == 0;
+#else
+  return fsync(fd) == 0;
+#endif
+}
+// 64-bit fseek/ftell - long is only 32 bits on Windows
+inline int io_seek(FILE* file, const int64_t offset, const int origin) {
+#ifdef _WIN32
+  return _fseeki64(file, offset, origin);
+#else
+  return fseeko(file, (off_t)offset, origin);
+#endif
+}
+inline int64_t io_tell(FILE* file) {
+#ifdef _WIN32
+  return _ftelli64(file);
+#else
+  return (int64_t)ftello(file);
+#endif
+}
+inline int io_dup_fd(const int fd) {
+#ifdef _WIN32
+  return _dup(fd);
+#else
+  return dup(fd);
+#endif
+}
+inline void io_close_fd(const int fd) {
+#ifdef _WIN32
+  _close(fd);
+#else
+  close(fd);
+#endif
+}
+// Atomically replaces "to" with "from"
+inline bool io_replace_file(const char* from, const char* to) {
+#ifdef _WIN32
+  return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return std::rename(from, to) == 0;
+#endif
+}
+// Opens the directory containing fileName - returns -1 on failure
+inline int io_open_parent_dir(const char* fileName) {
+#ifdef _WIN32
+  (void)fileName;
+  return -1;  // No directory handles - MOVEFILE_WRITE_THROUGH already flushes the rename
+#else
+  const char* slash = std::strrchr(fileName, '/');
+  if (slash == nullptr) return open(".", O_RDONLY);
+  if (slash == fileName) return open("/", O_RDONLY);
+  const auto dirLength = static_cast<size_t>(slash - fileName);
+  auto* dirName = new char[dirLength + 1];
+  std::memcpy(dirName, fileName, dirLength);
+  dirName[dirLength] = '\0';
+  const int fd = open(dirName, O_RDONLY);
+  delete[] dirName;
+  return fd;
+#endif
+}
+// Flushes the directory entry of fileName to disk - only then a rename survives a power loss
+inline bool io_sync_parent_dir(const char* fileName) {
+#ifdef _WIN32
+  (void)fileName;
+  return true;
+#else
+  const int fd = io_open_parent_dir(fileName);
+  if (fd == -1) return false;
+  const bool synced = io_sync_fd(fd);
+  io_close_fd(fd);
+  return synced;
+#endif
+}
+// Returns "<fileName>.<pid>.<counter>.tmp" - unique across threads and processes saving the same file
+inline char* io_temp_name(const char* fileName, const int nameLength) {
+  static std::atomic<uint32_t> counter{0};
+#ifdef _WIN32
+  const auto pid = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+  const auto pid = static_cast<unsigned long>(getpid());
+#endif
+  const int size = nameLength + 40;
+  auto* tempName = new char[size];
+  snprintf(tempName, size, "%s.%lu.%u.tmp", fileName, pid, counter.fetch_add(1, std::memory_order_relaxed));
+  return tempName;
+}
+// Returns a pointer to the first occurrence of a or b in [begin, end) - or end if none is found
+// Scans 16 bytes per step with SSE2
+inline const char* io_find_either(const char* begin, const char* end, const char a, const char b) {
+#ifdef CX_IO_SSE2
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  while (end - begin >= 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+    if (mask != 0) {
+#  if defined(_MSC_VER) && !defined(__clang__)
+      unsigned long idx;
+      _BitScanForward(&idx, (unsigned long)mask);
+      return begin + idx;
+#  else
+      return begin + __builtin_ctz((unsigned)mask);
+#  endif
+    }
+    begin += 16;
+  }
+#endif
+  while (begin < end && *begin != a && *begin != b) {
+    ++begin;
+  }
+  return begin;
+}
 }  // namespace
 // true if end of file // don't call this more than once per line
 inline auto io_check_eof(FILE* file) -> bool {
@@ -115,67 +255,88 @@ inline void io_save(FILE* file, const float value, const float value2) {
   fprintf(file, "%.6f;%.6f\037", value, value2);
 }
 
-// Buffers the given SaveFunc to memory so the file is only written if it
-// executes successfully. Returns false on error
+// How io_save_buffered_write() syncs the written file to disk
+enum class IOSync : uint8_t {
+  NONE,        // Leave it to the OS - survives a crash of the program but not a power loss
+  BLOCKING,    // fsync the file and then its directory - fully durable but blocks until the disk confirms
+  BACKGROUND,  // Replace the file right away and fsync it and its directory on a detached thread afterwards
+};
+
+// Streams the given SaveFunc to a temporary file and only replaces the actual file if it executes successfully
+// Memory use is constant - memoryBufferBytes is the size of the chunks handed to the OS, not a size limit
+// The replace is an atomic rename so readers see either the old or the new file - never a partial one
+// SaveFunc can return bool - returning false discards the temporary file
+// Returns false on error - the original file is left untouched in that case
+// With IOSync::BLOCKING false is also returned if the directory sync fails - the new file is in place but not durable
 template <typename SaveFunc>  // SaveFunc(FILE* file)
-bool io_save_buffered_write(const char* fileName, const int memoryBufferBytes, SaveFunc func) {
+bool io_save_buffered_write(const char* fileName, const int memoryBufferBytes, SaveFunc func,
+                            const IOSync sync = IOSync::NONE) {
   CX_ASSERT(memoryBufferBytes > 0, "Given buffer size invalid");
 
+  // Concurrent saves of the same file each write their own temporary - the last rename wins
+  auto* tempName = io_temp_name(fileName, manual_strlen(fileName));
+
 #ifdef _WIN32
   FILE* file;
-  fopen_s(&file, "NUL", "wb");
+  fopen_s(&file, tempName, "wb");
 #else
-  FILE* file = fopen("/dev/null", "wb");
+  FILE* file = fopen(tempName, "wb");
 #endif
-  // Write to in memory buffer
   if (file == nullptr) {
+    delete[] tempName;
     return false;
   }
 
   auto* buffer = new char[memoryBufferBytes];
-  std::memset(buffer, 0, memoryBufferBytes);
-
-  // _IOLBF is line buffering
-  if (setvbuf(file, buffer, _IOFBF, memoryBufferBytes) != 0) {
-    delete[] buffer;
-    return false;
-  }
-
-  // Call the user function
-  func(file);
+  bool success = setvbuf(file, buffer, _IOFBF, memoryBufferBytes) == 0;
 
-  if (fclose(file) != 0) {
-    delete[] buffer;
-    return false;
+  // Call the user function - full chunks are written out as it goes
+  if (success) {
+    if constexpr (std::is_same_v<std::invoke_result_t<SaveFunc, FILE*>, bool>) {
+      success = func(file);
+    } else {
+      func(file);
+    }
   }
 
-  // When successful, open the actual save file and save the data
-  const int dataSize = (int)strlen(buffer);
-#ifdef _WIN32
-  fopen_s(&file, fileName, "wb");
-#else
-  file = fopen(fileName, "wb");
-#endif
-  if (file == nullptr) {
-    delete[] buffer;
-    return false;
+  success = success && fflush(file) == 0 && ferror(file) == 0;
+  if (success && sync == IOSync::BLOCKING) {
+    success = io_sync_fd(fileno(file));
   }
-
-  // Set no buffering for more efficiency
-  if (setvbuf(file, nullptr, _IONBF, 0)) {
-    delete[] buffer;
-    return false;
+  int backgroundFd = -1;
+  if (success && sync == IOSync::BACKGROUND) {
+    backgroundFd = io_dup_fd(fileno(file));
   }
 
-  fwrite(buffer, dataSize, 1, file);
+  success = fclose(file) == 0 && success;
+  delete[] buffer;  // Only safe after fclose()
 
-  delete[] buffer;
+  success = success && io_replace_file(tempName, fileName);
+  if (!success) {
+    std::remove(tempName);
+  }
+  delete[] tempName;
 
-  if (fclose(file) != 0) {
-    return false;
+  if (success && sync == IOSync::BLOCKING) {
+    success = io_sync_parent_dir(fileName);
   }
 
-  return true;
+  if (backgroundFd != -1) {
+    if (success) {
+      const int dirFd = io_open_parent_dir(fileName);
+      std::thread([backgroundFd, dirFd] {
+        io_sync_fd(backgroundFd);
+        io_close_fd(backgroundFd);
+        if (dirFd != -1) {
+          io_sync_fd(dirFd);
+          io_close_fd(dirFd);
+        }
+      }).detach();
+    } else {
+      io_close_fd(backgroundFd);
+    }
+  }
+  return success;
 }
 //-----------LOADING-----------//
 // Searches for the next new line but stops at the separator if not forced
@@ -243,7 +404,7 @@ inline void io_load(FILE* file, std::string& s) {
 #endif
 // Load a string property into a user-supplied buffer - return bytes written - reads until linesep is found
 inline int io_load(FILE* file, char* buffer, size_t buffer_size) {
-  int count = 0;
+  size_t count = 0;
   char ch;
   while (count < buffer_size - 1 && fread(&ch, 1, 1, file) == 1 && ch != '\037') {
     if (ch == NEW_LINE_SUB) [[unlikely]] {
@@ -253,7 +414,7 @@ inline int io_load(FILE* file, char* buffer, size_t buffer_size) {
   }
   buffer[count] = '\0';
   while (ch != '\037' && fread(&ch, 1, 1, file) == 1) {}
-  return count;
+  return (int)count;
 }
 // Directly load an integer property from the file
 inline void io_load(FILE* file, int& i) {
@@ -280,10 +441,440 @@ inline void io_load(FILE* file, float& f, float& f2, float& f3) {
 inline void io_load(FILE* file, float& f, float& f2) {
   fscanf(file, "%f;%f\037", &f, &f2);
 }
+
+//-----------MAPPED-----------//
+// Zero-copy reader for the text format above - the file is memory mapped and parsed in place
+// Mirrors the FILE* interface: load(), load_newline(), load_inside_section()
+// Fields are handed out as std::string_view into the mapping - they are only valid while the reader lives
+// Delimiters are found with SSE2 (16 bytes per step) and all section headers are indexed on open for random access
+struct MappedTextReader final {
+  explicit MappedTextReader(const char* fileName) {
+#ifdef _WIN32
+    fileHandle_ = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle_ == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle_, &fileSize) || fileSize.QuadPart == 0) return;
+    mapHandle_ = CreateFileMappingA(fileHandle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapHandle_ == nullptr) return;
+    void* view = MapViewOfFile(mapHandle_, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) return;
+    begin_ = static_cast<const char*>(view);
+    size_ = (size_t)fileSize.QuadPart;
+#else
+    const int fd = open(fileName, O_RDONLY);
+    if (fd == -1) return;
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      return;
+    }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping keeps the file alive
+    if (view == MAP_FAILED) return;
+    madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+    begin_ = static_cast<const char*>(view);
+    size_ = (size_t)st.st_size;
+#endif
+    pos_ = begin_;
+    end_ = begin_ + size_;
+    build_section_index();
+  }
+  MappedTextReader(const MappedTextReader&) = delete;
+  MappedTextReader& operator=(const MappedTextReader&) = delete;
+  ~MappedTextReader() {
+#ifdef _WIN32
+    if (begin_ != nullptr) UnmapViewOfFile(begin_);
+    if (mapHandle_ != nullptr) CloseHandle(mapHandle_);
+    if (fileHandle_ != INVALID_HANDLE_VALUE) CloseHandle(fileHandle_);
+#else
+    if (begin_ != nullptr) munmap(const_cast<char*>(begin_), size_);
+#endif
+  }
+  // False if the file couldnt be opened or mapped (empty files cant be mapped)
+  [[nodiscard]] bool is_open() const { return begin_ != nullptr; }
+  // true if end of file
+  [[nodiscard]] bool eof() const { return pos_ >= end_; }
+  // Current offset from the start of the file
+  [[nodiscard]] size_t tell() const { return (size_t)(pos_ - begin_); }
+  void seek(const size_t offset) { pos_ = begin_ + (offset < size_ ? offset : size_); }
+
+  //-----------SECTIONS-----------//
+  // Number of sections found in the file
+  [[nodiscard]] int section_count() const { return (int)sections_.size(); }
+  [[nodiscard]] std::string_view section_name(const int i) const { return sections_[i].name; }
+  // Jumps to the first line after the given section header - returns false if the section doesnt exist
+  bool seek_section(const std::string_view section) {
+    for (const auto& entry : sections_) {
+      if (entry.name == section) {
+        pos_ = begin_ + entry.offset;
+        return true;
+      }
+    }
+    return false;
+  }
+  // Same semantics as io_load_inside_section() - used like: while(reader.load_inside_section()){}
+  bool load_inside_section(const char* section) {
+    if (pos_ >= end_) return false;
+    if (end_ - pos_ < 2 || pos_[0] != '-' || pos_[1] != '-') return true;  // Still inside same section
+
+    const std::string_view name{section, (size_t)manual_strlen(section)};
+    const char* nameStart = pos_ + 2;
+    const bool same = (size_t)(end_ - nameStart) >= name.size() && std::string_view{nameStart, name.size()} == name;
+    load_newline(false);
+    return same;
+  }
+
+  //-----------LOADING-----------//
+  // Searches for the next new line but stops at the separator if not forced
+  void load_newline(const bool force = false) {
+    const char* hit = io_find_either(pos_, end_, force ? '\n' : '\037', '\n');
+    pos_ = hit < end_ ? hit + 1 : end_;
+  }
+  void load_skip_separator() {
+    const char* hit = io_find_either(pos_, end_, '\037', '\037');
+    pos_ = hit < end_ ? hit + 1 : end_;
+  }
+  // Returns the raw bytes of the next field without copying - newlines are still encoded as NEW_LINE_SUB
+  std::string_view load_field() {
+    const char* start = pos_;
+    const char* hit = io_find_either(pos_, end_, '\037', '\037');
+    pos_ = hit < end_ ? hit + 1 : end_;
+    return {start, (size_t)(hit - start)};
+  }
+  // Load a string property into a user-supplied buffer - return bytes written - newlines are restored
+  int load(char* buffer, const size_t bufferSize) {
+    const std::string_view field = load_field();
+    const size_t count = field.size() < bufferSize ? field.size() : bufferSize - 1;
+    for (size_t i = 0; i < count; ++i) {
+      buffer[i] = field[i] == NEW_LINE_SUB ? '\n' : field[i];
+    }
+    buffer[count] = '\0';
+    return (int)count;
+  }
+#if defined(_STRING_) || defined(_GLIBCXX_STRING)
+  void load(std::string& s) {
+    const std::string_view field = load_field();
+    s.assign(field.data(), field.size());
+    for (auto& ch : s) {
+      if (ch == NEW_LINE_SUB) [[unlikely]] {
+        ch = '\n';
+      }
+    }
+  }
+#endif
+  void load(int& i) { parse(load_field(), i); }
+  void load(bool& value) {
+    int num = 0;
+    parse(load_field(), num);
+    value = num == 1;
+  }
+  void load(float& f) { parse(load_field(), f); }
+  void load(float& f, float& f2) {
+    const std::string_view field = load_field();
+    const char* next = parse(field, f);
+    parse(std::string_view{next, (size_t)(field.data() + field.size() - next)}, f2);
+  }
+  void load(float& f, float& f2, float& f3) {
+    const std::string_view field = load_field();
+    const char* last = field.data() + field.size();
+    const char* next = parse(field, f);
+    next = parse(std::string_view{next, (size_t)(last - next)}, f2);
+    parse(std::string_view{next, (size_t)(last - next)}, f3);
+  }
+
+ private:
+  struct Section {
+    std::string_view name;
+    size_t offset;  // Offset of the first line after the header
+  };
+  // Parses a number from the start of the field - returns the position after the next ';' (or the end)
+  template <typename T>
+  static const char* parse(const std::string_view field, T& value) {
+    const char* last = field.data() + field.size();
+    const auto [ptr, ec] = std::from_chars(field.data(), last, value);
+    return ptr < last ? ptr + 1 : last;
+  }
+  void build_section_index() {
+    const char* line = begin_;
+    while (line < end_) {
+      const char* lineEnd = io_find_either(line, end_, '\n', '\n');
+      if (lineEnd - line >= 4 && line[0] == '-' && line[1] == '-' && lineEnd[-1] == '-' && lineEnd[-2] == '-') {
+        const size_t offset = lineEnd < end_ ? (size_t)(lineEnd + 1 - begin_) : size_;
+        sections_.push_back({std::string_view{line + 2, (size_t)(lineEnd - line - 4)}, offset});
+      }
+      line = lineEnd + 1;
+    }
+  }
+  std::vector<Section> sections_;
+  const char* begin_ = nullptr;
+  const char* pos_ = nullptr;
+  const char* end_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  HANDLE fileHandle_ = INVALID_HANDLE_VALUE;
+  HANDLE mapHandle_ = nullptr;
+#endif
+};
+
+//-----------BINARY-----------//
+// Binary, length-prefixed counterpart to the text format above
+// Values go through a large memory buffer and are copied with memcpy - there is no per-byte fread or fscanf
+// Fixed width values are written as their raw bytes, strings and arrays as a uint32_t count followed by the data
+// The format is not endian independent - only load files on machines with the same byte order
+// The order of writes and reads has to match (symmetric) just like with the text format
+
+// Buffers all writes to memory and flushes them in large blocks to the file
+// Doesnt own the file - flush() or destroy the writer before closing it
+struct BinaryWriter final {
+  explicit BinaryWriter(FILE* file, const uint32_t bufferBytes = 1U << 20)
+      : file_(file), buffer_(new char[bufferBytes]), capacity_(bufferBytes) {
+    CX_ASSERT(bufferBytes > 0, "Given buffer size invalid");
+  }
+  BinaryWriter(const BinaryWriter&) = delete;
+  BinaryWriter& operator=(const BinaryWriter&) = delete;
+  ~BinaryWriter() {
+    flush();
+    delete[] buffer_;
+  }
+  // Writes all buffered data to the file - returns false if any write so far failed
+  bool flush() {
+    if (size_ > 0 && ok_) {
+      ok_ = fwrite(buffer_, 1, size_, file_) == size_;
+    }
+    size_ = 0;
+    return ok_;
+  }
+  // Writes count raw bytes - blocks larger than the buffer bypass it
+  void write_bytes(const void* data, const size_t count) {
+    if (count > capacity_ - size_) {
+      flush();
+      if (count >= capacity_) {
+        if (ok_) ok_ = fwrite(data, 1, count, file_) == count;
+        return;
+      }
+    }
+    std::memcpy(buffer_ + size_, data, count);
+    size_ += (uint32_t)count;
+  }
+  // Writes any trivially copyable value (int, float, structs of those...) as its raw bytes
+  template <typename T>
+    requires(!std::is_pointer_v<T> && !std::is_array_v<T>)
+  void write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written raw");
+    if (sizeof(T) <= capacity_ - size_) [[likely]] {
+      std::memcpy(buffer_ + size_, &value, sizeof(T));
+      size_ += sizeof(T);
+    } else {
+      write_bytes(&value, sizeof(T));
+    }
+  }
+  // Writes a length-prefixed string - unlike the text format newlines and separators need no escaping
+  void write(const char* value) { write_string(value, manual_strlen(value)); }
+  void write_string(const char* value, const uint32_t length) {
+    write(length);
+    write_bytes(value, length);
+  }
+#if defined(_STRING_) || defined(_GLIBCXX_STRING)
+  void write(const std::string& value) { write_string(value.data(), (uint32_t)value.size()); }
+#endif
+  // Writes count elements of a contiguous array in one go - prefixed with count
+  template <typename T>
+  void write_array(const T* data, const uint32_t count) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written raw");
+    write(count);
+    write_bytes(data, (size_t)count * sizeof(T));
+  }
+  // Writes a vec (or any container with get_raw() and size())
+  template <typename Vec>
+  void write_vec(const Vec& vec) {
+    write_array(vec.get_raw(), (uint32_t)vec.size());
+  }
+  // Writes a mat (or any matrix with n_rows(), n_cols() and get_raw()) as rows, cols and the flat data
+  template <typename Mat>
+  void write_mat(const Mat& mat) {
+    write((uint32_t)mat.n_rows());
+    write_array(mat.get_raw(), (uint32_t)(mat.n_rows() * mat.n_cols()));
+  }
+  [[nodiscard]] bool good() const { return ok_; }
+
+ private:
+  FILE* file_;
+  char* buffer_;
+  uint32_t capacity_;
+  uint32_t size_ = 0;
+  bool ok_ = true;
+};
+
+// Reads the file in large blocks and serves values out of memory
+// Doesnt own the file - reading stops at the first error and every following read returns false
+// (a failure also drops the buffered data so the fast paths cant serve stale bytes)
+// Stored counts are checked against the rest of the file before anything is allocated - a corrupt count fails the
+// read instead of requesting gigabytes, and strings, vecs and mats are only replaced once their data is read
+struct BinaryReader final {
+  explicit BinaryReader(FILE* file, const uint32_t bufferBytes = 1U << 20)
+      : file_(file), buffer_(new char[bufferBytes]), capacity_(bufferBytes) {
+    CX_ASSERT(bufferBytes > 0, "Given buffer size invalid");
+  }
+  BinaryReader(const BinaryReader&) = delete;
+  BinaryReader& operator=(const BinaryReader&) = delete;
+  ~BinaryReader() { delete[] buffer_; }
+  // Reads count raw bytes into dest - large blocks are read directly into dest
+  bool read_bytes(void* dest, size_t count) {
+    if (!ok_) [[unlikely]] return false;
+    auto* out = static_cast<char*>(dest);
+    size_t available = end_ - pos_;
+    if (count <= available) [[likely]] {
+      std::memcpy(out, buffer_ + pos_, count);
+      pos_ += (uint32_t)count;
+      return true;
+    }
+    std::memcpy(out, buffer_ + pos_, available);
+    out += available;
+    count -= available;
+    pos_ = end_ = 0;
+    if (count >= capacity_) {
+      return fread(out, 1, count, file_) == count || fail();
+    }
+    if (!refill() || end_ < count) {
+      return fail();
+    }
+    std::memcpy(out, buffer_, count);
+    pos_ = (uint32_t)count;
+    return true;
+  }
+  // Reads any trivially copyable value
+  template <typename T>
+    requires(!std::is_pointer_v<T> && !std::is_array_v<T>)
+  bool read(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read raw");
+    if (sizeof(T) <= end_ - pos_) [[likely]] {
+      std::memcpy(&value, buffer_ + pos_, sizeof(T));
+      pos_ += sizeof(T);
+      return true;
+    }
+    return read_bytes(&value, sizeof(T));
+  }
+  // Loads a string into a user-supplied buffer - return bytes written - always null terminated
+  // Characters that dont fit are skipped
+  int read(char* buffer, const size_t bufferSize) {
+    uint32_t length = 0;
+    if (bufferSize == 0) {
+      if (read(length)) skip(length);
+      return 0;
+    }
+    if (!read(length)) {
+      buffer[0] = '\0';
+      return 0;
+    }
+    const uint32_t fits = length < bufferSize ? length : (uint32_t)bufferSize - 1;
+    read_bytes(buffer, fits);
+    buffer[fits] = '\0';
+    skip(length - fits);
+    return (int)fits;
+  }
+#if defined(_STRING_) || defined(_GLIBCXX_STRING)
+  bool read(std::string& s) {
+    uint32_t length = 0;
+    if (!read(length)) return false;
+    if (!has_remaining(length)) return fail();
+    std::string temp(length, '\0');
+    if (!read_bytes(temp.data(), length)) return false;
+    s = std::move(temp);
+    return true;
+  }
+#endif
+  // Reads an array written with write_array() into data - returns the number of elements read
+  // Elements that dont fit into maxCount are skipped
+  template <typename T>
+  uint32_t read_array(T* data, const uint32_t maxCount) {
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read raw");
+    uint32_t count = 0;
+    if (!read(count)) return 0;
+    const uint32_t fits = count < maxCount ? count : maxCount;
+    if (!read_bytes(data, (size_t)fits * sizeof(T))) return 0;
+    skip((size_t)(count - fits) * sizeof(T));
+    return fits;
+  }
+  // Reads a vec written with write_vec() - the vec is replaced with one of the stored size
+  // Fails without touching the vec if the data is truncated or the stored count exceeds the file
+  template <typename Vec>
+  bool read_vec(Vec& vec) {
+    uint32_t count = 0;
+    if (!read(count)) return false;
+    const uint64_t bytes = (uint64_t)count * sizeof(typename Vec::value_type);
+    if (!has_remaining(bytes)) return fail();
+    Vec temp(count, typename Vec::value_type{});
+    if (!read_bytes(temp.get_raw(), bytes)) return false;
+    vec = std::move(temp);
+    return true;
+  }
+  // Reads a mat written with write_mat() - the mat is replaced with one of the stored dimensions
+  // Fails without touching the mat if the stored element count is not a multiple of the rows, exceeds the file or
+  // the data is truncated (corrupt file)
+  template <typename Mat>
+  bool read_mat(Mat& mat) {
+    using T = std::remove_pointer_t<decltype(mat.get_raw())>;
+    uint32_t rows = 0;
+    uint32_t count = 0;
+    if (!read(rows) || !read(count)) return false;
+    if (rows == 0 ? count != 0 : count % rows != 0) return fail();
+    const uint64_t bytes = (uint64_t)count * sizeof(T);
+    if (!has_remaining(bytes)) return fail();
+    Mat temp(rows, rows == 0 ? 0 : count / rows);
+    if (!read_bytes(temp.get_raw(), bytes)) return false;
+    mat = std::move(temp);
+    return true;
+  }
+  // Skips count bytes
+  bool skip(size_t count) {
+    size_t available = end_ - pos_;
+    if (count <= available) {
+      pos_ += (uint32_t)count;
+      return true;
+    }
+    count -= available;
+    pos_ = end_ = 0;
+    return (ok_ && io_seek(file_, (int64_t)count, SEEK_CUR) == 0) || fail();
+  }
+  [[nodiscard]] bool good() const { return ok_; }
+
+ private:
+  // True if at least bytes are left in the buffer and the file - streams without a known size (pipes) always pass
+  bool has_remaining(const uint64_t bytes) {
+    const uint32_t buffered = end_ - pos_;
+    if (bytes <= buffered) return true;
+    const int64_t pos = io_tell(file_);
+    if (pos < 0 || io_seek(file_, 0, SEEK_END) != 0) return true;
+    const int64_t size = io_tell(file_);
+    if (io_seek(file_, pos, SEEK_SET) != 0) return fail();
+    return size < pos || bytes - buffered <= (uint64_t)(size - pos);
+  }
+  // Marks the reader as failed and drops the buffer - always returns false
+  bool fail() {
+    ok_ = false;
+    pos_ = end_ = 0;
+    return false;
+  }
+  bool refill() {
+    if (!ok_) return false;
+    end_ = (uint32_t)fread(buffer_, 1, capacity_, file_);
+    pos_ = 0;
+    return end_ > 0;
+  }
+  FILE* file_;
+  char* buffer_;
+  uint32_t capacity_;
+  uint32_t pos_ = 0;
+  uint32_t end_ = 0;
+  bool ok_ = true;
+};
 }  // namespace cxstructs
 
 #ifdef CX_INCLUDE_TESTS
 #include <chrono>
+#include "../cxstructs/mat.h"
+#include "../cxstructs/vec.h"
 namespace cxtests {
 using namespace cxstructs;
 using namespace std::chrono;
@@ -381,7 +972,8 @@ void test_save_load_float() {
 }
 void delete_test_files() {
   // List of test files to delete
-  const char* files[] = {"test_string.txt", "test_int.txt", "test_float.txt", "test_complex.txt", "hello.txt"};
+  const char* files[] = {"test_string.txt", "test_int.txt", "test_float.txt", "test_complex.txt", "hello.txt",
+                         "test_binary.bin", "test_mapped.txt", "test_buffered.txt"};
 
   // Iterate over the array and delete each file
   for (const char* filename : files) {
@@ -445,12 +1037,282 @@ void test_complex_save_load() {
   CX_ASSERT(hello == hello2, "");
   CX_ASSERT(bye == "bye", "");
 }
+void test_binary_save_load() {
+  const char* test_filename = "test_binary.bin";
+  constexpr int count = 100000;
+  auto* original = new float[count];
+  auto* loaded = new float[count];
+  for (int i = 0; i < count; i++) {
+    original[i] = (float)i * 0.5F;
+  }
+
+  // Save - small buffer to exercise flushing and the direct write path
+  FILE* file = std::fopen(test_filename, "wb");
+  {
+    BinaryWriter writer(file, 64);
+    writer.write(42);
+    writer.write("Hello\nworld\037!");
+    writer.write(3.141F);
+    writer.write_array(original, count);
+    writer.write(true);
+    writer.write(std::string("bye"));
+    CX_ASSERT(writer.flush(), "Binary flush failed");
+  }
+  std::fclose(file);
+
+  // Load
+  int loaded_int = 0;
+  float loaded_float = 0;
+  bool loaded_bool = false;
+  char buffer[256];
+  std::string bye;
+  file = std::fopen(test_filename, "rb");
+  {
+    BinaryReader reader(file, 64);
+    reader.read(loaded_int);
+    reader.read(buffer, sizeof(buffer));
+    reader.read(loaded_float);
+    [[maybe_unused]] const uint32_t arrayCount = reader.read_array(loaded, count);
+    CX_ASSERT(arrayCount == count, "Binary array load failed");
+    reader.read(loaded_bool);
+    reader.read(bye);
+    CX_ASSERT(reader.good(), "Binary reader failed");
+    [[maybe_unused]] const bool pastEnd = reader.read(loaded_int);
+    CX_ASSERT(!pastEnd, "Read past end of file");
+  }
+  std::fclose(file);
+
+  CX_ASSERT(loaded_int == 42, "Binary int save/load failed");
+  CX_ASSERT(std::strcmp(buffer, "Hello\nworld\037!") == 0, "Binary string save/load failed");
+  CX_ASSERT(loaded_float == 3.141F, "Binary float save/load failed");
+  CX_ASSERT(loaded_bool, "Binary bool save/load failed");
+  CX_ASSERT(bye == "bye", "Binary std::string save/load failed");
+  CX_ASSERT(std::memcmp(original, loaded, count * sizeof(float)) == 0, "Binary array save/load failed");
+  delete[] original;
+  delete[] loaded;
+
+  // Containers
+  vec<int> numbers;
+  for (int i = 0; i < 1000; i++) {
+    numbers.push_back(i * 3);
+  }
+  mat matrix(3, 5);
+  for (uint32_t i = 0; i < 3; i++) {
+    for (uint32_t j = 0; j < 5; j++) {
+      matrix(i, j) = (float)(i * 5 + j) * 0.25F;
+    }
+  }
+  file = std::fopen(test_filename, "wb");
+  {
+    BinaryWriter writer(file, 64);
+    writer.write_vec(numbers);
+    writer.write_mat(matrix);
+    writer.write_mat(mat(0, 0));
+    writer.write(std::string("tail"));
+    // A corrupt mat - 7 elements for 2 rows
+    writer.write(2U);
+    writer.write(7U);
+    writer.write(12345);
+  }
+  std::fclose(file);
+  vec<int> loadedNumbers;
+  mat loadedMatrix;
+  mat emptyMatrix(2, 2);
+  [[maybe_unused]] char nothing[1] = {'x'};
+  [[maybe_unused]] bool success;
+  file = std::fopen(test_filename, "rb");
+  {
+    BinaryReader reader(file, 64);
+    success = reader.read_vec(loadedNumbers);
+    CX_ASSERT(success && loadedNumbers.size() == 1000, "Binary vec load failed");
+    success = reader.read_mat(loadedMatrix);
+    CX_ASSERT(success, "Binary mat load failed");
+    success = reader.read_mat(emptyMatrix);
+    CX_ASSERT(success && emptyMatrix.n_rows() == 0, "Binary empty mat load failed");
+    [[maybe_unused]] const int written = reader.read(nothing, 0);
+    CX_ASSERT(written == 0 && nothing[0] == 'x', "Zero sized buffer was written");
+    success = reader.read_mat(loadedMatrix);
+    CX_ASSERT(!success, "Corrupt mat was accepted");
+    CX_ASSERT(!reader.good() && loadedMatrix.n_rows() == 3, "Corrupt mat replaced the mat");
+    [[maybe_unused]] int afterFailure = 0;
+    success = reader.read(afterFailure);
+    CX_ASSERT(!success && afterFailure == 0, "Failed reader returned data");
+  }
+  std::fclose(file);
+
+  // Stored counts far beyond the file size fail without allocating or touching the target
+  for (int kind = 0; kind < 3; kind++) {
+    file = std::fopen(test_filename, "wb");
+    {
+      BinaryWriter writer(file, 64);
+      if (kind == 2) writer.write(1U);  // rows of the mat
+      writer.write(0xFFFFFFF0U);
+      writer.write(7);
+    }
+    std::fclose(file);
+    std::string text = "keep";
+    file = std::fopen(test_filename, "rb");
+    {
+      BinaryReader reader(file, 64);
+      if (kind == 0) {
+        success = reader.read(text);
+      } else if (kind == 1) {
+        success = reader.read_vec(loadedNumbers);
+      } else {
+        success = reader.read_mat(loadedMatrix);
+      }
+      CX_ASSERT(!success && !reader.good(), "Oversized count was accepted");
+    }
+    std::fclose(file);
+    CX_ASSERT(text == "keep" && loadedNumbers.size() == 1000 && loadedMatrix.n_rows() == 3, "Target was replaced");
+  }
+  for (int i = 0; i < 1000; i++) {
+    CX_ASSERT(loadedNumbers[i] == i * 3, "Binary vec save/load failed");
+  }
+  CX_ASSERT(loadedMatrix.n_rows() == 3 && loadedMatrix.n_cols() == 5, "Binary mat dimensions wrong");
+  CX_ASSERT(loadedMatrix(2, 4) == matrix(2, 4) && loadedMatrix(1, 0) == matrix(1, 0), "Binary mat save/load failed");
+}
+void test_mapped_load() {
+  const char* test_filename = "test_mapped.txt";
+  FILE* file = std::fopen(test_filename, "wb");
+  io_save_section(file, "HEADER");
+  io_save(file, "multi\nline string with some length to cross a simd block");
+  io_save(file, 12345);
+  io_save(file, true);
+  io_save(file, 1.5F, 2.5F, 3.5F);
+  io_save_newline(file);
+  io_save_section(file, "DATA");
+  for (int i = 0; i < 100; i++) {
+    io_save(file, i);
+    io_save(file, (float)i * 0.5F);
+    io_save_newline(file);
+  }
+  io_save_section(file, "END");
+  std::fclose(file);
+
+  MappedTextReader reader(test_filename);
+  CX_ASSERT(reader.is_open(), "Mapping failed");
+  CX_ASSERT(reader.section_count() == 3, "Section index failed");
+  CX_ASSERT(reader.section_name(1) == "DATA", "Section index failed");
+
+  // Random access into the second section
+  CX_ASSERT(reader.seek_section("DATA"), "Section not found");
+  int i = -1;
+  float f = 0;
+  reader.load(i);
+  reader.load(f);
+  CX_ASSERT(i == 0 && f == 0.0F, "Mapped load after seek failed");
+
+  // Sequential - same usage as the FILE* interface
+  reader.seek(0);
+  char buffer[256];
+  bool b = false;
+  float f2 = 0, f3 = 0;
+  CX_ASSERT(reader.load_inside_section("HEADER"), "Section header not found");
+  reader.load(buffer, sizeof(buffer));
+  reader.load(i);
+  reader.load(b);
+  reader.load(f, f2, f3);
+  reader.load_newline(true);
+  CX_ASSERT(std::strcmp(buffer, "multi\nline string with some length to cross a simd block") == 0, "Mapped string failed");
+  CX_ASSERT(i == 12345 && b, "Mapped int/bool failed");
+  CX_ASSERT(f == 1.5F && f2 == 2.5F && f3 == 3.5F, "Mapped floats failed");
+  CX_ASSERT(!reader.load_inside_section("HEADER"), "Section end not detected");
+
+  int count = 0;
+  while (reader.load_inside_section("DATA")) {
+    reader.load(i);
+    reader.load(f);
+    reader.load_newline();
+    CX_ASSERT(i == count && f == (float)count * 0.5F, "Mapped data section failed");
+    count++;
+  }
+  CX_ASSERT(count == 100, "Mapped data section incomplete");
+  CX_ASSERT(reader.eof(), "Didnt reach eof");
+}
+void test_buffered_write() {
+  const char* test_filename = "test_buffered.txt";
+  constexpr int lines = 10000;
+
+  // Way bigger than the buffer and with embedded null bytes
+  [[maybe_unused]] bool success = io_save_buffered_write(
+      test_filename, 64,
+      [](FILE* file) {
+        for (int i = 0; i < lines; i++) {
+          io_save(file, i);
+          fputc('\0', file);
+          io_save_newline(file);
+        }
+      },
+      IOSync::BLOCKING);
+  CX_ASSERT(success, "Buffered write failed");
+
+  FILE* file = std::fopen(test_filename, "rb");
+  fseek(file, 0, SEEK_END);
+  [[maybe_unused]] const long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  int last = -1;
+  for (int i = 0; i < lines; i++) {
+    io_load(file, last);
+    io_load_newline(file, true);
+  }
+  std::fclose(file);
+  CX_ASSERT(last == lines - 1, "Buffered write truncated data");
+  // Each line is the number, the separator, the null byte and the newline
+  [[maybe_unused]] long expected = 0;
+  for (int i = 0; i < lines; i++) {
+    expected += snprintf(nullptr, 0, "%d", i) + 3;
+  }
+  CX_ASSERT(size == expected, "Buffered write wrong size");
+
+  // Concurrent saves of the same file dont share a temporary - one of them wins completely
+  auto save_value = [test_filename](int value) {
+    return io_save_buffered_write(test_filename, 64, [value](FILE* file) {
+      for (int i = 0; i < lines; i++) {
+        io_save(file, value);
+        io_save_newline(file);
+      }
+    });
+  };
+  bool otherSuccess = false;
+  std::thread other([&] { otherSuccess = save_value(2); });
+  success = save_value(1);
+  other.join();
+  CX_ASSERT(success && otherSuccess, "Concurrent save failed");
+  file = std::fopen(test_filename, "rb");
+  int first = -1;
+  io_load(file, first);
+  io_load_newline(file, true);
+  [[maybe_unused]] bool consistent = first == 1 || first == 2;
+  for (int i = 1; i < lines; i++) {
+    int value = -1;
+    io_load(file, value);
+    io_load_newline(file, true);
+    consistent = consistent && value == first;
+  }
+  std::fclose(file);
+  CX_ASSERT(consistent, "Concurrent saves mixed their content");
+
+  // A failing save leaves the old file untouched
+  success = io_save_buffered_write(test_filename, 64, [](FILE* file) {
+    io_save(file, "garbage");
+    return false;
+  });
+  CX_ASSERT(!success, "Failed save reported success");
+  file = std::fopen(test_filename, "rb");
+  io_load(file, last);
+  std::fclose(file);
+  CX_ASSERT(last == first, "Failed save replaced the file");
+}
 static void TEST_IO() {
   benchMark();
   test_save_load_float();
   test_save_load_int();
   test_save_load_string();
   test_complex_save_load();
+  test_binary_save_load();
+  test_mapped_load();
+  test_buffered_write();
   delete_test_files();
 }
 }  // namespace cxtests
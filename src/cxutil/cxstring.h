@@ -25,6 +25,152 @@
 #include <cstdio>
 #include <cstring>
 #include <cctype>
+#include <charconv>
+#include <limits>
+#include <type_traits>
+
+// Helpers for the number parsers - all SWAR (SIMD within a register) operations assume little endian
+namespace cxhelper {
+// True if the 8 bytes are all ascii digits
+inline bool str_is_eight_digits(const uint64_t chunk) noexcept {
+  return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+      == 0x3333333333333333ULL;
+}
+// Converts 8 ascii digits to their value with 3 multiplications instead of 8
+inline uint32_t str_parse_eight_digits(uint64_t chunk) noexcept {
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);  // Pairs of digits
+  chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+           + (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))))
+      >> 32;
+  return (uint32_t)chunk;
+}
+inline uint64_t str_load_eight(const char* p) noexcept {
+  uint64_t chunk;
+  std::memcpy(&chunk, p, sizeof(chunk));
+  return chunk;
+}
+inline bool str_is_digit(const char c) noexcept {
+  return (unsigned char)(c - '0') < 10;
+}
+// Finds the end of the number starting at str - so null terminated strings can use the ranged parsers
+inline const char* str_number_end(const char* str) noexcept {
+  while (str_is_digit(*str) || *str == '.' || *str == '-' || *str == '+' || *str == 'e' || *str == 'E') {
+    ++str;
+  }
+  return str;
+}
+// Exactly representable powers of ten
+inline constexpr double POW10_DOUBLE[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Decomposed decimal number: mantissa * 10^exponent
+struct DecimalNumber {
+  uint64_t mantissa = 0;
+  int64_t exponent = 0;
+  bool negative = false;
+  bool truncated = false;  // More than 19 significant digits
+  bool valid = false;      // At least one digit
+};
+// Scans a decimal number - digits are consumed 8 at a time where possible
+inline const char* str_scan_decimal(const char* p, const char* last, DecimalNumber& num) noexcept {
+  if (p < last && (*p == '-' || *p == '+')) {
+    num.negative = *p == '-';
+    ++p;
+  }
+  int digits = 0;
+  // Skip leading zeros so they dont count towards the 19 significant digits
+  while (p < last && *p == '0') {
+    num.valid = true;
+    ++p;
+  }
+  while (last - p >= 8 && digits <= 11 && str_is_eight_digits(str_load_eight(p))) {
+    num.mantissa = num.mantissa * 100000000 + str_parse_eight_digits(str_load_eight(p));
+    digits += 8;
+    p += 8;
+  }
+  while (p < last && str_is_digit(*p)) {
+    if (digits < 19) {
+      num.mantissa = num.mantissa * 10 + (uint64_t)(*p - '0');
+      digits++;
+    } else {
+      num.exponent++;
+      num.truncated |= *p != '0';
+    }
+    ++p;
+  }
+  num.valid |= digits > 0;
+
+  if (p < last && *p == '.') {
+    ++p;
+    if (num.mantissa == 0) {
+      while (p < last && *p == '0') {
+        num.exponent--;
+        num.valid = true;
+        ++p;
+      }
+    }
+    while (last - p >= 8 && digits <= 11 && str_is_eight_digits(str_load_eight(p))) {
+      num.mantissa = num.mantissa * 100000000 + str_parse_eight_digits(str_load_eight(p));
+      num.exponent -= 8;
+      digits += 8;
+      p += 8;
+    }
+    while (p < last && str_is_digit(*p)) {
+      if (digits < 19) {
+        num.mantissa = num.mantissa * 10 + (uint64_t)(*p - '0');
+        num.exponent--;
+        digits++;
+      } else {
+        num.truncated |= *p != '0';
+      }
+      num.valid = true;
+      ++p;
+    }
+  }
+  if (!num.valid) return p;
+
+  if (p < last && (*p == 'e' || *p == 'E')) {
+    const char* expStart = p++;
+    bool expNegative = false;
+    if (p < last && (*p == '-' || *p == '+')) {
+      expNegative = *p == '-';
+      ++p;
+    }
+    if (p < last && str_is_digit(*p)) {
+      int64_t exp = 0;
+      while (p < last && str_is_digit(*p)) {
+        if (exp < 100000) exp = exp * 10 + (*p - '0');
+        ++p;
+      }
+      num.exponent += expNegative ? -exp : exp;
+    } else {
+      p = expStart;  // Not an exponent - "1e" parses as 1
+    }
+  }
+  return p;
+}
+// Falls back to std::from_chars which is correctly rounded for all inputs
+// Returns first (and leaves value untouched) if there is no number - also for a lone or doubled sign ("+", "+-1")
+template <typename T>
+const char* str_parse_fallback(const char* first, const char* last, T& value) noexcept {
+  const char* number = first < last && *first == '+' ? first + 1 : first;
+  if (number != first && number < last && *number == '-') return first;
+  const auto [ptr, ec] = std::from_chars(number, last, value);
+  if (ec == std::errc::invalid_argument) return first;
+  if (ec == std::errc::result_out_of_range) {
+    // from_chars leaves value untouched - mirror strtod
+    const bool negative = *number == '-';
+    bool tiny = false;
+    for (const char* it = number; it < ptr; ++it) {
+      if (*it == 'e' || *it == 'E') tiny = it[1] == '-';
+    }
+    value = tiny ? (T)(negative ? -0.0 : 0.0)
+                 : (negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity());
+  }
+  return ptr;
+}
+}  // namespace cxhelper
 
 namespace cxstructs {
 // Pads the given string "arg" inside "buff" with the "padSymbol" - optional prefix and suffix
@@ -190,67 +336,109 @@ inline int64_t str_parse_long(const char* str, const int radix = 10) {
 
   return negative ? -result : result;
 }
-// Parses the given string into a float on best effort basis
-inline float str_parse_float(const char* str) {
-  if (str == nullptr || *str == '\0') return 0.0F;
-
-  float result = 0.0;
+// Parses the number in [first, last) into value - returns a pointer past the last consumed character
+// Returns first (and leaves value untouched) if there is no number
+// Digits are consumed 8 at a time with SWAR - overflow wraps around
+inline const char* str_parse_int64(const char* first, const char* last, int64_t& value) noexcept {
+  using namespace cxhelper;
+  const char* p = first;
   bool negative = false;
-  if (*str == '-') {
-    negative = true;
-    ++str;
+  if (p < last && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
   }
-
-  // Parse the integer part
-  while (*str && *str != '.') {
-    if (*str < '0' || *str > '9') break;
-    result = result * 10 + (*str - '0');
-    ++str;
+  const char* digits = p;
+  uint64_t result = 0;
+  while (last - p >= 8 && str_is_eight_digits(str_load_eight(p))) {
+    result = result * 100000000 + str_parse_eight_digits(str_load_eight(p));
+    p += 8;
   }
-
-  // Parse the fractional part
-  if (*str == '.') {
-    ++str;
-    float factor = 0.1;
-    while (*str && *str >= '0' && *str <= '9') {
-      result += (*str - '0') * factor;
-      factor *= 0.1;
-      ++str;
+  while (p < last && str_is_digit(*p)) {
+    result = result * 10 + (uint64_t)(*p - '0');
+    ++p;
+  }
+  if (p == digits) return first;
+  value = negative ? (int64_t)(0 - result) : (int64_t)result;
+  return p;
+}
+// Parses the number in [first, last) into value - returns a pointer past the last consumed character
+// Returns first (and leaves value untouched) if there is no number
+// Correctly rounded - common inputs (<= 19 digits, small exponents) take a fast exact path, others use std::from_chars
+inline const char* str_parse_double(const char* first, const char* last, double& value) noexcept {
+  using namespace cxhelper;
+  DecimalNumber num;
+  const char* end = str_scan_decimal(first, last, num);
+  if (!num.valid) return str_parse_fallback(first, last, value);  // inf, nan
+  // Both the mantissa and the power of ten are exact so a single operation rounds correctly (Clinger)
+  if (!num.truncated && num.mantissa <= (1ULL << 53) && num.exponent >= -22 && num.exponent <= 22) [[likely]] {
+    double result = (double)num.mantissa;
+    result = num.exponent < 0 ? result / POW10_DOUBLE[-num.exponent] : result * POW10_DOUBLE[num.exponent];
+    value = num.negative ? -result : result;
+    return end;
+  }
+  return str_parse_fallback(first, last, value);
+}
+// Parses the number in [first, last) into value - returns a pointer past the last consumed character
+// Returns first (and leaves value untouched) if there is no number
+// Correctly rounded - common inputs (<= 15 digits, small exponents) take a fast exact path, others use std::from_chars
+inline const char* str_parse_float(const char* first, const char* last, float& value) noexcept {
+  using namespace cxhelper;
+  DecimalNumber num;
+  const char* end = str_scan_decimal(first, last, num);
+  if (!num.valid) return str_parse_fallback(first, last, value);  // inf, nan
+  if (!num.truncated && num.mantissa <= (1ULL << 53) && num.exponent >= -22 && num.exponent <= 22) [[likely]] {
+    double result = (double)num.mantissa;
+    result = num.exponent < 0 ? result / POW10_DOUBLE[-num.exponent] : result * POW10_DOUBLE[num.exponent];
+    // The double is correctly rounded - narrowing it again is only wrong if it sits exactly between two floats
+    uint64_t bits;
+    std::memcpy(&bits, &result, sizeof(bits));
+    if ((bits & 0x1FFFFFFFULL) != 0x10000000ULL) [[likely]] {
+      value = num.negative ? -(float)result : (float)result;
+      return end;
     }
   }
-
-  return negative ? -result : result;
+  return str_parse_fallback(first, last, value);
+}
+// Parses the given string into a float on best effort basis
+inline float str_parse_float(const char* str) {
+  if (str == nullptr || *str == '\0') return 0.0F;
+  float result = 0.0F;
+  str_parse_float(str, cxhelper::str_number_end(str), result);
+  return result;
 }
 // Parses the given string into a double on best effort basis
 inline double str_parse_double(const char* str) {
   if (str == nullptr || *str == '\0') return 0.0;
-
   double result = 0.0;
-  bool negative = false;
-  if (*str == '-') {
-    negative = true;
-    ++str;
-  }
-
-  // Parse the integer part
-  while (*str && *str != '.') {
-    if (*str < '0' || *str > '9') break;
-    result = result * 10 + (*str - '0');
-    ++str;
-  }
-
-  // Parse the fractional part
-  if (*str == '.') {
-    ++str;
-    double factor = 0.1;
-    while (*str && *str >= '0' && *str <= '9') {
-      result += (*str - '0') * factor;
-      factor *= 0.1;
-      ++str;
+  str_parse_double(str, cxhelper::str_number_end(str), result);
+  return result;
+}
+// Parses a delimited buffer of numbers (e.g. a CSV column or row) into out - returns the number of values written
+// Delimiters, spaces, tabs and line breaks between values are skipped - stops at the first invalid value or maxCount
+// Use with float*, double* or int64_t*
+template <typename T>
+int64_t str_parse_column(const char* first, const char* last, T* out, const int64_t maxCount, const char delim = ',') {
+  int64_t count = 0;
+  const char* p = first;
+  while (count < maxCount) {
+    while (p < last && (*p == delim || *p == '\n' || *p == '\r' || *p == ' ' || *p == '\t')) {
+      ++p;
+    }
+    if (p >= last) break;
+    const char* next;
+    if constexpr (std::is_same_v<T, float>) {
+      next = str_parse_float(p, last, out[count]);
+    } else if constexpr (std::is_same_v<T, double>) {
+      next = str_parse_double(p, last, out[count]);
+    } else {
+      static_assert(std::is_same_v<T, int64_t>, "Only float, double and int64_t columns are supported");
+      next = str_parse_int64(p, last, out[count]);
     }
+    if (next == p) break;
+    p = next;
+    count++;
   }
-
-  return negative ? -result : result;
+  return count;
 }
 inline int str_count_chars_until(const char* data, char stop, int maxCount) {
   int count = 0;
@@ -317,6 +505,147 @@ int str_sort_levenshtein_case(const char* s1, const char* s2, const bool caseSen
 
   return d[len1][len2];
 }
+// Precomputed query for bit-parallel (Myers/Hyyroe) Levenshtein distance - build once, score against many strings
+// Each column of the DP matrix is encoded as bit vectors so 64 rows are computed per word operation: O(n * m/64)
+// Case insensitive by default like str_sort_levenshtein_case()
+struct LevenshteinQuery final {
+  explicit LevenshteinQuery(const char* query, const bool caseSensitive = false)
+      : length_((int)strlen(query)), blocks_(length_ == 0 ? 1 : (length_ + 63) / 64) {
+    peq_ = new uint64_t[256 * blocks_]();
+    for (int i = 0; i < length_; ++i) {
+      const auto c = (unsigned char)query[i];
+      const uint64_t bit = 1ULL << (i % 64);
+      if (caseSensitive) {
+        peq_[c * blocks_ + i / 64] |= bit;
+      } else {
+        peq_[(unsigned char)tolower(c) * blocks_ + i / 64] |= bit;
+        peq_[(unsigned char)toupper(c) * blocks_ + i / 64] |= bit;
+      }
+    }
+  }
+  LevenshteinQuery(const LevenshteinQuery&) = delete;
+  LevenshteinQuery& operator=(const LevenshteinQuery&) = delete;
+  ~LevenshteinQuery() { delete[] peq_; }
+  [[nodiscard]] int length() const { return length_; }
+  // Returns the Levenshtein distance to the given string
+  // Bounded: returns -1 as soon as the distance is known to be above maxDistance
+  [[nodiscard]] int distance(const char* text, const int maxDistance = INT32_MAX) const {
+    return distance_n(text, (int)strlen(text), maxDistance);
+  }
+  [[nodiscard]] int distance_n(const char* text, const int textLength, const int maxDistance = INT32_MAX) const {
+    const int lengthDiff = length_ > textLength ? length_ - textLength : textLength - length_;
+    if (lengthDiff > maxDistance) return -1;
+    if (length_ == 0) return textLength;
+    return blocks_ == 1 ? distance_single(text, textLength, maxDistance) : distance_multi(text, textLength, maxDistance);
+  }
+  // Mask of the last pattern row inside the last block
+  [[nodiscard]] uint64_t last_bit() const { return 1ULL << ((length_ - 1) % 64); }
+  [[nodiscard]] const uint64_t* peq(const unsigned char c) const { return peq_ + c * blocks_; }
+
+ private:
+  // One text column for a pattern of at most 64 characters - hin is always +1 (top row is 0,1,2...)
+  [[nodiscard]] int distance_single(const char* text, const int textLength, const int maxDistance) const {
+    const uint64_t lastBit = last_bit();
+    uint64_t pv = ~0ULL;
+    uint64_t mv = 0;
+    int score = length_;
+    for (int j = 0; j < textLength; ++j) {
+      const uint64_t eq = peq_[(unsigned char)text[j]];
+      const uint64_t xv = eq | mv;
+      const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+      uint64_t ph = mv | ~(xh | pv);
+      uint64_t mh = pv & xh;
+      score += (ph & lastBit) != 0;
+      score -= (mh & lastBit) != 0;
+      ph = (ph << 1) | 1;
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+      // Each remaining character can lower the score by at most 1
+      if (score - (textLength - j - 1) > maxDistance) return -1;
+    }
+    return score;
+  }
+  // Block based version - the horizontal delta is carried from block to block
+  [[nodiscard]] int distance_multi(const char* text, const int textLength, const int maxDistance) const {
+    uint64_t pvs[16];
+    uint64_t mvs[16];
+    uint64_t* pv = blocks_ <= 16 ? pvs : new uint64_t[blocks_];
+    uint64_t* mv = blocks_ <= 16 ? mvs : new uint64_t[blocks_];
+    for (int b = 0; b < blocks_; ++b) {
+      pv[b] = ~0ULL;
+      mv[b] = 0;
+    }
+    const uint64_t lastBit = last_bit();
+    int score = length_;
+    int result = 0;
+    for (int j = 0; j < textLength; ++j) {
+      const uint64_t* eqs = peq((unsigned char)text[j]);
+      int hin = 1;
+      for (int b = 0; b < blocks_; ++b) {
+        uint64_t eq = eqs[b];
+        const uint64_t hinNeg = hin < 0 ? 1 : 0;
+        const uint64_t xv = eq | mv[b];
+        eq |= hinNeg;
+        const uint64_t xh = (((eq & pv[b]) + pv[b]) ^ pv[b]) | eq;
+        uint64_t ph = mv[b] | ~(xh | pv[b]);
+        uint64_t mh = pv[b] & xh;
+        const uint64_t outBit = b == blocks_ - 1 ? lastBit : 1ULL << 63;
+        const int hout = ((ph & outBit) != 0) - ((mh & outBit) != 0);
+        ph = (ph << 1) | (hin > 0 ? 1 : 0);
+        mh = (mh << 1) | hinNeg;
+        pv[b] = mh | ~(xv | ph);
+        mv[b] = ph & xv;
+        hin = hout;
+      }
+      score += hin;
+      if (score - (textLength - j - 1) > maxDistance) {
+        result = -1;
+        break;
+      }
+    }
+    if (blocks_ > 16) {
+      delete[] pv;
+      delete[] mv;
+    }
+    return result == -1 ? -1 : score;
+  }
+  int length_;
+  int blocks_;
+  uint64_t* peq_;  // Match bit vectors - 256 characters * blocks
+};
+// Returns the Levenshtein distance for the two given strings - bit-parallel so O(n) for strings up to 64 characters
+// Bounded: returns -1 as soon as the distance is known to be above maxDistance
+inline int str_levenshtein(const char* s1, const char* s2, const int maxDistance = INT32_MAX,
+                           const bool caseSensitive = false) {
+  const LevenshteinQuery query{s1, caseSensitive};
+  return query.distance(s2, maxDistance);
+}
+// Scores query against all candidates and writes the k closest (index and distance) sorted by distance - ties keep the lower index
+// Once k results are found the current k-th distance bounds every following candidate so most are cut off early
+// Returns the number of results written (min(k, count))
+inline int str_levenshtein_top_k(const LevenshteinQuery& query, const char* const* candidates, const int count,
+                                 const int k, int* outIndices, int* outDistances) {
+  if (k <= 0) return 0;
+  int found = 0;
+  const auto insert = [&](const int index, const int distance) {
+    if (distance < 0 || (found == k && distance >= outDistances[k - 1])) return;
+    int pos = found < k ? found++ : k - 1;
+    while (pos > 0 && outDistances[pos - 1] > distance) {
+      outDistances[pos] = outDistances[pos - 1];
+      outIndices[pos] = outIndices[pos - 1];
+      --pos;
+    }
+    outDistances[pos] = distance;
+    outIndices[pos] = index;
+  };
+  const auto threshold = [&] { return found == k ? outDistances[k - 1] - 1 : INT32_MAX; };
+
+  for (int i = 0; i < count; ++i) {
+    insert(i, query.distance(candidates[i], threshold()));
+  }
+  return found;
+}
 // string hash function
 constexpr auto str_hash_fnv1a_32(char const* s) noexcept -> uint32_t {
   uint32_t hash = 2166136261U;
@@ -358,7 +687,104 @@ inline void str_embed_num(std::string& s, float num) {
 #include "../cxconfig.h"
 
 namespace cxtests {
+static void TEST_STRING_PARSE() {
+  using namespace cxstructs;
+  // Exact rounding - compare against strtod/strtof on tricky and random inputs
+  const char* inputs[] = {"0",     "-0.0",  "1",        "3.141",          "0.1",      "0.3",    "123456789.123456789",
+                          "1e22",  "1e23",  "2.5e-10",  "-7.7e+5",        "9007199254740993", "1.7976931348623157e308",
+                          "4.9e-324", "1e400", "1e-400", "00000000000012.50000000000000000000000001", ".5", "5."};
+  for ([[maybe_unused]] const char* input : inputs) {
+    CX_ASSERT(str_parse_double(input) == strtod(input, nullptr), input);
+    CX_ASSERT(str_parse_float(input) == strtof(input, nullptr), input);
+  }
+  uint64_t seed = 88172645463325252ULL;
+  char buff[64];
+  for (int i = 0; i < 100000; i++) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    snprintf(buff, sizeof(buff), "%.*f", (int)(seed % 12), (double)(seed % 100000000) / (double)(1 + seed % 1000));
+    CX_ASSERT(str_parse_double(buff) == strtod(buff, nullptr), buff);
+    CX_ASSERT(str_parse_float(buff) == strtof(buff, nullptr), buff);
+  }
+
+  int64_t l = 0;
+  const char* num = "-1234567890123456789,";
+  [[maybe_unused]] const char* end = str_parse_int64(num, num + 21, l);
+  CX_ASSERT(end == num + 20, "");
+  CX_ASSERT(l == -1234567890123456789LL, "");
+  CX_ASSERT(str_parse_int("42abc") == 42, "");
+
+  // No number - first is returned and value stays untouched
+  for ([[maybe_unused]] const char* invalid : {"+", "+x", "-", "+-1", "x"}) {
+    double d = 7.0;
+    end = str_parse_double(invalid, invalid + strlen(invalid), d);
+    CX_ASSERT(end == invalid && d == 7.0, invalid);
+  }
+
+  const char* csv = "1.5,2.25,-3\n4e2,  5,6\r\n7";
+  float floats[16];
+  [[maybe_unused]] int64_t count = str_parse_column(csv, csv + strlen(csv), floats, 16);
+  CX_ASSERT(count == 7, "");
+  CX_ASSERT(floats[0] == 1.5F && floats[2] == -3.0F && floats[3] == 400.0F && floats[6] == 7.0F, "");
+
+  const char* ints = "10;20;30;abc;40";
+  int64_t longs[16];
+  count = str_parse_column(ints, ints + strlen(ints), longs, 16, ';');
+  CX_ASSERT(count == 3, "");
+  CX_ASSERT(longs[2] == 30, "");
+
+  const char* signs = "1,+,2";
+  count = str_parse_column(signs, signs + strlen(signs), floats, 16);
+  CX_ASSERT(count == 1 && floats[0] == 1.0F, "A lone sign is not a value");
+}
+static void TEST_STRING_LEVENSHTEIN() {
+  using namespace cxstructs;
+  CX_ASSERT(str_levenshtein("kitten", "sitting") == 3, "");
+  CX_ASSERT(str_levenshtein("", "abc") == 3, "");
+  CX_ASSERT(str_levenshtein("abc", "") == 3, "");
+  CX_ASSERT(str_levenshtein("HeLLo", "hello") == 0, "");
+  CX_ASSERT(str_levenshtein("HeLLo", "hello", INT32_MAX, true) == 3, "");
+  CX_ASSERT(str_levenshtein("kitten", "sitting", 2) == -1, "");
+  CX_ASSERT(str_levenshtein("kitten", "sitting", 3) == 3, "");
+
+  // Compare with the DP version - including multi block patterns
+  uint64_t seed = 88172645463325252ULL;
+  const auto next = [&] {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+  };
+  char a[200];
+  char b[200];
+  for (int i = 0; i < 2000; i++) {
+    const int lenA = (int)(next() % 199);
+    const int lenB = (int)(next() % 199);
+    for (int j = 0; j < lenA; j++) a[j] = (char)('a' + next() % 4);
+    for (int j = 0; j < lenB; j++) b[j] = (char)('a' + next() % 4);
+    a[lenA] = '\0';
+    b[lenB] = '\0';
+    [[maybe_unused]] const int expected = str_sort_levenshtein_case<200>(a, b);
+    CX_ASSERT(str_levenshtein(a, b) == expected, "");
+    CX_ASSERT(str_levenshtein(b, a) == expected, "");
+    CX_ASSERT(str_levenshtein(a, b, expected) == expected, "");
+    CX_ASSERT(expected == 0 || str_levenshtein(a, b, expected - 1) == -1, "");
+  }
+
+  [[maybe_unused]] const char* candidates[] = {"apple", "apply", "ample", "maple", "application", "banana", "appel", "apple pie", "a"};
+  const LevenshteinQuery query{"apple"};
+  int indices[3];
+  int distances[3];
+  [[maybe_unused]] const int found = str_levenshtein_top_k(query, candidates, 9, 3, indices, distances);
+  CX_ASSERT(found == 3, "");
+  CX_ASSERT(indices[0] == 0 && distances[0] == 0, "");
+  CX_ASSERT(indices[1] == 1 && distances[1] == 1, "");
+  CX_ASSERT(indices[2] == 2 && distances[2] == 1, "");
+}
 static void TEST_STRING() {
+  TEST_STRING_PARSE();
+  TEST_STRING_LEVENSHTEIN();
   std::unordered_map<const char*, int, cxstructs::Fnv1aHash, cxstructs::StrEqual> myMap;
   auto* hey1 = "hey";
   auto* hey2 = "hey";